@@ -0,0 +1,394 @@
+/**
+ * Pluggable allocators.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "allocator.h"
+#ifdef TEST
+#include <assert.h>
+#include <stdio.h>
+#endif
+
+#define ARENA_DEFAULT_BLOCK (64 * 1024)
+#define POOL_DEFAULT_SLOTS 64
+#define ALIGNMENT _Alignof(max_align_t)
+#define ALIGN_UP(n, a) (((n) + (a) - 1) & ~((size_t)(a) - 1))
+
+
+//
+// Private classes - not exposed in the header
+//
+/**
+ * A block of arena memory. The usable memory follows the header.
+ * @param next The next (older) block.
+ * @param size The usable size of the block.
+ * @param used The number of bytes handed out.
+ */
+struct ArenaBlock {
+    ArenaBlock* next;
+    size_t size;
+    size_t used;
+    max_align_t data[];
+};
+
+/**
+ * A slab of pool slots. The slots follow the header.
+ * @param next The next (older) slab.
+ * @param slots The number of slots in the slab.
+ */
+struct PoolSlab {
+    PoolSlab* next;
+    size_t slots;
+    max_align_t data[];
+};
+
+
+/**
+ * Allocate a new arena block. -- private
+ */
+static ArenaBlock* arena_block_new(size_t size) {
+    ArenaBlock* block = malloc(sizeof(ArenaBlock) + size);
+    if (!block) return NULL;
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+
+// Documentation in header file.
+void* arena_alloc(Arena* arena, size_t size) {
+    size = ALIGN_UP(size ? size : 1, ALIGNMENT);
+    ArenaBlock* head = arena->head;
+    if (head && head->size - head->used >= size) {
+        void* ret = (char*)head->data + head->used;
+        head->used += size;
+        arena->last = ret;
+        return ret;
+    }
+    if (size > arena->block_size) {
+        // Oversized requests get a dedicated block kept behind the head, so
+        // the space left in the head block is not wasted.
+        ArenaBlock* block = arena_block_new(size);
+        if (!block) return NULL;
+        block->used = size;
+        if (head) {
+            block->next = head->next;
+            head->next = block;
+        } else {
+            arena->head = block;
+            arena->last = block->data;
+        }
+        return block->data;
+    }
+    ArenaBlock* block = arena_block_new(arena->block_size);
+    if (!block) return NULL;
+    block->next = head;
+    block->used = size;
+    arena->head = block;
+    arena->last = block->data;
+    return block->data;
+}
+
+
+/**
+ * Allocator callback for arenas. -- private
+ */
+static void* arena_cb_alloc(void* ctx, size_t size) {
+    return arena_alloc((Arena*)ctx, size);
+}
+
+
+/**
+ * Allocator callback for arenas. The most recent allocation is resized in
+ * place; anything else is copied to a fresh allocation. -- private
+ */
+static void* arena_cb_realloc(void* ctx, void* ptr, size_t old_size,
+    size_t new_size) {
+    Arena* arena = ctx;
+    if (!ptr) return arena_alloc(arena, new_size);
+    ArenaBlock* head = arena->head;
+    if (ptr == arena->last && head) {
+        size_t offset = (char*)ptr - (char*)head->data;
+        size_t needed = ALIGN_UP(new_size ? new_size : 1, ALIGNMENT);
+        if (offset + needed <= head->size) {
+            head->used = offset + needed;
+            return ptr;
+        }
+    }
+    void* ret = arena_alloc(arena, new_size);
+    if (ret) memcpy(ret, ptr, old_size < new_size ? old_size : new_size);
+    return ret;
+}
+
+
+/**
+ * Allocator callback for arenas. Only the most recent allocation is given
+ * back; everything else waits for arena_reset(). -- private
+ */
+static void arena_cb_free(void* ctx, void* ptr) {
+    Arena* arena = ctx;
+    if (ptr && ptr == arena->last && arena->head) {
+        arena->head->used = (char*)ptr - (char*)arena->head->data;
+        arena->last = NULL;
+    }
+}
+
+
+// Documentation in header file.
+void arena_init(Arena* arena, size_t block_size) {
+    arena->head = NULL;
+    arena->block_size = ALIGN_UP(
+        block_size ? block_size : ARENA_DEFAULT_BLOCK, ALIGNMENT);
+    arena->last = NULL;
+    arena->allocator.alloc = arena_cb_alloc;
+    arena->allocator.realloc = arena_cb_realloc;
+    arena->allocator.free = arena_cb_free;
+    arena->allocator.ctx = arena;
+}
+
+
+// Documentation in header file.
+void arena_reset(Arena* arena) {
+    ArenaBlock* keep = NULL;
+    ArenaBlock* block = arena->head;
+    while (block) {
+        ArenaBlock* next = block->next;
+        if (!keep && block->size == arena->block_size) {
+            keep = block;
+        } else {
+            free(block);
+        }
+        block = next;
+    }
+    if (keep) {
+        keep->next = NULL;
+        keep->used = 0;
+    }
+    arena->head = keep;
+    arena->last = NULL;
+}
+
+
+// Documentation in header file.
+void arena_destroy(Arena* arena) {
+    ArenaBlock* block = arena->head;
+    while (block) {
+        ArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = NULL;
+    arena->last = NULL;
+}
+
+
+/**
+ * Find the slab holding a pointer. Slabs double in size, so the list has
+ * a logarithmic number of entries. -- private
+ */
+static PoolSlab* pool_find_slab(const Pool* pool, const void* ptr) {
+    for (PoolSlab* slab = pool->slabs; slab; slab = slab->next) {
+        const char* begin = (const char*)slab->data;
+        const char* end = begin + slab->slots * pool->slot_len;
+        if ((const char*)ptr >= begin && (const char*)ptr < end) return slab;
+    }
+    return NULL;
+}
+
+
+// Documentation in header file.
+void* pool_alloc(Pool* pool) {
+    if (!pool->free_slots) {
+        size_t slots = pool->next_slots;
+        PoolSlab* slab = malloc(sizeof(PoolSlab) + slots * pool->slot_len);
+        if (!slab) return NULL;
+        slab->slots = slots;
+        slab->next = pool->slabs;
+        pool->slabs = slab;
+        pool->next_slots = slots * 2;
+        // Thread the new slots onto the free list, lowest address first.
+        char* base = (char*)slab->data;
+        for (size_t i = slots; i > 0; i--) {
+            void* slot = base + (i - 1) * pool->slot_len;
+            *(void**)slot = pool->free_slots;
+            pool->free_slots = slot;
+        }
+    }
+    void* ret = pool->free_slots;
+    pool->free_slots = *(void**)ret;
+    return ret;
+}
+
+
+// Documentation in header file.
+void pool_free(Pool* pool, void* ptr) {
+    if (!ptr) return;
+    *(void**)ptr = pool->free_slots;
+    pool->free_slots = ptr;
+}
+
+
+/**
+ * Allocator callback for pools. -- private
+ */
+static void* pool_cb_alloc(void* ctx, size_t size) {
+    Pool* pool = ctx;
+    return size <= pool->slot_len ? pool_alloc(pool) : malloc(size);
+}
+
+
+/**
+ * Allocator callback for pools. -- private
+ */
+static void pool_cb_free(void* ctx, void* ptr) {
+    Pool* pool = ctx;
+    if (!ptr) return;
+    if (pool_find_slab(pool, ptr)) pool_free(pool, ptr);
+    else free(ptr);
+}
+
+
+/**
+ * Allocator callback for pools. -- private
+ */
+static void* pool_cb_realloc(void* ctx, void* ptr, size_t old_size,
+    size_t new_size) {
+    Pool* pool = ctx;
+    if (!ptr) return pool_cb_alloc(pool, new_size);
+    int in_slab = pool_find_slab(pool, ptr) != NULL;
+    if (in_slab && new_size <= pool->slot_len) return ptr;
+    if (!in_slab && new_size > pool->slot_len) return realloc(ptr, new_size);
+    void* ret = pool_cb_alloc(pool, new_size);
+    if (!ret) return NULL;
+    memcpy(ret, ptr, old_size < new_size ? old_size : new_size);
+    pool_cb_free(pool, ptr);
+    return ret;
+}
+
+
+// Documentation in header file.
+void pool_init(Pool* pool, size_t el_len, size_t slots_per_slab) {
+    // Slots hold a free-list link while unused and keep the natural
+    // alignment of el_len-sized objects, up to the maximum alignment.
+    size_t slot_len = sizeof(void*);
+    while (slot_len < el_len && slot_len < ALIGNMENT) slot_len *= 2;
+    pool->slot_len = ALIGN_UP(el_len > slot_len ? el_len : slot_len, slot_len);
+    pool->slabs = NULL;
+    pool->free_slots = NULL;
+    pool->next_slots = slots_per_slab ? slots_per_slab : POOL_DEFAULT_SLOTS;
+    pool->allocator.alloc = pool_cb_alloc;
+    pool->allocator.realloc = pool_cb_realloc;
+    pool->allocator.free = pool_cb_free;
+    pool->allocator.ctx = pool;
+}
+
+
+// Documentation in header file.
+void pool_destroy(Pool* pool) {
+    PoolSlab* slab = pool->slabs;
+    while (slab) {
+        PoolSlab* next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    pool->slabs = NULL;
+    pool->free_slots = NULL;
+}
+
+
+#ifdef TEST
+void test_arena() {
+    Arena arena;
+    arena_init(&arena, 256);
+    int* a = arena_alloc(&arena, sizeof(int));
+    int* b = arena_alloc(&arena, sizeof(int));
+    *a = 1;
+    *b = 2;
+    assert(a != b);
+    assert((size_t)a % ALIGNMENT == 0 && (size_t)b % ALIGNMENT == 0);
+    assert(*a == 1 && *b == 2);
+
+    // The most recent allocation grows in place.
+    const Allocator* al = &arena.allocator;
+    char* s = allocator_alloc(al, 8);
+    strcpy(s, "abc");
+    char* t = allocator_realloc(al, s, 8, 64);
+    assert(t == s);
+    assert(strcmp(t, "abc") == 0);
+
+    // Oversized requests work and keep the current block.
+    char* big = arena_alloc(&arena, 4096);
+    memset(big, 'x', 4096);
+    char* after = arena_alloc(&arena, 8);
+    assert(after == t + 64);
+
+    // Growing an older allocation copies it.
+    char* u = allocator_realloc(al, s, 64, 128);
+    assert(u != s);
+    assert(strcmp(u, "abc") == 0);
+
+    char* dup = allocator_strdup(al, "hello");
+    assert(strcmp(dup, "hello") == 0);
+
+    arena_reset(&arena);
+    assert(arena.head && arena.head->next == NULL && arena.head->used == 0);
+    for (int i = 0; i < 1000; i++) {
+        int* p = arena_alloc(&arena, sizeof(int));
+        *p = i;
+    }
+    arena_destroy(&arena);
+    assert(arena.head == NULL);
+}
+
+void test_pool() {
+    Pool pool;
+    pool_init(&pool, sizeof(int), 4);
+    assert(pool.slot_len == sizeof(void*));
+    int* items[100];
+    for (int i = 0; i < 100; i++) {
+        items[i] = pool_alloc(&pool);
+        *items[i] = i;
+    }
+    for (int i = 0; i < 100; i++) assert(*items[i] == i);
+    pool_free(&pool, items[10]);
+    assert(pool_alloc(&pool) == items[10]);
+
+    // Oversized requests fall through to malloc and are recognised on free.
+    const Allocator* al = &pool.allocator;
+    char* big = allocator_alloc(al, 1024);
+    assert(!pool_find_slab(&pool, big));
+    allocator_free(al, big);
+    int* slot = allocator_alloc(al, sizeof(int));
+    assert(pool_find_slab(&pool, slot));
+    *slot = 42;
+    int* grown = allocator_realloc(al, slot, sizeof(int), 64 * sizeof(int));
+    assert(*grown == 42);
+    assert(!pool_find_slab(&pool, grown));
+    allocator_free(al, grown);
+    pool_destroy(&pool);
+
+    pool_init(&pool, 24, 0);
+    assert(pool.slot_len == 32);
+    void* p = pool_alloc(&pool);
+    assert((size_t)p % 16 == 0);
+    pool_destroy(&pool);
+}
+
+int main() {
+    test_arena();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_arena", "Passed");
+    test_pool();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_pool", "Passed");
+    return 0;
+}
+
+#endif // TEST
@@ -0,0 +1,193 @@
+/**
+ * Pluggable allocators. (Header file)
+ *
+ * An Allocator bundles the allocation callbacks used by the _ex variants of
+ * the library functions. Passing NULL wherever an allocator is expected
+ * selects the C library allocator (malloc, realloc and free).
+ *
+ * Two allocators ship with the library: a bump-pointer Arena, which releases
+ * everything it handed out with a single reset, and a fixed-size slab Pool,
+ * which recycles slots of one element length.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _ALLOCATOR_H_
+#define _ALLOCATOR_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include "functools_stats.h"
+
+/**
+ * An allocator context.
+ *
+ * @param alloc Allocates size bytes. Returns NULL on failure.
+ * @param realloc Resizes a block from old_size to new_size bytes.
+ * @param free Releases a block. May be a no-op (e.g. for arenas).
+ * @param ctx The state passed to every callback.
+ */
+typedef struct {
+    void* (*alloc)(void* ctx, size_t size);
+    void* (*realloc)(void* ctx, void* ptr, size_t old_size, size_t new_size);
+    void (*free)(void* ctx, void* ptr);
+    void* ctx;
+} Allocator;
+
+
+/**
+ * Allocate memory from an allocator, or from malloc() if it is NULL.
+ */
+static inline void* allocator_alloc(const Allocator* allocator, size_t size) {
+    STATS_ALLOC(size);
+    return allocator ? allocator->alloc(allocator->ctx, size) : malloc(size);
+}
+
+/**
+ * Resize memory from an allocator, or with realloc() if it is NULL.
+ */
+static inline void* allocator_realloc(const Allocator* allocator, void* ptr,
+    size_t old_size, size_t new_size) {
+    STATS_ALLOC(new_size > old_size ? new_size - old_size : 0);
+    return allocator
+        ? allocator->realloc(allocator->ctx, ptr, old_size, new_size)
+        : realloc(ptr, new_size);
+}
+
+/**
+ * Release memory to an allocator, or with free() if it is NULL.
+ */
+static inline void allocator_free(const Allocator* allocator, void* ptr) {
+    if (allocator) allocator->free(allocator->ctx, ptr);
+    else free(ptr);
+}
+
+/**
+ * Duplicate a string with an allocator, or with malloc() if it is NULL.
+ */
+static inline char* allocator_strdup(const Allocator* allocator, const char* s) {
+    size_t len = strlen(s) + 1;
+    char* ret = (char*)allocator_alloc(allocator, len);
+    if (ret) memcpy(ret, s, len);
+    return ret;
+}
+
+
+/**
+ * A block of arena memory. Private to allocator.c.
+ */
+typedef struct ArenaBlock ArenaBlock;
+
+/**
+ * A bump-pointer arena.
+ *
+ * @param head The block currently served from.
+ * @param block_size The usable size of a regular block.
+ * @param last The most recent allocation, which can be grown in place.
+ * @param allocator The Allocator view of this arena.
+ */
+typedef struct {
+    ArenaBlock* head;
+    size_t block_size;
+    void* last;
+    Allocator allocator;
+} Arena;
+
+/**
+ * Initialize an arena.
+ *
+ * @param arena The arena.
+ * @param block_size The size of each block. Zero selects a default of 64 KiB.
+ * Requests larger than a block get a dedicated block.
+ */
+void arena_init(Arena* arena, size_t block_size);
+
+/**
+ * Allocate memory from an arena. The memory is aligned for any type.
+ *
+ * @param arena The arena.
+ * @param size The number of bytes.
+ * @return A pointer to the memory, or NULL on failure.
+ */
+void* arena_alloc(Arena* arena, size_t size);
+
+/**
+ * Release everything allocated from an arena, keeping one block for reuse.
+ *
+ * @param arena The arena.
+ */
+void arena_reset(Arena* arena);
+
+/**
+ * Release all the memory held by an arena.
+ *
+ * @param arena The arena.
+ */
+void arena_destroy(Arena* arena);
+
+
+/**
+ * A slab of pool slots. Private to allocator.c.
+ */
+typedef struct PoolSlab PoolSlab;
+
+/**
+ * A pool of fixed-size slots carved from geometrically growing slabs.
+ *
+ * Requests no larger than the slot length are served from the slabs.
+ * Larger requests fall through to malloc(), so a pool can back every
+ * allocation of a function, including its output arrays.
+ *
+ * @param slabs The list of slabs, newest first.
+ * @param free_slots The list of released slots.
+ * @param slot_len The length of each slot.
+ * @param next_slots The number of slots in the next slab.
+ * @param allocator The Allocator view of this pool.
+ */
+typedef struct {
+    PoolSlab* slabs;
+    void* free_slots;
+    size_t slot_len;
+    size_t next_slots;
+    Allocator allocator;
+} Pool;
+
+/**
+ * Initialize a pool.
+ *
+ * @param pool The pool.
+ * @param el_len The length of the objects the pool serves.
+ * @param slots_per_slab The number of slots in the first slab. Zero selects
+ * a default of 64. Each following slab doubles in size.
+ */
+void pool_init(Pool* pool, size_t el_len, size_t slots_per_slab);
+
+/**
+ * Take one slot from a pool.
+ *
+ * @param pool The pool.
+ * @return A pointer to the slot, or NULL on failure.
+ */
+void* pool_alloc(Pool* pool);
+
+/**
+ * Return a slot to a pool.
+ *
+ * @param pool The pool.
+ * @param ptr A slot obtained from pool_alloc().
+ */
+void pool_free(Pool* pool, void* ptr);
+
+/**
+ * Release all the memory held by a pool.
+ *
+ * @param pool The pool.
+ */
+void pool_destroy(Pool* pool);
+
+
+#endif // _ALLOCATOR_H_
@@ -0,0 +1,525 @@
+/**
+ * Benchmarks of the public functions.
+ *
+ * Every case runs in a child process of its own, so that its peak resident
+ * set size is not hidden by the cases that ran before it. The child repeats
+ * the timed call until it has run for BENCH_MIN_TIME seconds and reports the
+ * fastest repetition, which is the least disturbed by the rest of the
+ * system. malloc() and friends are wrapped to count the allocations made by
+ * the timed call.
+ *
+ * Usage: bench [--max-size N] [--only NAME] [--json FILE]
+ *              [--baseline FILE] [--threshold PCT]
+ *
+ * With --baseline, every result that is more than PCT percent slower per
+ * element than the same case in the baseline is reported as a regression,
+ * and the exit status is 1.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "functools.h"
+#include "str_join.h"
+#include "str_split.h"
+#include "str_set.h"
+
+// The least time spent repeating a case, in seconds.
+#define BENCH_MIN_TIME 0.05
+
+// The default largest input size. Sizes up to 10^8 need several GB of
+// memory for the list functions, so they are only run on request.
+#define BENCH_DEFAULT_MAX_SIZE 1000000
+
+// The default regression threshold, in percent.
+#define BENCH_DEFAULT_THRESHOLD 25.0
+
+
+#ifdef __GLIBC__
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t n, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+
+static size_t alloc_count = 0;
+
+void* malloc(size_t size) {
+    alloc_count++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    alloc_count++;
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    alloc_count++;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    __libc_free(ptr);
+}
+#define ALLOC_COUNT() alloc_count
+#else
+// Allocations are only counted with glibc.
+#define ALLOC_COUNT() ((size_t)0)
+#endif
+
+
+/**
+ * The inputs and outputs of a case. Each case uses the fields it needs.
+ */
+typedef struct {
+    size_t n;
+    int* ints;
+    ObjList list;
+    ObjList out;
+    void* result;
+    char* str;
+    char** tokens;
+    char* joined;
+} BenchState;
+
+/**
+ * A benchmark case. setup() and teardown() run once; prepare() and
+ * cleanup() run around every repetition of run(), which alone is timed.
+ * Cases with selective set run once per selectivity.
+ */
+typedef struct {
+    const char* name;
+    int selective;
+    void (*setup)(BenchState* s);
+    void (*prepare)(BenchState* s);
+    void (*run)(BenchState* s);
+    void (*cleanup)(BenchState* s);
+    void (*teardown)(BenchState* s);
+} BenchCase;
+
+/**
+ * The measurements of a case.
+ */
+typedef struct {
+    char name[64];
+    size_t size;
+    double selectivity;
+    double ns_per_elem;
+    double elems_per_sec;
+    double allocs_per_run;
+    long peak_rss_kb;
+} BenchResult;
+
+
+// Elements below the threshold pass the filters. Elements are in 0..99.
+static int filter_threshold = 50;
+
+
+/**
+ * A deterministic stream of pseudo-random numbers.
+ */
+static unsigned int next_random(unsigned int* seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return *seed >> 16;
+}
+
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+
+// Callbacks.
+
+static int below_threshold(const void* elem, size_t _) {
+    return *(const int*)elem < filter_threshold;
+}
+
+static void* double_int(const void* elem, size_t _) {
+    int* out = malloc(sizeof(int));
+    *out = *(const int*)elem * 2;
+    return out;
+}
+
+static void* copy_int(const void* elem, size_t _) {
+    int* out = malloc(sizeof(int));
+    *out = *(const int*)elem;
+    return out;
+}
+
+static void* sum_ints(const void* prev, const void* elem, size_t _) {
+    long* out = malloc(sizeof(long));
+    *out = (prev ? *(const long*)prev : 0) + *(const int*)elem;
+    return out;
+}
+
+
+// Setup and cleanup shared by the cases.
+
+static void setup_ints(BenchState* s) {
+    unsigned int seed = 42;
+    s->ints = malloc(s->n * sizeof(int));
+    for (size_t i = 0; i < s->n; i++) s->ints[i] = (int)(next_random(&seed) % 100);
+}
+
+static void setup_list(BenchState* s) {
+    setup_ints(s);
+    s->list = map_data(&copy_int, s->ints, sizeof(int), s->n);
+}
+
+static void free_out(BenchState* s) {
+    free_list(s->out, 0);
+    s->out = NULL;
+}
+
+/**
+ * filter() shares the elements of its input, so only the array is freed.
+ */
+static void free_out_array(BenchState* s) {
+    free(s->out);
+    s->out = NULL;
+}
+
+static void free_result(BenchState* s) {
+    free(s->result);
+    s->result = NULL;
+}
+
+static void teardown_all(BenchState* s) {
+    free(s->ints);
+    free_list(s->list, 0);
+    free(s->str);
+    if (s->tokens) str_split_free(s->tokens);
+    free(s->joined);
+}
+
+/**
+ * A string of n bytes made of 7-letter words separated by commas.
+ */
+static void setup_csv(BenchState* s) {
+    unsigned int seed = 7;
+    s->str = malloc(s->n + 1);
+    for (size_t i = 0; i < s->n; i++) {
+        s->str[i] = i % 8 == 7 ? ',' : (char)('a' + next_random(&seed) % 26);
+    }
+    s->str[s->n] = '\0';
+}
+
+static void setup_letters(BenchState* s) {
+    unsigned int seed = 9;
+    s->str = malloc(s->n + 1);
+    for (size_t i = 0; i < s->n; i++) {
+        s->str[i] = (char)('a' + next_random(&seed) % 26);
+    }
+    s->str[s->n] = '\0';
+}
+
+/**
+ * n / 8 tokens of 7 letters, so that the joined string has about n bytes.
+ */
+static void setup_tokens(BenchState* s) {
+    setup_csv(s);
+    s->tokens = str_split(s->str, ",");
+}
+
+
+// Timed calls.
+
+static void run_filter_data(BenchState* s) {
+    s->out = filter_data(&below_threshold, s->ints, sizeof(int), s->n);
+}
+
+static void run_map_data(BenchState* s) {
+    s->out = map_data(&double_int, s->ints, sizeof(int), s->n);
+}
+
+static void run_reduce_data(BenchState* s) {
+    s->result = reduce_data(&sum_ints, s->ints, sizeof(int), s->n, NULL);
+}
+
+static void run_filter(BenchState* s) {
+    s->out = filter(&below_threshold, s->list);
+}
+
+static void run_map(BenchState* s) {
+    s->out = map(&double_int, s->list);
+}
+
+static void run_reduce(BenchState* s) {
+    s->result = reduce(&sum_ints, s->list, NULL);
+}
+
+static void prepare_free_list(BenchState* s) {
+    s->out = map_data(&double_int, s->ints, sizeof(int), s->n);
+}
+
+static void run_free_list(BenchState* s) {
+    free_list(s->out, 0);
+    s->out = NULL;
+}
+
+static void run_str_split(BenchState* s) {
+    s->tokens = str_split(s->str, ",");
+}
+
+static void cleanup_str_split(BenchState* s) {
+    str_split_free(s->tokens);
+    s->tokens = NULL;
+}
+
+static void run_str_join(BenchState* s) {
+    s->joined = str_join((const char**)s->tokens, ",");
+}
+
+static void free_joined(BenchState* s) {
+    free(s->joined);
+    s->joined = NULL;
+}
+
+static void run_str_set(BenchState* s) {
+    s->joined = str_set(s->str);
+}
+
+static void run_str_contains(BenchState* s) {
+    // The needle is absent, so the whole string is scanned.
+    volatile int found = str_contains(s->str, '#');
+    (void)found;
+}
+
+
+static const BenchCase cases[] = {
+    { "filter_data", 1, &setup_ints, NULL, &run_filter_data, &free_out, &teardown_all },
+    { "map_data", 0, &setup_ints, NULL, &run_map_data, &free_out, &teardown_all },
+    { "reduce_data", 0, &setup_ints, NULL, &run_reduce_data, &free_result, &teardown_all },
+    { "filter", 1, &setup_list, NULL, &run_filter, &free_out_array, &teardown_all },
+    { "map", 0, &setup_list, NULL, &run_map, &free_out, &teardown_all },
+    { "reduce", 0, &setup_list, NULL, &run_reduce, &free_result, &teardown_all },
+    { "free_list", 0, &setup_ints, &prepare_free_list, &run_free_list, NULL, &teardown_all },
+    { "str_split", 0, &setup_csv, NULL, &run_str_split, &cleanup_str_split, &teardown_all },
+    { "str_join", 0, &setup_tokens, NULL, &run_str_join, &free_joined, &teardown_all },
+    { "str_set", 0, &setup_letters, NULL, &run_str_set, &free_joined, &teardown_all },
+    { "str_contains", 0, &setup_letters, NULL, &run_str_contains, NULL, &teardown_all },
+};
+
+static const double selectivities[] = { 0.0, 0.1, 0.5, 0.9, 1.0 };
+
+
+/**
+ * Run a case and measure it. Runs in the child process.
+ */
+static void measure(const BenchCase* c, size_t n, double sel, BenchResult* r) {
+    BenchState s;
+    memset(&s, 0, sizeof(s));
+    s.n = n;
+    filter_threshold = (int)(sel * 100);
+    c->setup(&s);
+    double best = -1, total = 0;
+    size_t reps = 0, allocs = 0;
+    while (reps == 0 || total < BENCH_MIN_TIME) {
+        if (c->prepare) c->prepare(&s);
+        size_t before = ALLOC_COUNT();
+        double start = now();
+        c->run(&s);
+        double elapsed = now() - start;
+        allocs += ALLOC_COUNT() - before;
+        if (c->cleanup) c->cleanup(&s);
+        if (best < 0 || elapsed < best) best = elapsed;
+        total += elapsed;
+        reps++;
+    }
+    c->teardown(&s);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    snprintf(r->name, sizeof(r->name), "%s", c->name);
+    r->size = n;
+    r->selectivity = sel;
+    r->ns_per_elem = best * 1e9 / (double)n;
+    r->elems_per_sec = best > 0 ? (double)n / best : 0;
+    r->allocs_per_run = (double)allocs / (double)reps;
+    r->peak_rss_kb = usage.ru_maxrss;
+}
+
+
+/**
+ * Run a case in a child process. Returns 0 on success.
+ */
+static int measure_in_child(const BenchCase* c, size_t n, double sel,
+    BenchResult* r) {
+    int fds[2];
+    if (pipe(fds) != 0) return -1;
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid < 0) return -1;
+    if (pid == 0) {
+        close(fds[0]);
+        measure(c, n, sel, r);
+        ssize_t w = write(fds[1], r, sizeof(*r));
+        _exit(w == (ssize_t)sizeof(*r) ? 0 : 1);
+    }
+    close(fds[1]);
+    ssize_t got = read(fds[0], r, sizeof(*r));
+    close(fds[0]);
+    int status;
+    waitpid(pid, &status, 0);
+    if (got != (ssize_t)sizeof(*r) || !WIFEXITED(status)
+        || WEXITSTATUS(status) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+
+/**
+ * Find a case in a baseline file and return its time per element, or a
+ * negative value if it is not there. Results are stored one per line, in
+ * the format written by write_json().
+ */
+static double baseline_ns(FILE* f, const BenchResult* r) {
+    char line[512], name[64];
+    size_t size;
+    double sel, ns;
+    rewind(f);
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line,
+            " {\"name\": \"%63[^\"]\", \"size\": %zu, \"selectivity\": %lf, "
+            "\"ns_per_elem\": %lf", name, &size, &sel, &ns) != 4) {
+            continue;
+        }
+        if (strcmp(name, r->name) == 0 && size == r->size
+            && sel - r->selectivity < 1e-9 && r->selectivity - sel < 1e-9) {
+            return ns;
+        }
+    }
+    return -1;
+}
+
+
+static void write_json(FILE* f, const BenchResult* results, size_t count) {
+    fprintf(f, "{\n  \"results\": [\n");
+    for (size_t i = 0; i < count; i++) {
+        const BenchResult* r = &results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"size\": %zu, \"selectivity\": %.2f, "
+            "\"ns_per_elem\": %.4f, \"elems_per_sec\": %.0f, "
+            "\"allocs_per_run\": %.1f, \"peak_rss_kb\": %ld}%s\n",
+            r->name, r->size, r->selectivity, r->ns_per_elem,
+            r->elems_per_sec, r->allocs_per_run, r->peak_rss_kb,
+            i + 1 < count ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [--max-size N] [--only NAME] [--json FILE] "
+        "[--baseline FILE] [--threshold PCT]\n", prog);
+}
+
+
+int main(int argc, char** argv) {
+    size_t max_size = BENCH_DEFAULT_MAX_SIZE;
+    double threshold = BENCH_DEFAULT_THRESHOLD;
+    const char* only = NULL;
+    const char* json_path = NULL;
+    const char* baseline_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        if (strcmp(argv[i], "--max-size") == 0) {
+            max_size = (size_t)strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--only") == 0) {
+            only = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0) {
+            threshold = strtod(argv[++i], NULL);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    FILE* baseline = NULL;
+    if (baseline_path && !(baseline = fopen(baseline_path, "r"))) {
+        fprintf(stderr, "Cannot open the baseline %s\n", baseline_path);
+        return 2;
+    }
+
+    size_t n_cases = sizeof(cases) / sizeof(cases[0]);
+    size_t n_sel = sizeof(selectivities) / sizeof(selectivities[0]);
+    size_t cap = 64, count = 0, regressions = 0;
+    BenchResult* results = malloc(cap * sizeof(BenchResult));
+    if (!results) {
+        fprintf(stderr, "Out of memory\n");
+        return 2;
+    }
+    printf("%-14s %11s %6s %12s %14s %12s %12s\n", "function", "size", "sel",
+        "ns/elem", "elem/s", "allocs/run", "peak RSS kB");
+    for (size_t c = 0; c < n_cases; c++) {
+        if (only && strcmp(only, cases[c].name) != 0) continue;
+        for (size_t n = 10; n <= max_size; n *= 10) {
+            for (size_t k = 0; k < (cases[c].selective ? n_sel : 1); k++) {
+                double sel = cases[c].selective ? selectivities[k] : 1.0;
+                BenchResult r;
+                if (measure_in_child(&cases[c], n, sel, &r) != 0) {
+                    fprintf(stderr, "%s failed at size %zu\n", cases[c].name, n);
+                    continue;
+                }
+                printf("%-14s %11zu %6.2f %12.3f %14.0f %12.1f %12ld",
+                    r.name, r.size, r.selectivity, r.ns_per_elem,
+                    r.elems_per_sec, r.allocs_per_run, r.peak_rss_kb);
+                double base = baseline ? baseline_ns(baseline, &r) : -1;
+                if (base > 0 && r.ns_per_elem > base * (1 + threshold / 100)) {
+                    printf("  REGRESSION (baseline %.3f)", base);
+                    regressions++;
+                }
+                printf("\n");
+                if (count == cap) {
+                    BenchResult* tmp = realloc(results,
+                        2 * cap * sizeof(BenchResult));
+                    if (!tmp) {
+                        fprintf(stderr, "Out of memory\n");
+                        free(results);
+                        return 2;
+                    }
+                    results = tmp;
+                    cap *= 2;
+                }
+                results[count++] = r;
+            }
+        }
+    }
+
+    if (json_path) {
+        FILE* f = fopen(json_path, "w");
+        if (!f) {
+            fprintf(stderr, "Cannot write %s\n", json_path);
+            return 2;
+        }
+        write_json(f, results, count);
+        fclose(f);
+    }
+    if (baseline) {
+        fclose(baseline);
+        printf("%zu regression(s) over %.0f%% against %s\n", regressions,
+            threshold, baseline_path);
+    }
+    free(results);
+    return regressions > 0 ? 1 : 0;
+}
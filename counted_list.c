@@ -0,0 +1,231 @@
+/**
+ * Counted lists of objects.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "counted_list.h"
+#ifdef TEST
+#include <assert.h>
+#include <stdio.h>
+#endif
+
+
+// Documentation in header file.
+int counted_reserve(CountedList* list, size_t cap) {
+    if (!list) return -1;
+    if (cap <= list->cap) return 0;
+    void** tmp = realloc(list->data, cap * sizeof(void*));
+    if (!tmp) return -1;
+    list->data = tmp;
+    list->cap = cap;
+    return 0;
+}
+
+
+// Documentation in header file.
+int counted_push(CountedList* list, void* obj) {
+    if (!list) return -1;
+    if (list->len == list->cap
+        && counted_reserve(list, list->cap ? list->cap * 2 : 8) != 0) {
+        return -1;
+    }
+    list->data[list->len++] = obj;
+    return 0;
+}
+
+
+// Documentation in header file.
+CountedList counted_map(MapDataFn fn, const CountedList* input) {
+    CountedList out = { .data = NULL, .len = 0, .cap = 0 };
+    if (!fn || !input || input->len == 0) return out;
+    if (counted_reserve(&out, input->len) != 0) return out;
+    for (size_t i = 0; i < input->len; i++) {
+        out.data[i] = fn(input->data[i], i);
+    }
+    out.len = input->len;
+    return out;
+}
+
+
+// Documentation in header file.
+CountedList counted_filter(FilterDataFn fn, const CountedList* input) {
+    CountedList out = { .data = NULL, .len = 0, .cap = 0 };
+    if (!fn || !input) return out;
+    for (size_t i = 0; i < input->len; i++) {
+        if (fn(input->data[i], i) && counted_push(&out, input->data[i]) != 0) {
+            counted_free(&out, 0);
+            return out;
+        }
+    }
+    return out;
+}
+
+
+// Documentation in header file.
+void* counted_reduce(ReduceDataFn fn, const CountedList* input, void* init) {
+    if (!fn || !input || input->len == 0) return NULL;
+    void* tmp;
+    for (size_t i = 0; i < input->len; i++) {
+        tmp = fn(init, input->data[i], i);
+        free(init);
+        init = tmp;
+    }
+    return init;
+}
+
+
+// Documentation in header file.
+void* counted_reduce_into(ReduceIntoDataFn fn, const CountedList* input,
+    void* acc) {
+    if (!fn || !input || !acc) return NULL;
+    for (size_t i = 0; i < input->len; i++) {
+        fn(acc, input->data[i], i);
+    }
+    return acc;
+}
+
+
+// Documentation in header file.
+void counted_free(CountedList* list, int free_objects) {
+    if (!list) return;
+    if (free_objects) {
+        for (size_t i = 0; i < list->len; i++) free(list->data[i]);
+    }
+    free(list->data);
+    list->data = NULL;
+    list->len = 0;
+    list->cap = 0;
+}
+
+
+// Documentation in header file.
+CountedList counted_from_objlist(ObjList input) {
+    CountedList out = { .data = NULL, .len = 0, .cap = 0 };
+    if (!input) return out;
+    size_t len = 0;
+    while (input[len] != NULL) len++;
+    if (len == 0 || counted_reserve(&out, len) != 0) return out;
+    memcpy(out.data, input, len * sizeof(void*));
+    out.len = len;
+    return out;
+}
+
+
+// Documentation in header file.
+ObjList counted_to_objlist(const CountedList* list) {
+    size_t len = list ? list->len : 0;
+    ObjList out = malloc((len + 1) * sizeof(void*));
+    if (!out) return NULL;
+    size_t k = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (list->data[i] != NULL) out[k++] = list->data[i];
+    }
+    out[k] = NULL;
+    return out;
+}
+
+
+#ifdef TEST
+int is_even(const void* ii, size_t _) {
+    const int* i = ii;
+    return i && *i % 2 == 0;
+}
+
+void* cube(const void* ii, size_t _) {
+    const int* i = ii;
+    int* out = malloc(sizeof(int));
+    *out = *i * *i * *i;
+    return out;
+}
+
+void* sum(const void* prev, const void* elem, size_t _) {
+    const int zero = 0;
+    const int* p = prev ? prev : &zero;
+    const int* e = elem;
+    int* out = malloc(sizeof(int));
+    *out = *p + *e;
+    return out;
+}
+
+void count_nulls(void* acc, const void* elem, size_t _) {
+    if (!elem) (*(size_t*)acc)++;
+}
+
+void test_counted_push() {
+    CountedList list = { 0 };
+    int values[1000];
+    for (int i = 0; i < 1000; i++) {
+        values[i] = i;
+        assert(counted_push(&list, &values[i]) == 0);
+    }
+    assert(list.len == 1000);
+    assert(list.cap >= 1000 && list.cap < 2000);
+    assert(list.data[999] == &values[999]);
+    assert(counted_push(&list, NULL) == 0);
+    assert(list.len == 1001 && list.data[1000] == NULL);
+    size_t nulls = 0;
+    assert(counted_reduce_into(&count_nulls, &list, &nulls) == &nulls);
+    assert(nulls == 1);
+    counted_free(&list, 0);
+    assert(list.data == NULL && list.len == 0);
+}
+
+void test_counted_functions() {
+    int values[] = { 1, 2, 3, 4, 5 };
+    CountedList input = { 0 };
+    for (int i = 0; i < 5; i++) counted_push(&input, &values[i]);
+
+    CountedList mapped = counted_map(&cube, &input);
+    assert(mapped.len == 5);
+    assert(*(int*)mapped.data[4] == 125);
+
+    CountedList filtered = counted_filter(&is_even, &input);
+    assert(filtered.len == 2);
+    assert(filtered.data[0] == &values[1] && filtered.data[1] == &values[3]);
+    counted_free(&filtered, 0);
+
+    int* total = counted_reduce(&sum, &mapped, NULL);
+    assert(*total == 1 + 8 + 27 + 64 + 125);
+    free(total);
+    counted_free(&mapped, 1);
+    counted_free(&input, 0);
+}
+
+void test_counted_conversions() {
+    int values[] = { 1, 2, 3 };
+    void* legacy[] = { &values[0], &values[1], &values[2], NULL };
+    CountedList list = counted_from_objlist(legacy);
+    assert(list.len == 3 && list.data[2] == &values[2]);
+    counted_push(&list, NULL);
+    counted_push(&list, &values[0]);
+    ObjList back = counted_to_objlist(&list);
+    assert(back[0] == &values[0] && back[2] == &values[2]);
+    assert(back[3] == &values[0] && back[4] == NULL);
+    free(back);
+    counted_free(&list, 0);
+
+    list = counted_from_objlist(NULL);
+    assert(list.len == 0);
+    back = counted_to_objlist(&list);
+    assert(back[0] == NULL);
+    free(back);
+}
+
+int main() {
+    test_counted_push();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_counted_push", "Passed");
+    test_counted_functions();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_counted_functions", "Passed");
+    test_counted_conversions();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_counted_conversions", "Passed");
+    return 0;
+}
+
+#endif // TEST
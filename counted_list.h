@@ -0,0 +1,133 @@
+/**
+ * Counted lists of objects. (Header file)
+ *
+ * A CountedList stores its length and capacity next to the objects, so its
+ * length is known without a scan, appends grow the storage geometrically,
+ * and NULL is a valid element.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _COUNTED_LIST_H_
+#define _COUNTED_LIST_H_
+
+#include <stdlib.h>
+#include "functools.h"
+
+/**
+ * A counted list of objects.
+ *
+ * @param data The objects.
+ * @param len The number of objects in the list.
+ * @param cap The number of objects the storage can hold.
+ */
+typedef struct {
+    void** data;
+    size_t len;
+    size_t cap;
+} CountedList;
+
+
+/**
+ * Make sure a list can hold at least cap objects.
+ *
+ * @param list The list. A zeroed CountedList is a valid empty list.
+ * @param cap The number of objects.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int counted_reserve(CountedList* list, size_t cap);
+
+/**
+ * Append an object to a list, doubling the storage when it is full.
+ *
+ * @param list The list.
+ * @param obj The object. May be NULL.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int counted_push(CountedList* list, void* obj);
+
+/**
+ * Map a list of objects. See map().
+ *
+ * @param fn The map function. Must return a pointer to the mapped object.
+ * @param input The input list.
+ * @return The list of mapped objects, of the same length as the input.
+ *
+ * @note The returned list must be freed by the caller with counted_free().
+ */
+CountedList counted_map(MapDataFn fn, const CountedList* input);
+
+/**
+ * Filter a list of objects. See filter(). The output holds references to
+ * the objects of the input.
+ *
+ * @param fn The filter function. Must return 1 for true, 0 for false.
+ * @param input The input list.
+ * @return The list of the objects that passed the filter.
+ *
+ * @note The returned list must be freed by the caller with counted_free(),
+ * without freeing the objects.
+ */
+CountedList counted_filter(FilterDataFn fn, const CountedList* input);
+
+/**
+ * Reduce a list of objects. See reduce().
+ *
+ * @param fn The reduce function. Must return a pointer to the reduced value.
+ * @param input The input list.
+ * @param init The initial value of the accumulator.
+ * @return A pointer to the reduced value.
+ *
+ * @note The returned value must be freed by the caller.
+ */
+void* counted_reduce(ReduceDataFn fn, const CountedList* input, void* init);
+
+/**
+ * Reduce a list of objects into a caller-owned accumulator. See
+ * reduce_into().
+ *
+ * @param fn The reduce function. Must update the accumulator in place.
+ * @param input The input list.
+ * @param acc The accumulator, holding the initial value.
+ * @return The accumulator, or NULL on invalid input.
+ */
+void* counted_reduce_into(ReduceIntoDataFn fn, const CountedList* input,
+    void* acc);
+
+/**
+ * Free the storage of a list and reset it to an empty list.
+ *
+ * @param list The list.
+ * @param free_objects Non-zero to free the objects as well. NULL objects are
+ * skipped.
+ */
+void counted_free(CountedList* list, int free_objects);
+
+/**
+ * Make a counted list from a NULL terminated list. The objects are shared,
+ * not copied.
+ *
+ * @param input The NULL terminated list.
+ * @return The counted list. Empty on NULL input or allocation failure.
+ */
+CountedList counted_from_objlist(ObjList input);
+
+/**
+ * Make a NULL terminated list from a counted list. The objects are shared,
+ * not copied. NULL objects cannot appear in a NULL terminated list, so they
+ * are left out.
+ *
+ * @param list The counted list.
+ * @return The NULL terminated list, or NULL on allocation failure.
+ *
+ * @note The returned list must be freed by the caller, with free() when the
+ * objects still belong to the counted list.
+ */
+ObjList counted_to_objlist(const CountedList* list);
+
+
+#endif // _COUNTED_LIST_H_
@@ -0,0 +1,418 @@
+/**
+ * Removing duplicate elements.
+ *
+ * The hash set maps element hashes to element indices in the input, so it
+ * costs about 9 bytes per slot whatever the element length. As in
+ * group_data.c, the hashes of a batch of elements are computed before
+ * their lookups and the control bytes they will probe are prefetched. An
+ * element equal to the one before it is skipped without a lookup, so runs
+ * of duplicates cost one comparison per element.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <string.h>
+#include "distinct_data.h"
+#include "hash_index.h"
+#ifdef TEST
+#include <assert.h>
+#include <stdio.h>
+#endif
+
+// The number of elements hashed ahead of their lookups.
+#define DISTINCT_BATCH 32
+
+
+/**
+ * The input of a distinct call and the element being looked up. -- private
+ */
+typedef struct {
+    const unsigned char* input;
+    size_t el_len;
+    const unsigned char* probe;
+} DistinctCtx;
+
+
+/**
+ * Compare the element looked up with an element of the set. -- private
+ */
+static int element_eq(void* ctx, size_t id) {
+    const DistinctCtx* c = ctx;
+    return memcmp(c->input + id * c->el_len, c->probe, c->el_len) == 0;
+}
+
+
+/**
+ * Return the hash of an element of the set. -- private
+ */
+static uint64_t element_hash(void* ctx, size_t id) {
+    const DistinctCtx* c = ctx;
+    return hash_bytes(c->input + id * c->el_len, c->el_len, 0);
+}
+
+
+/**
+ * Append an element to a packed list, doubling its capacity as needed.
+ * -- private
+ */
+static int packed_append(PackedList* out, const void* elem) {
+    if (out->count == out->capacity) {
+        size_t cap = out->capacity ? out->capacity * 2 : 16;
+        void* data = realloc(out->data, cap * out->el_len);
+        if (!data) return -1;
+        out->data = data;
+        out->capacity = cap;
+    }
+    memcpy((unsigned char*)out->data + out->count * out->el_len, elem,
+        out->el_len);
+    out->count++;
+    return 0;
+}
+
+
+// Documentation in header file.
+PackedList distinct_data(const void* input, size_t el_len, size_t el_count) {
+    PackedList out = { .data = NULL, .count = 0, .el_len = el_len,
+        .capacity = 0, .allocator = NULL };
+    if (input == NULL || el_len == 0 || el_count == 0) {
+        out.el_len = 0;
+        return out;
+    }
+    DistinctCtx c = { .input = input, .el_len = el_len };
+    HashIndex set;
+    hash_index_init(&set, 0);
+    uint64_t hashes[DISTINCT_BATCH];
+    for (size_t b = 0; b < el_count; b += DISTINCT_BATCH) {
+        size_t n = el_count - b < DISTINCT_BATCH ? el_count - b : DISTINCT_BATCH;
+        for (size_t j = 0; j < n; j++) {
+            hashes[j] = hash_bytes(c.input + (b + j) * el_len, el_len, 0);
+            if (set.ctrl) {
+                __builtin_prefetch(set.ctrl
+                    + hash_index_group(&set, hashes[j]) * HASH_INDEX_GROUP);
+            }
+        }
+        for (size_t j = 0; j < n; j++) {
+            size_t i = b + j;
+            c.probe = c.input + i * el_len;
+            if (i > 0 && memcmp(c.probe - el_len, c.probe, el_len) == 0) {
+                continue;
+            }
+            size_t id = hash_index_insert(&set, hashes[j], i, &element_eq,
+                &element_hash, &c);
+            if (id == HASH_INDEX_NONE
+                || (id == i && packed_append(&out, c.probe) != 0)) {
+                hash_index_free(&set);
+                free_packed(&out);
+                return out;
+            }
+        }
+    }
+    hash_index_free(&set);
+    return out;
+}
+
+
+// Documentation in header file.
+PackedList distinct_data_sorted(const void* input, size_t el_len,
+    size_t el_count) {
+    PackedList out = { .data = NULL, .count = 0, .el_len = el_len,
+        .capacity = 0, .allocator = NULL };
+    if (input == NULL || el_len == 0 || el_count == 0) {
+        out.el_len = 0;
+        return out;
+    }
+    const unsigned char* ix = input;
+    for (size_t i = 0; i < el_count; i++) {
+        const unsigned char* elem = ix + i * el_len;
+        if (i > 0 && memcmp(elem - el_len, elem, el_len) == 0) continue;
+        if (packed_append(&out, elem) != 0) {
+            free_packed(&out);
+            return out;
+        }
+    }
+    return out;
+}
+
+
+// Documentation in header file.
+PackedList distinct_data_bounded(const void* input, size_t el_len,
+    size_t el_count, size_t max_bytes) {
+    PackedList out = { .data = NULL, .count = 0, .el_len = 0, .capacity = 0,
+        .allocator = NULL };
+    if (input == NULL || el_len == 0 || el_count == 0) return out;
+    // Every element may be distinct, so the partitions are sized for that.
+    // Each partition costs a scan of the input, so they are not split below
+    // DISTINCT_MIN_PARTITION elements, whatever the limit.
+    size_t n_partitions = 1;
+    while (max_bytes
+        && el_count / (2 * n_partitions) >= DISTINCT_MIN_PARTITION
+        && hash_index_bytes(el_count / n_partitions + 1) > max_bytes) {
+        n_partitions *= 2;
+    }
+    if (n_partitions == 1) return distinct_data(input, el_len, el_count);
+
+    size_t n_words = (el_count + 63) / 64;
+    uint64_t* first = calloc(n_words, sizeof(uint64_t));
+    HashIndex set;
+    if (!first || hash_index_init(&set, el_count / n_partitions + 1) != 0) {
+        free(first);
+        return out;
+    }
+    DistinctCtx c = { .input = input, .el_len = el_len };
+    size_t kept = 0;
+    for (size_t p = 0; p < n_partitions; p++) {
+        hash_index_clear(&set);
+        for (size_t i = 0; i < el_count; i++) {
+            c.probe = c.input + i * el_len;
+            uint64_t h = hash_bytes(c.probe, el_len, 0);
+            if (hash_index_partition(h, n_partitions) != p) continue;
+            size_t id = hash_index_insert(&set, h, i, &element_eq,
+                &element_hash, &c);
+            if (id == HASH_INDEX_NONE) {
+                hash_index_free(&set);
+                free(first);
+                return out;
+            }
+            if (id == i) {
+                first[i / 64] |= (uint64_t)1 << (i % 64);
+                kept++;
+            }
+        }
+    }
+    hash_index_free(&set);
+    out.data = malloc(kept * el_len);
+    if (!out.data) {
+        free(first);
+        return out;
+    }
+    out.el_len = el_len;
+    out.capacity = kept;
+    for (size_t w = 0; w < n_words; w++) {
+        for (uint64_t bits = first[w]; bits; bits &= bits - 1) {
+            size_t i = w * 64 + (size_t)__builtin_ctzll(bits);
+            memcpy((unsigned char*)out.data + out.count * el_len,
+                c.input + i * el_len, el_len);
+            out.count++;
+        }
+    }
+    free(first);
+    return out;
+}
+
+
+/**
+ * The input of a list distinct call and the object being looked up.
+ * -- private
+ */
+typedef struct {
+    ObjList input;
+    HashObjFn hash;
+    EqualObjFn eq;
+    const void* probe;
+} DistinctObjCtx;
+
+
+/**
+ * Compare the object looked up with an object of the set. -- private
+ */
+static int object_eq(void* ctx, size_t id) {
+    const DistinctObjCtx* c = ctx;
+    return c->eq(c->input[id], c->probe) != 0;
+}
+
+
+/**
+ * Return the hash of an object of the set. -- private
+ */
+static uint64_t object_hash(void* ctx, size_t id) {
+    const DistinctObjCtx* c = ctx;
+    return hash_u64(c->hash(c->input[id]));
+}
+
+
+// Documentation in header file.
+ObjList distinct(ObjList input, HashObjFn hash, EqualObjFn eq) {
+    if (input == NULL || input[0] == NULL || hash == NULL || eq == NULL) {
+        return NULL;
+    }
+    size_t n = 0;
+    while (input[n] != NULL) n++;
+    ObjList out = malloc((n + 1) * sizeof(void*));
+    if (out == NULL) return NULL;
+    DistinctObjCtx c = { .input = input, .hash = hash, .eq = eq };
+    HashIndex set;
+    hash_index_init(&set, 0);
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        c.probe = input[i];
+        // The user hash is mixed, so that weak hashes still spread out.
+        size_t id = hash_index_insert(&set, hash_u64(hash(input[i])), i,
+            &object_eq, &object_hash, &c);
+        if (id == HASH_INDEX_NONE) {
+            hash_index_free(&set);
+            free(out);
+            return NULL;
+        }
+        if (id == i) out[k++] = input[i];
+    }
+    hash_index_free(&set);
+    out[k] = NULL;
+    ObjList shrunk = realloc(out, (k + 1) * sizeof(void*));
+    return shrunk ? shrunk : out;
+}
+
+
+#ifdef TEST
+/**
+ * A record with padding, zeroed before use.
+ */
+typedef struct {
+    char tag;
+    long id;
+} Tagged;
+
+uint64_t hash_string(const void* obj) {
+    return hash_bytes(obj, strlen(obj), 0);
+}
+
+int equal_strings(const void* a, const void* b) {
+    return strcmp(a, b) == 0;
+}
+
+/**
+ * A weak hash, to force collisions.
+ */
+uint64_t hash_first_char(const void* obj) {
+    return (uint64_t)*(const char*)obj;
+}
+
+int* make_ids(size_t n, int distinct) {
+    int* ids = malloc(n * sizeof(int));
+    unsigned int seed = 7;
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1103515245u + 12345u;
+        ids[i] = (int)((seed >> 8) % (unsigned)distinct);
+    }
+    return ids;
+}
+
+/**
+ * Check a distinct list against a quadratic scan of the input.
+ */
+void check_distinct(const PackedList* out, const int* ids, size_t n) {
+    const int* d = out->data;
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        size_t j = 0;
+        while (j < i && ids[j] != ids[i]) j++;
+        if (j == i) {
+            assert(k < out->count && d[k] == ids[i]);
+            k++;
+        }
+    }
+    assert(k == out->count);
+}
+
+void test_distinct_data() {
+    int input[] = { 4, 1, 4, 4, 2, 1, 3, 2 };
+    PackedList out = distinct_data(input, sizeof(int), 8);
+    int expected[] = { 4, 1, 2, 3 };
+    assert(out.count == 4 && out.el_len == sizeof(int));
+    assert(memcmp(out.data, expected, sizeof(expected)) == 0);
+    free_packed(&out);
+
+    size_t n = 5000;
+    int* ids = make_ids(n, 700);
+    out = distinct_data(ids, sizeof(int), n);
+    check_distinct(&out, ids, n);
+    free_packed(&out);
+    free(ids);
+
+    Tagged tags[3];
+    memset(tags, 0, sizeof(tags));
+    tags[0].tag = 'a';
+    tags[0].id = 1;
+    tags[1].tag = 'b';
+    tags[1].id = 1;
+    tags[2] = tags[0];
+    out = distinct_data(tags, sizeof(Tagged), 3);
+    assert(out.count == 2);
+    free_packed(&out);
+
+    out = distinct_data(NULL, sizeof(int), 3);
+    assert(out.data == NULL && out.count == 0);
+}
+
+void test_distinct_data_sorted() {
+    int input[] = { 1, 1, 2, 3, 3, 3, 7 };
+    PackedList out = distinct_data_sorted(input, sizeof(int), 7);
+    int expected[] = { 1, 2, 3, 7 };
+    assert(out.count == 4);
+    assert(memcmp(out.data, expected, sizeof(expected)) == 0);
+    free_packed(&out);
+    // Equal elements only need to be adjacent.
+    int grouped[] = { 9, 9, 2, 5, 5 };
+    out = distinct_data_sorted(grouped, sizeof(int), 5);
+    assert(out.count == 3 && ((int*)out.data)[0] == 9);
+    free_packed(&out);
+}
+
+void test_distinct_data_bounded() {
+    size_t n = 20000;
+    int* ids = make_ids(n, 9000);
+    PackedList full = distinct_data(ids, sizeof(int), n);
+    size_t limits[] = { 0, 4096, 1 << 20 };
+    for (size_t l = 0; l < 3; l++) {
+        PackedList out = distinct_data_bounded(ids, sizeof(int), n, limits[l]);
+        assert(out.count == full.count);
+        assert(memcmp(out.data, full.data, full.count * sizeof(int)) == 0);
+        free_packed(&out);
+    }
+    free_packed(&full);
+    free(ids);
+
+    // A tiny limit is rounded up instead of scanning once per element.
+    n = 100000;
+    ids = make_ids(n, 50000);
+    full = distinct_data(ids, sizeof(int), n);
+    PackedList out = distinct_data_bounded(ids, sizeof(int), n, 1);
+    assert(out.count == full.count);
+    assert(memcmp(out.data, full.data, full.count * sizeof(int)) == 0);
+    free_packed(&out);
+    free_packed(&full);
+    free(ids);
+}
+
+void test_distinct() {
+    char* words[] = { "pear", "apple", "pear", "plum", "apple", "peach", NULL };
+    ObjList out = distinct((ObjList)words, &hash_string, &equal_strings);
+    assert(strcmp(out[0], "pear") == 0 && strcmp(out[1], "apple") == 0);
+    assert(strcmp(out[2], "plum") == 0 && strcmp(out[3], "peach") == 0);
+    assert(out[4] == NULL);
+    // The objects are shared with the input.
+    assert(out[0] == words[0]);
+    free(out);
+
+    out = distinct((ObjList)words, &hash_first_char, &equal_strings);
+    assert(out[3] != NULL && out[4] == NULL);
+    free(out);
+    assert(distinct(NULL, &hash_string, &equal_strings) == NULL);
+}
+
+int main() {
+    test_distinct_data();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_distinct_data", "Passed");
+    test_distinct_data_sorted();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_distinct_data_sorted", "Passed");
+    test_distinct_data_bounded();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_distinct_data_bounded", "Passed");
+    test_distinct();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_distinct", "Passed");
+    return 0;
+}
+
+#endif // TEST
@@ -0,0 +1,104 @@
+/**
+ * Removing duplicate elements. (Header file)
+ *
+ * The distinct functions keep the first occurrence of every element, in
+ * input order, in O(n) expected time. Elements of arrays are compared
+ * bytewise, so structs must have their padding zeroed; objects of lists
+ * are compared with user functions.
+ *
+ * The hash set behind them holds element indices only (see hash_index.h):
+ * the elements themselves are compared where they are, in the input.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _DISTINCT_DATA_H_
+#define _DISTINCT_DATA_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "functools.h"
+
+/**
+ * The fewest elements distinct_data_bounded() gives a partition, so that
+ * the number of scans of the input stays bounded for small limits.
+ */
+#define DISTINCT_MIN_PARTITION 1024
+
+/**
+ * Function type for hashing objects.
+ *
+ * @param obj The object.
+ * @return The hash of the object. Equal objects must have equal hashes.
+ */
+typedef uint64_t (*HashObjFn)(const void* obj);
+
+/**
+ * Function type for comparing objects.
+ *
+ * @param a The first object.
+ * @param b The second object.
+ * @return 1 if the objects are equal, 0 otherwise.
+ */
+typedef int (*EqualObjFn)(const void* a, const void* b);
+
+
+/**
+ * Remove the duplicate elements of an array.
+ *
+ * @param input The input array.
+ * @param el_len The length of each element.
+ * @param el_count The number of elements.
+ * @return The first occurrence of every element, in input order. Zeroed on
+ * invalid input or allocation failure.
+ *
+ * @note The returned list must be freed by the caller with free_packed().
+ */
+PackedList distinct_data(const void* input, size_t el_len, size_t el_count);
+
+/**
+ * Remove the duplicate elements of an array in which equal elements are
+ * adjacent, such as a sorted array, by comparing every element with the
+ * previous one. No hash set is built.
+ *
+ * @see distinct_data()
+ */
+PackedList distinct_data_sorted(const void* input, size_t el_len,
+    size_t el_count);
+
+/**
+ * Remove the duplicate elements of an array, keeping the hash set under
+ * about max_bytes. When the set of all the elements could be larger, the
+ * elements are split into partitions by hash and the input is scanned once
+ * per partition, with a set holding one partition at a time. The first
+ * occurrences are marked in a bitmap of el_count bits and copied out in
+ * input order at the end.
+ *
+ * @param max_bytes The memory allowed for the hash set. Zero means no
+ * limit. Limits below the size of a set of DISTINCT_MIN_PARTITION elements
+ * (18 KiB on 64-bit targets) are rounded up to it.
+ * @see distinct_data()
+ */
+PackedList distinct_data_bounded(const void* input, size_t el_len,
+    size_t el_count, size_t max_bytes);
+
+/**
+ * Remove the duplicate objects of a list.
+ *
+ * @param input The input list.
+ * @param hash The function hashing an object.
+ * @param eq The function comparing two objects.
+ * @return The first occurrence of every object, in input order. The last
+ * element is NULL. NULL on invalid input or allocation failure.
+ *
+ * @note The objects are shared with the input list: the returned array
+ * must be freed by the caller with free(), not with free_list().
+ */
+ObjList distinct(ObjList input, HashObjFn hash, EqualObjFn eq);
+
+
+#endif // _DISTINCT_DATA_H_
@@ -13,43 +13,82 @@
 #ifdef TEST
 #include <assert.h>
 #include <stdio.h>
+#include <stdint.h>
+#include "functools_typed.h"
 #endif // TEST
 
 
 // Documentation in functools.h
 ObjList filter_data(FilterDataFn fn, const void* input, size_t el_len, size_t el_count) {
+    return filter_data_ex(fn, input, el_len, el_count, NULL);
+}
+
+
+// Documentation in functools.h
+ObjList filter_data_ex(FilterDataFn fn, const void* input, size_t el_len,
+    size_t el_count, const Allocator* allocator) {
     if (input == NULL || fn == NULL || el_len == 0 || el_count == 0) {
         return NULL;
     }
-    ObjList out = NULL;
+    STATS_BEGIN(STATS_FILTER_DATA);
+    STATS_ELEMENTS(el_count);
+    size_t cap = 8; // capacity of the output array, including the NULL
+    ObjList out = allocator_alloc(allocator, sizeof(void*) * cap);
+    if (out == NULL) return NULL;
     size_t j = 0; // index of the current element
     size_t k = 0; // index of the current element in the output array
     unsigned char* ix = (unsigned char*)input;
     while (j < el_count) {
-        if (fn((void*)&ix[j * el_len], j)) {
-            out = realloc(out, sizeof(void*) * (k + 1));
-            out[k] = malloc(el_len);
+        int keep;
+        STATS_CALLBACK(keep = fn((void*)&ix[j * el_len], j));
+        if (keep) {
+            if (k + 1 == cap) {
+                ObjList tmp = allocator_realloc(allocator, out,
+                    sizeof(void*) * cap, sizeof(void*) * cap * 2);
+                if (tmp == NULL) {
+                    out[k] = NULL;
+                    free_list_ex(out, 0, allocator);
+                    return NULL;
+                }
+                out = tmp;
+                cap *= 2;
+            }
+            out[k] = allocator_alloc(allocator, el_len);
+            if (out[k] == NULL) {
+                free_list_ex(out, 0, allocator);
+                return NULL;
+            }
             memcpy(out[k], (char*)&ix[j * el_len], el_len);
             k++;
         }
         j++;
     }
-    out = realloc(out, sizeof(void*) * (k + 1));
     out[k] = NULL;
+    STATS_SURVIVORS(k);
     return out;
 }
 
 
 // Documentation in functools.h
 ObjList map_data(MapDataFn fn, const void* input, size_t el_len, size_t el_count) {
+    return map_data_ex(fn, input, el_len, el_count, NULL);
+}
+
+
+// Documentation in functools.h
+ObjList map_data_ex(MapDataFn fn, const void* input, size_t el_len,
+    size_t el_count, const Allocator* allocator) {
     if (input == NULL || fn == NULL || el_len == 0 || el_count == 0) {
         return NULL;
     }
-    ObjList out = malloc(sizeof(void*) * (el_count + 1));
+    STATS_BEGIN(STATS_MAP_DATA);
+    STATS_ELEMENTS(el_count);
+    ObjList out = allocator_alloc(allocator, sizeof(void*) * (el_count + 1));
+    if (out == NULL) return NULL;
     size_t j = 0; // index of the current element
     unsigned char* ix = (unsigned char*)input;
     while (j < el_count) {
-        out[j] = fn((void*)&ix[j * el_len], j);
+        STATS_CALLBACK(out[j] = fn((void*)&ix[j * el_len], j));
         j++;
     }
     out[j] = NULL;
@@ -60,16 +99,25 @@ ObjList map_data(MapDataFn fn, const void* input, size_t el_len, size_t el_count
 // Documentation in functools.h
 void* reduce_data(ReduceDataFn fn, const void* input,
     size_t el_len, size_t el_count, void* init) {
+    return reduce_data_ex(fn, input, el_len, el_count, init, NULL);
+}
+
+
+// Documentation in functools.h
+void* reduce_data_ex(ReduceDataFn fn, const void* input, size_t el_len,
+    size_t el_count, void* init, const Allocator* allocator) {
 
     if (input == NULL || fn == NULL || el_len == 0 || el_count == 0) {
         return NULL;
     }
+    STATS_BEGIN(STATS_REDUCE_DATA);
+    STATS_ELEMENTS(el_count);
     size_t j = 0; // index of the current element
     unsigned char* ix = (unsigned char*)input;
     void* tmp;
     while (j < el_count) {
-        tmp = fn(init, (void*)&ix[j * el_len], j);
-        free(init);
+        STATS_CALLBACK(tmp = fn(init, (void*)&ix[j * el_len], j));
+        if (init) allocator_free(allocator, init);
         init = tmp;
         j++;
     }
@@ -79,35 +127,65 @@ void* reduce_data(ReduceDataFn fn, const void* input,
 
 // Documentation in functools.h
 ObjList filter(FilterDataFn fn, ObjList input) {
+    return filter_ex(fn, input, NULL);
+}
+
+
+// Documentation in functools.h
+ObjList filter_ex(FilterDataFn fn, ObjList input, const Allocator* allocator) {
     if (input == NULL || input[0] == NULL || fn == NULL) {
         return NULL;
     }
-    ObjList out = NULL;
+    STATS_BEGIN(STATS_FILTER);
+    size_t cap = 8; // capacity of the output array, including the NULL
+    ObjList out = allocator_alloc(allocator, sizeof(void*) * cap);
+    if (out == NULL) return NULL;
     size_t i = 0;
     size_t j = 0;
     for (i = 0; input[i] != NULL; i++) {
-        if (fn(input[i], i)) {
-            out = realloc(out, sizeof(void*) * (j + 1));
+        int keep;
+        STATS_CALLBACK(keep = fn(input[i], i));
+        if (keep) {
+            if (j + 1 == cap) {
+                ObjList tmp = allocator_realloc(allocator, out,
+                    sizeof(void*) * cap, sizeof(void*) * cap * 2);
+                if (tmp == NULL) {
+                    allocator_free(allocator, out);
+                    return NULL;
+                }
+                out = tmp;
+                cap *= 2;
+            }
             out[j] = input[i];
             j++;
         }
     }
-    out = realloc(out, sizeof(void*) * (j + 1));
     out[j] = NULL;
+    STATS_ELEMENTS(i);
+    STATS_SURVIVORS(j);
     return out;
 }
 
 
 // Documentation in functools.h
 ObjList map(MapDataFn fn, ObjList input) {
+    return map_ex(fn, input, NULL);
+}
+
+
+// Documentation in functools.h
+ObjList map_ex(MapDataFn fn, ObjList input, const Allocator* allocator) {
     if (input == NULL || input[0] == NULL || fn == NULL) {
         return NULL;
     }
+    STATS_BEGIN(STATS_MAP);
     size_t i = 0;
     for (i = 0; input[i] != NULL; i++);
-    ObjList out = malloc(sizeof(void*) * (i + 1));
+    STATS_ELEMENTS(i);
+    ObjList out = allocator_alloc(allocator, sizeof(void*) * (i + 1));
+    if (out == NULL) return NULL;
     for (i = 0; input[i] != NULL; i++) {
-        out[i] = fn(input[i], i);
+        STATS_CALLBACK(out[i] = fn(input[i], i));
     }
     out[i] = NULL;
     return out;
@@ -116,27 +194,43 @@ ObjList map(MapDataFn fn, ObjList input) {
 
 // Documentation in functools.h
 void* reduce(ReduceDataFn fn, ObjList input, void* init) {
+    return reduce_ex(fn, input, init, NULL);
+}
+
+
+// Documentation in functools.h
+void* reduce_ex(ReduceDataFn fn, ObjList input, void* init,
+    const Allocator* allocator) {
     if (input == NULL || input[0] == NULL || fn == NULL) {
         return NULL;
     }
+    STATS_BEGIN(STATS_REDUCE);
     size_t i = 0;
     void* tmp;
     for (i = 0; input[i] != NULL; i++) {
-        tmp = fn(init, input[i], i);
-        free(init);
+        STATS_CALLBACK(tmp = fn(init, input[i], i));
+        if (init) allocator_free(allocator, init);
         init = tmp;
     }
+    STATS_ELEMENTS(i);
     return init;
 }
 
 
 // Documentation in functools.h
 void free_list(void** list, size_t list_len) {
+    free_list_ex(list, list_len, NULL);
+}
+
+
+// Documentation in functools.h
+void free_list_ex(void** list, size_t list_len, const Allocator* allocator) {
     if (list == NULL) return;
+    STATS_BEGIN(STATS_FREE_LIST);
     size_t i = 0;
     if (list_len == 0) {
         while (list[i] != NULL) {
-            free(list[i]);
+            allocator_free(allocator, list[i]);
             list[i] = NULL;
             i++;
         }
@@ -144,12 +238,138 @@ void free_list(void** list, size_t list_len) {
     else {
         for (i = 0; i < list_len; i++) {
             if (list[i] != NULL) {
-                free(list[i]);
+                allocator_free(allocator, list[i]);
                 list[i] = NULL;
             }
         }
     }
-    free(list);
+    STATS_ELEMENTS(i);
+    allocator_free(allocator, list);
+}
+
+
+// Documentation in functools.h
+PackedList filter_data_packed(
+    FilterDataFn fn, const void* input, size_t el_len, size_t el_count) {
+    return filter_data_packed_ex(fn, input, el_len, el_count, NULL);
+}
+
+
+// Documentation in functools.h
+PackedList filter_data_packed_ex(FilterDataFn fn, const void* input,
+    size_t el_len, size_t el_count, const Allocator* allocator) {
+    PackedList out = { .data = NULL, .count = 0, .el_len = 0, .capacity = 0,
+        .allocator = allocator };
+    if (input == NULL || fn == NULL || el_len == 0 || el_count == 0) {
+        return out;
+    }
+    STATS_BEGIN(STATS_FILTER_DATA_PACKED);
+    STATS_ELEMENTS(el_count);
+    out.el_len = el_len;
+    size_t j = 0; // index of the current element
+    unsigned char* ix = (unsigned char*)input;
+    while (j < el_count) {
+        int keep;
+        STATS_CALLBACK(keep = fn((void*)&ix[j * el_len], j));
+        if (keep) {
+            if (out.count == out.capacity) {
+                size_t cap = out.capacity ? out.capacity * 2 : 16;
+                if (cap > el_count) cap = el_count;
+                void* tmp = allocator_realloc(allocator, out.data,
+                    out.capacity * el_len, cap * el_len);
+                if (tmp == NULL) {
+                    free_packed(&out);
+                    return out;
+                }
+                out.data = tmp;
+                out.capacity = cap;
+            }
+            memcpy((char*)out.data + out.count * el_len, &ix[j * el_len], el_len);
+            out.count++;
+        }
+        j++;
+    }
+    STATS_SURVIVORS(out.count);
+    return out;
+}
+
+
+// Documentation in functools.h
+PackedList map_data_packed(MapIntoDataFn fn, const void* input,
+    size_t el_len, size_t el_count, size_t out_len) {
+    return map_data_packed_ex(fn, input, el_len, el_count, out_len, NULL);
+}
+
+
+// Documentation in functools.h
+PackedList map_data_packed_ex(MapIntoDataFn fn, const void* input,
+    size_t el_len, size_t el_count, size_t out_len,
+    const Allocator* allocator) {
+    PackedList out = { .data = NULL, .count = 0, .el_len = 0, .capacity = 0,
+        .allocator = allocator };
+    if (input == NULL || fn == NULL || el_len == 0 || el_count == 0
+        || out_len == 0) {
+        return out;
+    }
+    STATS_BEGIN(STATS_MAP_DATA_PACKED);
+    STATS_ELEMENTS(el_count);
+    out.data = allocator_alloc(allocator, el_count * out_len);
+    if (out.data == NULL) return out;
+    out.el_len = out_len;
+    out.capacity = el_count;
+    size_t j = 0; // index of the current element
+    unsigned char* ix = (unsigned char*)input;
+    unsigned char* ox = (unsigned char*)out.data;
+    while (j < el_count) {
+        STATS_CALLBACK(fn(&ox[j * out_len], &ix[j * el_len], j));
+        j++;
+    }
+    out.count = el_count;
+    return out;
+}
+
+
+// Documentation in functools.h
+void free_packed(PackedList* list) {
+    if (list == NULL) return;
+    if (list->data) allocator_free(list->allocator, list->data);
+    list->data = NULL;
+    list->count = 0;
+    list->el_len = 0;
+    list->capacity = 0;
+}
+
+
+// Documentation in functools.h
+void* reduce_data_into(ReduceIntoDataFn fn, const void* input, size_t el_len,
+    size_t el_count, void* acc) {
+    if (input == NULL || fn == NULL || el_len == 0 || acc == NULL) {
+        return NULL;
+    }
+    STATS_BEGIN(STATS_REDUCE_DATA_INTO);
+    STATS_ELEMENTS(el_count);
+    size_t j = 0; // index of the current element
+    const unsigned char* ix = (const unsigned char*)input;
+    while (j < el_count) {
+        STATS_CALLBACK(fn(acc, &ix[j * el_len], j));
+        j++;
+    }
+    return acc;
+}
+
+
+// Documentation in functools.h
+void* reduce_into(ReduceIntoDataFn fn, ObjList input, void* acc) {
+    if (input == NULL || fn == NULL || acc == NULL) {
+        return NULL;
+    }
+    STATS_BEGIN(STATS_REDUCE_INTO);
+    size_t i = 0;
+    for (i = 0; input[i] != NULL; i++) {
+        STATS_CALLBACK(fn(acc, input[i], i));
+    }
+    STATS_ELEMENTS(i);
+    return acc;
 }
 
 
@@ -178,6 +398,17 @@ void* sum(const void* prev, const void* elem, size_t _) {
 }
 
 
+void cube_into(void* out, const void* ii, size_t _) {
+    const int* i = ii;
+    *(int*)out = *i * *i * *i;
+}
+
+
+void sum_into(void* acc, const void* elem, size_t _) {
+    *(long*)acc += *(const int*)elem;
+}
+
+
 void test_filter_data() {
     int input[] = { 1, 2, 3, 4, 5 };
     int** output = (int**)filter_data(&is_even, input, sizeof(int), 5);
@@ -276,6 +507,176 @@ void test_reduce() {
 }
 
 
+void test_filter_data_packed() {
+    int input[] = { 1, 2, 3, 4, 5 };
+    PackedList output = filter_data_packed(&is_even, input, sizeof(int), 5);
+    assert(output.count == 2);
+    assert(output.el_len == sizeof(int));
+    assert(output.capacity >= output.count);
+    assert(((int*)output.data)[0] == 2);
+    assert(((int*)output.data)[1] == 4);
+    free_packed(&output);
+    assert(output.data == NULL && output.count == 0);
+
+    int odd[] = { 1, 3, 5 };
+    output = filter_data_packed(&is_even, odd, sizeof(int), 3);
+    assert(output.count == 0);
+    free_packed(&output);
+
+    int big[1000];
+    for (int i = 0; i < 1000; i++) big[i] = i;
+    output = filter_data_packed(&is_even, big, sizeof(int), 1000);
+    assert(output.count == 500);
+    for (int i = 0; i < 500; i++) assert(((int*)output.data)[i] == i * 2);
+    free_packed(&output);
+
+    output = filter_data_packed(&is_even, NULL, sizeof(int), 5);
+    assert(output.data == NULL && output.count == 0);
+}
+
+
+void test_map_data_packed() {
+    int input[] = { 1, 2, 3, 4, 5 };
+    PackedList output = map_data_packed(
+        &cube_into, input, sizeof(int), 5, sizeof(int));
+    assert(output.count == 5);
+    assert(((int*)output.data)[0] == 1);
+    assert(((int*)output.data)[1] == 8);
+    assert(((int*)output.data)[2] == 27);
+    assert(((int*)output.data)[3] == 64);
+    assert(((int*)output.data)[4] == 125);
+    free_packed(&output);
+}
+
+
+void test_reduce_data_into() {
+    int input[] = { 1, 2, 3, 4, 5 };
+    long acc = 10;
+    assert(reduce_data_into(&sum_into, input, sizeof(int), 5, &acc) == &acc);
+    assert(acc == 25);
+    assert(reduce_data_into(&sum_into, input, sizeof(int), 0, &acc) == &acc);
+    assert(acc == 25);
+    assert(reduce_data_into(&sum_into, NULL, sizeof(int), 5, &acc) == NULL);
+    assert(reduce_data_into(&sum_into, input, sizeof(int), 5, NULL) == NULL);
+}
+
+
+void test_reduce_into() {
+    int values[] = { 1, 2, 3, 4, 5 };
+    void* input[] = { &values[0], &values[1], &values[2], &values[3],
+        &values[4], NULL };
+    long acc = 0;
+    assert(reduce_into(&sum_into, input, &acc) == &acc);
+    assert(acc == 15);
+}
+
+
+FUNCTOOLS_DEFINE(int32_t, i32)
+
+static int is_even_i32(int32_t x, size_t _) { return x % 2 == 0; }
+static int32_t cube_i32(int32_t x, size_t _) { return x * x * x; }
+static int32_t add_i32(int32_t acc, int32_t x, size_t _) { return acc + x; }
+
+#define IS_ODD(x, i) ((x) % 2 != 0)
+#define TO_HALF(x, i) ((double)(x) / 2)
+#define ADD_WIDE(acc, x, i) ((acc) + (x))
+FUNCTOOLS_DEFINE_FILTER(filter_odd_i32, int32_t, IS_ODD)
+FUNCTOOLS_DEFINE_MAP(half_i32, int32_t, double, TO_HALF)
+FUNCTOOLS_DEFINE_REDUCE(sum_wide_i32, int32_t, int64_t, ADD_WIDE)
+
+
+void test_typed() {
+    int32_t input[] = { 1, 2, 3, 4, 5 };
+    int32_t out[5];
+    assert(filter_i32(&is_even_i32, input, 5, out) == 2);
+    assert(out[0] == 2 && out[1] == 4);
+    map_i32(&cube_i32, input, 5, out);
+    assert(out[0] == 1 && out[4] == 125);
+    assert(reduce_i32(&add_i32, input, 5, 10) == 25);
+
+    assert(filter_odd_i32(input, 5, out) == 3);
+    assert(out[0] == 1 && out[1] == 3 && out[2] == 5);
+    double halves[5];
+    half_i32(input, 5, halves);
+    assert(halves[0] == 0.5 && halves[4] == 2.5);
+    assert(sum_wide_i32(input, 5, (int64_t)INT32_MAX) == (int64_t)INT32_MAX + 15);
+}
+
+
+void test_ex_arena() {
+    Arena arena;
+    arena_init(&arena, 0);
+    int input[100];
+    for (int i = 0; i < 100; i++) input[i] = i;
+    int** output = (int**)filter_data_ex(
+        &is_even, input, sizeof(int), 100, &arena.allocator);
+    for (int i = 0; i < 50; i++) assert(*output[i] == i * 2);
+    assert(output[50] == NULL);
+    int** again = (int**)filter_ex(&is_even, (ObjList)output, &arena.allocator);
+    assert(*again[49] == 98 && again[50] == NULL);
+    PackedList packed = filter_data_packed_ex(
+        &is_even, input, sizeof(int), 100, &arena.allocator);
+    assert(packed.count == 50 && packed.allocator == &arena.allocator);
+    assert(((int*)packed.data)[49] == 98);
+    free_packed(&packed);
+    // One reset releases everything.
+    arena_reset(&arena);
+    arena_destroy(&arena);
+}
+
+
+void test_ex_pool() {
+    Pool pool;
+    pool_init(&pool, sizeof(int), 0);
+    int input[] = { 1, 2, 3, 4, 5 };
+    int** output = (int**)filter_data_ex(
+        &is_even, input, sizeof(int), 5, &pool.allocator);
+    assert(*output[0] == 2);
+    assert(*output[1] == 4);
+    assert(output[2] == NULL);
+    free_list_ex((ObjList)output, 0, &pool.allocator);
+    pool_destroy(&pool);
+}
+
+
+/**
+ * An allocator that fails once a number of allocations were made.
+ */
+static void* capped_alloc(void* ctx, size_t size) {
+    size_t* left = ctx;
+    if (*left == 0) return NULL;
+    (*left)--;
+    return malloc(size);
+}
+
+static void* capped_realloc(void* ctx, void* ptr, size_t _, size_t size) {
+    size_t* left = ctx;
+    if (*left == 0) return NULL;
+    (*left)--;
+    return realloc(ptr, size);
+}
+
+static void capped_free(void* _, void* ptr) {
+    free(ptr);
+}
+
+void test_ex_alloc_failure() {
+    int input[100];
+    for (int i = 0; i < 100; i++) input[i] = i;
+    size_t left = 0;
+    Allocator capped = { &capped_alloc, &capped_realloc, &capped_free, &left };
+    // Fail on the array, on an element copy and on a growth of the array.
+    for (size_t n = 0; n < 10; n++) {
+        left = n;
+        assert(filter_data_ex(&is_even, input, sizeof(int), 100, &capped) == NULL);
+    }
+    left = SIZE_MAX;
+    ObjList output = filter_data_ex(&is_even, input, sizeof(int), 100, &capped);
+    assert(output != NULL && *(int*)output[49] == 98);
+    free_list_ex(output, 0, &capped);
+}
+
+
 int main() {
     test_filter_data();
     printf("%s - \033[0;32m%s\033[0m\n", "test_filter_data", "Passed");
@@ -289,6 +690,22 @@ int main() {
     printf("%s - \033[0;32m%s\033[0m\n", "test_map", "Passed");
     test_reduce();
     printf("%s - \033[0;32m%s\033[0m\n", "test_reduce", "Passed");
+    test_filter_data_packed();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_filter_data_packed", "Passed");
+    test_map_data_packed();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_map_data_packed", "Passed");
+    test_reduce_data_into();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_reduce_data_into", "Passed");
+    test_reduce_into();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_reduce_into", "Passed");
+    test_typed();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_typed", "Passed");
+    test_ex_arena();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_ex_arena", "Passed");
+    test_ex_pool();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_ex_pool", "Passed");
+    test_ex_alloc_failure();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_ex_alloc_failure", "Passed");
     return 0;
 }
 
@@ -8,7 +8,11 @@
  * This code is released under the GPLv2.1 license. Refer to the LICENSE file
  * for more information.
  */
+#ifndef _FUNCTOOLS_H_
+#define _FUNCTOOLS_H_
+
 #include <stdlib.h>
+#include "allocator.h"
 
 /**
  * A list of objects.
@@ -43,6 +47,41 @@ typedef void* (*MapDataFn)(const void*, size_t index);
  */
 typedef void* (*ReduceDataFn)(const void* prev, const void* elem, size_t index);
 
+/**
+ * Function type for mapping into a caller-provided slot.
+ *
+ * @param out The output slot, large enough to hold one mapped element.
+ * @param elem The current element.
+ * @param index The index of the current element.
+ */
+typedef void (*MapIntoDataFn)(void* out, const void* elem, size_t index);
+
+/**
+ * Function type for reducing into a caller-owned accumulator.
+ *
+ * @param acc The accumulator, updated in place.
+ * @param elem The current element.
+ * @param index The index of the current element.
+ */
+typedef void (*ReduceIntoDataFn)(void* acc, const void* elem, size_t index);
+
+/**
+ * A list of fixed size elements stored contiguously in a single buffer.
+ *
+ * @param data The buffer holding the elements, or NULL if empty.
+ * @param count The number of elements in the buffer.
+ * @param el_len The length of each element.
+ * @param capacity The number of elements the buffer can hold.
+ * @param allocator The allocator owning the buffer, NULL for malloc().
+ */
+typedef struct {
+    void* data;
+    size_t count;
+    size_t el_len;
+    size_t capacity;
+    const Allocator* allocator;
+} PackedList;
+
 /**
  * Filter an array of elements.
  *
@@ -137,3 +176,165 @@ void* reduce(ReduceDataFn fn, ObjList input, void* init);
  * freed up to the specified length, skipping the NULL objects.
  */
 void free_list(void** list, size_t list_len);
+
+
+/**
+ * Filter an array of elements into a packed list.
+ *
+ * The surviving elements are copied into one contiguous buffer that grows
+ * geometrically, so the number of allocations is logarithmic in the number
+ * of surviving elements.
+ *
+ * @param fn The filter function. Must return 1 for true, 0 for false.
+ * @param input The input array.
+ * @param el_len The length of each element.
+ * @param el_count The number of elements.
+ * @return A packed list of the filtered elements. On invalid input, the
+ * returned list is zeroed.
+ *
+ * @note The returned list must be freed by the caller with free_packed().
+ */
+PackedList filter_data_packed(
+    FilterDataFn fn, const void* input, size_t el_len, size_t el_count);
+
+
+/**
+ * Map an array of elements into a packed list.
+ *
+ * @param fn The map function. Writes the mapped element into the given slot.
+ * @param input The input array.
+ * @param el_len The length of each element.
+ * @param el_count The number of elements.
+ * @param out_len The length of each mapped element.
+ * @return A packed list of the mapped elements. On invalid input, the
+ * returned list is zeroed.
+ *
+ * @note The returned list must be freed by the caller with free_packed().
+ */
+PackedList map_data_packed(MapIntoDataFn fn, const void* input,
+    size_t el_len, size_t el_count, size_t out_len);
+
+
+/**
+ * Free the buffer of a packed list and reset it to an empty list.
+ *
+ * @param list The packed list.
+ */
+void free_packed(PackedList* list);
+
+
+/**
+ * Reduce an array of elements into a caller-owned accumulator.
+ *
+ * Unlike reduce_data(), the reduce function updates the accumulator in
+ * place, so no memory is allocated or freed.
+ *
+ * @param fn The reduce function. Must update the accumulator in place.
+ * @param input The input array.
+ * @param el_len The length of each element.
+ * @param el_count The number of elements.
+ * @param acc The accumulator, holding the initial value.
+ * @return The accumulator, or NULL on invalid input.
+ */
+void* reduce_data_into(ReduceIntoDataFn fn, const void* input, size_t el_len,
+    size_t el_count, void* acc);
+
+
+/**
+ * Reduce a list of objects into a caller-owned accumulator.
+ *
+ * @param fn The reduce function. Must update the accumulator in place.
+ * @param input The input list.
+ * @param acc The accumulator, holding the initial value.
+ * @return The accumulator, or NULL on invalid input.
+ */
+void* reduce_into(ReduceIntoDataFn fn, ObjList input, void* acc);
+
+
+/*
+ * Allocator-aware variants.
+ *
+ * Each of the functions below behaves like the function of the same name
+ * without the _ex suffix, but takes every allocation it makes from the given
+ * allocator. Passing NULL selects malloc(), realloc() and free().
+ *
+ * The objects returned by MapDataFn and ReduceDataFn callbacks are allocated
+ * by the callbacks themselves. When such objects are released through an
+ * allocator (by reduce_data_ex(), reduce_ex() or free_list_ex()), the
+ * callbacks must take them from that same allocator.
+ */
+
+/**
+ * Filter an array of elements. See filter_data().
+ *
+ * @param allocator The allocator for the list and the element copies.
+ */
+ObjList filter_data_ex(FilterDataFn fn, const void* input, size_t el_len,
+    size_t el_count, const Allocator* allocator);
+
+/**
+ * Map an array of elements. See map_data().
+ *
+ * @param allocator The allocator for the list.
+ */
+ObjList map_data_ex(MapDataFn fn, const void* input, size_t el_len,
+    size_t el_count, const Allocator* allocator);
+
+/**
+ * Reduce an array of elements. See reduce_data().
+ *
+ * @param allocator The allocator the intermediate values are released to.
+ */
+void* reduce_data_ex(ReduceDataFn fn, const void* input, size_t el_len,
+    size_t el_count, void* init, const Allocator* allocator);
+
+/**
+ * Filter a list of objects. See filter().
+ *
+ * @param allocator The allocator for the list.
+ */
+ObjList filter_ex(FilterDataFn fn, ObjList input, const Allocator* allocator);
+
+/**
+ * Map a list of objects. See map().
+ *
+ * @param allocator The allocator for the list.
+ */
+ObjList map_ex(MapDataFn fn, ObjList input, const Allocator* allocator);
+
+/**
+ * Reduce a list of objects. See reduce().
+ *
+ * @param allocator The allocator the intermediate values are released to.
+ */
+void* reduce_ex(ReduceDataFn fn, ObjList input, void* init,
+    const Allocator* allocator);
+
+/**
+ * Free a list of objects and the inner objects. See free_list().
+ *
+ * @param allocator The allocator the list and its objects came from.
+ */
+void free_list_ex(void** list, size_t list_len, const Allocator* allocator);
+
+/**
+ * Filter an array of elements into a packed list. See filter_data_packed().
+ *
+ * @param allocator The allocator for the buffer. It is recorded in the
+ * returned list so that free_packed() releases the buffer to it.
+ */
+PackedList filter_data_packed_ex(FilterDataFn fn, const void* input,
+    size_t el_len, size_t el_count, const Allocator* allocator);
+
+/**
+ * Map an array of elements into a packed list. See map_data_packed().
+ *
+ * @param allocator The allocator for the buffer. It is recorded in the
+ * returned list so that free_packed() releases the buffer to it.
+ */
+PackedList map_data_packed_ex(MapIntoDataFn fn, const void* input,
+    size_t el_len, size_t el_count, size_t out_len,
+    const Allocator* allocator);
+
+
+#endif // _FUNCTOOLS_H_
@@ -0,0 +1,406 @@
+/**
+ * Built-in kernels for arrays of primitive types.
+ *
+ * The kernels are plain loops with independent lanes, written so that the
+ * compiler vectorizes them. On x86-64 each kernel is cloned for SSE2 (the
+ * baseline), AVX2 and AVX-512, and the loader picks the clone matching the
+ * CPU through CPUID. The filters also have a hand-written AVX-512 path that
+ * compacts the matching elements with compress-store instructions.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include "functools_simd.h"
+#ifdef TEST
+#include <assert.h>
+#include <stdio.h>
+#endif
+
+#if defined(__x86_64__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#include <immintrin.h>
+#define SIMD_DISPATCH __attribute__((target_clones("default", "avx2", "avx512f")))
+#define SIMD_AVX512_FILTER 1
+#endif
+#endif
+
+#ifndef SIMD_DISPATCH
+#define SIMD_DISPATCH
+#endif
+
+// Number of independent accumulators per reduction. Wide enough to fill
+// one AVX-512 register of 32-bit lanes.
+#define LANES 16
+
+
+/**
+ * Expand BODY once per comparison operator, switching on op outside of the
+ * loops so that each loop has a fixed comparison. -- private
+ */
+#define CMP_SWITCH(op, BODY) \
+    switch (op) { \
+    case CMP_LT: BODY(<); break; \
+    case CMP_LE: BODY(<=); break; \
+    case CMP_GT: BODY(>); break; \
+    case CMP_GE: BODY(>=); break; \
+    case CMP_EQ: BODY(==); break; \
+    case CMP_NE: BODY(!=); break; \
+    }
+
+
+/**
+ * Define the kernels of one element type. -- private
+ *
+ * @param SFX The suffix of the public functions.
+ * @param T The element type.
+ * @param S The type of the sum.
+ * @param A The type of the sum accumulators. Unsigned for integers, so that
+ * overflow wraps around.
+ * @param M The type the scale map computes in. Unsigned for integers.
+ * @param TMIN The smallest value of T.
+ * @param TMAX The largest value of T.
+ */
+#define DEFINE_KERNELS(SFX, T, S, A, M, TMIN, TMAX) \
+ \
+SIMD_DISPATCH \
+S sum_data_##SFX(const T* input, size_t count) { \
+    if (!input) return 0; \
+    A acc[LANES] = { 0 }; \
+    size_t i = 0; \
+    for (; i + LANES <= count; i += LANES) { \
+        for (size_t k = 0; k < LANES; k++) acc[k] += (A)input[i + k]; \
+    } \
+    A total = 0; \
+    for (size_t k = 0; k < LANES; k++) total += acc[k]; \
+    for (; i < count; i++) total += (A)input[i]; \
+    return (S)total; \
+} \
+ \
+SIMD_DISPATCH \
+T min_data_##SFX(const T* input, size_t count) { \
+    T m[LANES]; \
+    for (size_t k = 0; k < LANES; k++) m[k] = TMAX; \
+    if (!input) return TMAX; \
+    size_t i = 0; \
+    for (; i + LANES <= count; i += LANES) { \
+        for (size_t k = 0; k < LANES; k++) { \
+            m[k] = input[i + k] < m[k] ? input[i + k] : m[k]; \
+        } \
+    } \
+    T ret = TMAX; \
+    for (size_t k = 0; k < LANES; k++) ret = m[k] < ret ? m[k] : ret; \
+    for (; i < count; i++) ret = input[i] < ret ? input[i] : ret; \
+    return ret; \
+} \
+ \
+SIMD_DISPATCH \
+T max_data_##SFX(const T* input, size_t count) { \
+    T m[LANES]; \
+    for (size_t k = 0; k < LANES; k++) m[k] = TMIN; \
+    if (!input) return TMIN; \
+    size_t i = 0; \
+    for (; i + LANES <= count; i += LANES) { \
+        for (size_t k = 0; k < LANES; k++) { \
+            m[k] = input[i + k] > m[k] ? input[i + k] : m[k]; \
+        } \
+    } \
+    T ret = TMIN; \
+    for (size_t k = 0; k < LANES; k++) ret = m[k] > ret ? m[k] : ret; \
+    for (; i < count; i++) ret = input[i] > ret ? input[i] : ret; \
+    return ret; \
+} \
+ \
+SIMD_DISPATCH \
+size_t count_data_##SFX(const T* input, size_t count, CmpOp op, T value) { \
+    if (!input) return 0; \
+    size_t cnt[LANES] = { 0 }; \
+    size_t i = 0; \
+    CMP_SWITCH(op, COUNT_LOOP) \
+    size_t total = 0; \
+    for (size_t k = 0; k < LANES; k++) total += cnt[k]; \
+    return total; \
+} \
+ \
+/* Branchless compaction. Every element is stored, and the output index */ \
+/* only advances past the matching ones, so out needs one spare slot. */ \
+SIMD_DISPATCH \
+static size_t filter_scalar_##SFX(const T* input, size_t count, CmpOp op, \
+    T value, T* out) { \
+    size_t i = 0, k = 0; \
+    CMP_SWITCH(op, FILTER_LOOP) \
+    return k; \
+} \
+ \
+static size_t FILTER_KERNEL(SFX)(const T* input, size_t count, CmpOp op, \
+    T value, T* out); \
+ \
+PackedList filter_data_##SFX(const T* input, size_t count, CmpOp op, \
+    T value) { \
+    PackedList out = { .data = NULL, .count = 0, .el_len = 0, .capacity = 0, \
+        .allocator = NULL }; \
+    if (!input || count == 0 || op > CMP_NE) return out; \
+    out.el_len = sizeof(T); \
+    size_t n = count_data_##SFX(input, count, op, value); \
+    if (n == 0) return out; \
+    out.data = malloc((n + 1) * sizeof(T)); \
+    if (!out.data) return out; \
+    out.capacity = n + 1; \
+    out.count = FILTER_KERNEL(SFX)(input, count, op, value, out.data); \
+    return out; \
+} \
+ \
+SIMD_DISPATCH \
+static void scale_kernel_##SFX(const T* input, size_t count, T scale, \
+    T offset, T* out) { \
+    for (size_t i = 0; i < count; i++) { \
+        out[i] = (T)((M)input[i] * (M)scale + (M)offset); \
+    } \
+} \
+ \
+PackedList scale_data_##SFX(const T* input, size_t count, T scale, \
+    T offset) { \
+    PackedList out = { .data = NULL, .count = 0, .el_len = 0, .capacity = 0, \
+        .allocator = NULL }; \
+    if (!input || count == 0) return out; \
+    out.data = malloc(count * sizeof(T)); \
+    if (!out.data) return out; \
+    out.el_len = sizeof(T); \
+    out.count = out.capacity = count; \
+    scale_kernel_##SFX(input, count, scale, offset, out.data); \
+    return out; \
+} \
+ \
+SIMD_DISPATCH \
+static void clamp_kernel_##SFX(const T* input, size_t count, T lo, T hi, \
+    T* out) { \
+    for (size_t i = 0; i < count; i++) { \
+        T x = input[i] < lo ? lo : input[i]; \
+        out[i] = x > hi ? hi : x; \
+    } \
+} \
+ \
+PackedList clamp_data_##SFX(const T* input, size_t count, T lo, T hi) { \
+    PackedList out = { .data = NULL, .count = 0, .el_len = 0, .capacity = 0, \
+        .allocator = NULL }; \
+    if (!input || count == 0) return out; \
+    out.data = malloc(count * sizeof(T)); \
+    if (!out.data) return out; \
+    out.el_len = sizeof(T); \
+    out.count = out.capacity = count; \
+    clamp_kernel_##SFX(input, count, lo, hi, out.data); \
+    return out; \
+}
+
+#define COUNT_LOOP(OP) \
+    for (; i + LANES <= count; i += LANES) { \
+        for (size_t k = 0; k < LANES; k++) cnt[k] += input[i + k] OP value; \
+    } \
+    for (; i < count; i++) cnt[0] += input[i] OP value;
+
+#define FILTER_LOOP(OP) \
+    for (; i < count; i++) { \
+        out[k] = input[i]; \
+        k += input[i] OP value; \
+    }
+
+
+#ifdef SIMD_AVX512_FILTER
+/**
+ * Define the AVX-512 filter of one element type. The comparison of each
+ * block of 512 bits yields a lane mask, and compress-store writes the
+ * selected lanes contiguously. -- private
+ *
+ * @param SFX The suffix of the public functions.
+ * @param T The element type.
+ * @param W The number of lanes per register.
+ * @param VEC The register type.
+ * @param SET1 Broadcasts a value to all lanes.
+ * @param LOAD Loads an unaligned register.
+ * @param CMP The compare-into-mask intrinsic.
+ * @param COMPRESS The compress-store intrinsic.
+ * @param LT, LE, GT, GE, EQ, NE The comparison predicates of CMP.
+ */
+#define DEFINE_AVX512_FILTER(SFX, T, W, VEC, SET1, LOAD, CMP, COMPRESS, \
+    LT, LE, GT, GE, EQ, NE) \
+ \
+__attribute__((target("avx512f"))) \
+static size_t filter_avx512_##SFX(const T* input, size_t count, CmpOp op, \
+    T value, T* out) { \
+    const VEC c = SET1(value); \
+    size_t i = 0, k = 0; \
+    for (; i + W <= count; i += W) { \
+        VEC x = LOAD((const void*)(input + i)); \
+        unsigned m = 0; \
+        switch (op) { \
+        case CMP_LT: m = CMP(x, c, LT); break; \
+        case CMP_LE: m = CMP(x, c, LE); break; \
+        case CMP_GT: m = CMP(x, c, GT); break; \
+        case CMP_GE: m = CMP(x, c, GE); break; \
+        case CMP_EQ: m = CMP(x, c, EQ); break; \
+        case CMP_NE: m = CMP(x, c, NE); break; \
+        } \
+        COMPRESS((void*)(out + k), m, x); \
+        k += __builtin_popcount(m); \
+    } \
+    return k + filter_scalar_##SFX(input + i, count - i, op, value, out + k); \
+} \
+ \
+static size_t filter_kernel_##SFX(const T* input, size_t count, CmpOp op, \
+    T value, T* out) { \
+    if (__builtin_cpu_supports("avx512f")) { \
+        return filter_avx512_##SFX(input, count, op, value, out); \
+    } \
+    return filter_scalar_##SFX(input, count, op, value, out); \
+}
+
+#define FILTER_KERNEL(SFX) filter_kernel_##SFX
+#else
+#define FILTER_KERNEL(SFX) filter_scalar_##SFX
+#endif
+
+
+DEFINE_KERNELS(i32, int32_t, int64_t, uint64_t, uint32_t, INT32_MIN, INT32_MAX)
+DEFINE_KERNELS(i64, int64_t, int64_t, uint64_t, uint64_t, INT64_MIN, INT64_MAX)
+DEFINE_KERNELS(f32, float, double, double, float, -INFINITY, INFINITY)
+DEFINE_KERNELS(f64, double, double, double, double, -INFINITY, INFINITY)
+
+#ifdef SIMD_AVX512_FILTER
+DEFINE_AVX512_FILTER(i32, int32_t, 16, __m512i, _mm512_set1_epi32,
+    _mm512_loadu_si512, _mm512_cmp_epi32_mask, _mm512_mask_compressstoreu_epi32,
+    _MM_CMPINT_LT, _MM_CMPINT_LE, _MM_CMPINT_NLE, _MM_CMPINT_NLT,
+    _MM_CMPINT_EQ, _MM_CMPINT_NE)
+DEFINE_AVX512_FILTER(i64, int64_t, 8, __m512i, _mm512_set1_epi64,
+    _mm512_loadu_si512, _mm512_cmp_epi64_mask, _mm512_mask_compressstoreu_epi64,
+    _MM_CMPINT_LT, _MM_CMPINT_LE, _MM_CMPINT_NLE, _MM_CMPINT_NLT,
+    _MM_CMPINT_EQ, _MM_CMPINT_NE)
+DEFINE_AVX512_FILTER(f32, float, 16, __m512, _mm512_set1_ps,
+    _mm512_loadu_ps, _mm512_cmp_ps_mask, _mm512_mask_compressstoreu_ps,
+    _CMP_LT_OQ, _CMP_LE_OQ, _CMP_GT_OQ, _CMP_GE_OQ, _CMP_EQ_OQ, _CMP_NEQ_UQ)
+DEFINE_AVX512_FILTER(f64, double, 8, __m512d, _mm512_set1_pd,
+    _mm512_loadu_pd, _mm512_cmp_pd_mask, _mm512_mask_compressstoreu_pd,
+    _CMP_LT_OQ, _CMP_LE_OQ, _CMP_GT_OQ, _CMP_GE_OQ, _CMP_EQ_OQ, _CMP_NEQ_UQ)
+#endif
+
+
+#ifdef TEST
+void test_reductions() {
+    int32_t a[1000];
+    for (int i = 0; i < 1000; i++) a[i] = (i * 37) % 1000 - 500;
+    assert(sum_data_i32(a, 1000) == -500);
+    assert(min_data_i32(a, 1000) == -500);
+    assert(max_data_i32(a, 1000) == 499);
+    assert(min_data_i32(a, 0) == INT32_MAX);
+    assert(max_data_i32(a, 0) == INT32_MIN);
+    assert(sum_data_i32(a, 3) == a[0] + a[1] + a[2]);
+
+    int32_t big[] = { INT32_MAX, INT32_MAX, INT32_MAX };
+    assert(sum_data_i32(big, 3) == 3 * (int64_t)INT32_MAX);
+
+    int64_t b[37];
+    for (int i = 0; i < 37; i++) b[i] = (int64_t)i * 1000000000LL;
+    assert(sum_data_i64(b, 37) == 666000000000LL);
+    assert(max_data_i64(b, 37) == 36000000000LL);
+    assert(min_data_i64(b, 37) == 0);
+
+    float f[100];
+    for (int i = 0; i < 100; i++) f[i] = (float)i - 10.5f;
+    assert(sum_data_f32(f, 100) == 4950.0 - 1050.0);
+    assert(min_data_f32(f, 100) == -10.5f);
+    assert(max_data_f32(f, 100) == 88.5f);
+    f[50] = NAN;
+    assert(max_data_f32(f, 100) == 88.5f);
+    assert(min_data_f32(f, 0) == INFINITY);
+
+    double d[] = { 1.5, -2.5, 3.0 };
+    assert(sum_data_f64(d, 3) == 2.0);
+    assert(min_data_f64(d, 3) == -2.5);
+    assert(max_data_f64(d, 3) == 3.0);
+}
+
+void test_count_and_filter() {
+    int32_t a[1003];
+    for (int i = 0; i < 1003; i++) a[i] = i;
+    assert(count_data_i32(a, 1003, CMP_LT, 100) == 100);
+    assert(count_data_i32(a, 1003, CMP_LE, 100) == 101);
+    assert(count_data_i32(a, 1003, CMP_GT, 100) == 902);
+    assert(count_data_i32(a, 1003, CMP_GE, 100) == 903);
+    assert(count_data_i32(a, 1003, CMP_EQ, 100) == 1);
+    assert(count_data_i32(a, 1003, CMP_NE, 100) == 1002);
+
+    PackedList out = filter_data_i32(a, 1003, CMP_GE, 990);
+    assert(out.count == 13 && out.el_len == sizeof(int32_t));
+    for (int i = 0; i < 13; i++) assert(((int32_t*)out.data)[i] == 990 + i);
+    free_packed(&out);
+    out = filter_data_i32(a, 1003, CMP_LT, 0);
+    assert(out.count == 0 && out.data == NULL);
+    free_packed(&out);
+
+    int64_t b[21];
+    for (int i = 0; i < 21; i++) b[i] = i % 3;
+    out = filter_data_i64(b, 21, CMP_EQ, 2);
+    assert(out.count == 7);
+    for (int i = 0; i < 7; i++) assert(((int64_t*)out.data)[i] == 2);
+    free_packed(&out);
+
+    float f[40];
+    for (int i = 0; i < 40; i++) f[i] = (float)i;
+    f[3] = NAN;
+    assert(count_data_f32(f, 40, CMP_NE, 5.0f) == 39);
+    out = filter_data_f32(f, 40, CMP_LT, 5.0f);
+    assert(out.count == 4);
+    assert(((float*)out.data)[3] == 4.0f);
+    free_packed(&out);
+
+    double d[] = { 0.5, 2.5, -1.0, 7.0, 2.5 };
+    out = filter_data_f64(d, 5, CMP_GT, 1.0);
+    assert(out.count == 3);
+    assert(((double*)out.data)[0] == 2.5 && ((double*)out.data)[1] == 7.0);
+    free_packed(&out);
+}
+
+void test_maps() {
+    int32_t a[50];
+    for (int i = 0; i < 50; i++) a[i] = i - 25;
+    PackedList out = scale_data_i32(a, 50, 3, 1);
+    assert(out.count == 50);
+    for (int i = 0; i < 50; i++) assert(((int32_t*)out.data)[i] == a[i] * 3 + 1);
+    free_packed(&out);
+    out = clamp_data_i32(a, 50, -5, 5);
+    for (int i = 0; i < 50; i++) {
+        int32_t e = a[i] < -5 ? -5 : a[i] > 5 ? 5 : a[i];
+        assert(((int32_t*)out.data)[i] == e);
+    }
+    free_packed(&out);
+
+    double d[] = { -3.0, 0.25, 9.0 };
+    out = scale_data_f64(d, 3, 2.0, 0.5);
+    assert(((double*)out.data)[0] == -5.5);
+    assert(((double*)out.data)[1] == 1.0);
+    free_packed(&out);
+    out = clamp_data_f64(d, 3, 0.0, 1.0);
+    assert(((double*)out.data)[0] == 0.0);
+    assert(((double*)out.data)[1] == 0.25);
+    assert(((double*)out.data)[2] == 1.0);
+    free_packed(&out);
+    out = scale_data_f32(NULL, 3, 1.0f, 0.0f);
+    assert(out.data == NULL && out.count == 0);
+}
+
+int main() {
+    test_reductions();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_reductions", "Passed");
+    test_count_and_filter();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_count_and_filter", "Passed");
+    test_maps();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_maps", "Passed");
+    return 0;
+}
+
+#endif // TEST
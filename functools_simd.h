@@ -0,0 +1,166 @@
+/**
+ * Built-in kernels for arrays of primitive types. (Header file)
+ *
+ * These functions cover the most common reductions, filters and maps over
+ * arrays of int32_t, int64_t, float and double without going through a
+ * callback per element. Each kernel is built for SSE2, AVX2 and AVX-512,
+ * and the best version for the running CPU is picked once at load time.
+ * Other platforms get the portable scalar version.
+ *
+ * Every function exists once per type, with the suffix _i32, _i64, _f32 or
+ * _f64. The _i32 versions are documented below; the others differ only in
+ * their element type (T) and in the type of their sum (S).
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _FUNCTOOLS_SIMD_H_
+#define _FUNCTOOLS_SIMD_H_
+
+#include <stdint.h>
+#include "functools.h"
+
+/**
+ * Comparison operators for the count and filter kernels. An element x
+ * passes when "x op value" holds.
+ */
+typedef enum {
+    CMP_LT, // x < value
+    CMP_LE, // x <= value
+    CMP_GT, // x > value
+    CMP_GE, // x >= value
+    CMP_EQ, // x == value
+    CMP_NE  // x != value
+} CmpOp;
+
+
+/**
+ * Sum an array. Integer sums wrap around on overflow.
+ *
+ * @param input The input array.
+ * @param count The number of elements.
+ * @return The sum, or zero for an empty array.
+ */
+int64_t sum_data_i32(const int32_t* input, size_t count);
+
+/**
+ * Find the smallest element of an array. NaNs are ignored.
+ *
+ * @param input The input array.
+ * @param count The number of elements.
+ * @return The smallest element, or the largest value of the type (+INFINITY
+ * for floating point) for an empty array.
+ */
+int32_t min_data_i32(const int32_t* input, size_t count);
+
+/**
+ * Find the largest element of an array. NaNs are ignored.
+ *
+ * @param input The input array.
+ * @param count The number of elements.
+ * @return The largest element, or the smallest value of the type (-INFINITY
+ * for floating point) for an empty array.
+ */
+int32_t max_data_i32(const int32_t* input, size_t count);
+
+/**
+ * Count the elements of an array that compare true against a value.
+ *
+ * @param input The input array.
+ * @param count The number of elements.
+ * @param op The comparison.
+ * @param value The value to compare against.
+ * @return The number of matching elements.
+ */
+size_t count_data_i32(const int32_t* input, size_t count, CmpOp op,
+    int32_t value);
+
+/**
+ * Filter the elements of an array that compare true against a value.
+ *
+ * @param input The input array.
+ * @param count The number of elements.
+ * @param op The comparison.
+ * @param value The value to compare against.
+ * @return A packed list of the matching elements, in input order. On
+ * invalid input, the returned list is zeroed.
+ *
+ * @note The returned list must be freed by the caller with free_packed().
+ */
+PackedList filter_data_i32(const int32_t* input, size_t count, CmpOp op,
+    int32_t value);
+
+/**
+ * Map every element x of an array to x * scale + offset. Integer results
+ * wrap around on overflow.
+ *
+ * @param input The input array.
+ * @param count The number of elements.
+ * @param scale The factor.
+ * @param offset The term added after scaling.
+ * @return A packed list of the mapped elements. On invalid input, the
+ * returned list is zeroed.
+ *
+ * @note The returned list must be freed by the caller with free_packed().
+ */
+PackedList scale_data_i32(const int32_t* input, size_t count, int32_t scale,
+    int32_t offset);
+
+/**
+ * Map every element of an array into the range [lo, hi].
+ *
+ * @param input The input array.
+ * @param count The number of elements.
+ * @param lo The lower bound.
+ * @param hi The upper bound.
+ * @return A packed list of the clamped elements. On invalid input, the
+ * returned list is zeroed.
+ *
+ * @note The returned list must be freed by the caller with free_packed().
+ */
+PackedList clamp_data_i32(const int32_t* input, size_t count, int32_t lo,
+    int32_t hi);
+
+
+int64_t sum_data_i64(const int64_t* input, size_t count);
+int64_t min_data_i64(const int64_t* input, size_t count);
+int64_t max_data_i64(const int64_t* input, size_t count);
+size_t count_data_i64(const int64_t* input, size_t count, CmpOp op,
+    int64_t value);
+PackedList filter_data_i64(const int64_t* input, size_t count, CmpOp op,
+    int64_t value);
+PackedList scale_data_i64(const int64_t* input, size_t count, int64_t scale,
+    int64_t offset);
+PackedList clamp_data_i64(const int64_t* input, size_t count, int64_t lo,
+    int64_t hi);
+
+double sum_data_f32(const float* input, size_t count);
+float min_data_f32(const float* input, size_t count);
+float max_data_f32(const float* input, size_t count);
+size_t count_data_f32(const float* input, size_t count, CmpOp op,
+    float value);
+PackedList filter_data_f32(const float* input, size_t count, CmpOp op,
+    float value);
+PackedList scale_data_f32(const float* input, size_t count, float scale,
+    float offset);
+PackedList clamp_data_f32(const float* input, size_t count, float lo,
+    float hi);
+
+double sum_data_f64(const double* input, size_t count);
+double min_data_f64(const double* input, size_t count);
+double max_data_f64(const double* input, size_t count);
+size_t count_data_f64(const double* input, size_t count, CmpOp op,
+    double value);
+PackedList filter_data_f64(const double* input, size_t count, CmpOp op,
+    double value);
+PackedList scale_data_f64(const double* input, size_t count, double scale,
+    double offset);
+PackedList clamp_data_f64(const double* input, size_t count, double lo,
+    double hi);
+
+
+#endif // _FUNCTOOLS_SIMD_H_
@@ -0,0 +1,338 @@
+/**
+ * Call statistics of the library functions.
+ *
+ * Each thread adds its counts to a block of its own, so recording takes no
+ * lock and shares no cache line with other threads. The blocks are linked
+ * in a list that snapshots walk under a lock; the counters are written and
+ * read with relaxed atomic accesses, so a snapshot never sees a torn value.
+ * When a thread exits, its block is folded into the counts of the retired
+ * threads and released.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <string.h>
+#include "functools_stats.h"
+#ifdef FUNCTOOLS_STATS
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#endif
+#ifdef TEST
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include "functools.h"
+#include "str_set.h"
+#endif
+
+
+static const char* const stats_names[STATS_FN_COUNT] = {
+    "filter_data", "map_data", "reduce_data", "filter", "map", "reduce",
+    "free_list", "filter_data_packed", "map_data_packed", "reduce_data_into",
+    "reduce_into", "str_split", "str_split_views", "str_join",
+    "str_join_views", "str_set", "str_contains"
+};
+
+
+// Documentation in header file.
+const char* functools_stats_name(StatsFn fn) {
+    if ((int)fn < 0 || fn >= STATS_FN_COUNT) return NULL;
+    return stats_names[fn];
+}
+
+
+#ifdef FUNCTOOLS_STATS
+
+// The number of counters of a FunctoolsFnStats.
+#define STATS_FIELDS (sizeof(FunctoolsFnStats) / sizeof(uint64_t))
+
+/**
+ * The counters of one thread. -- private
+ */
+typedef struct StatsBlock {
+    struct StatsBlock* next;
+    FunctoolsStats stats;
+} StatsBlock;
+
+static int stats_enabled = 0;
+static pthread_mutex_t blocks_lock = PTHREAD_MUTEX_INITIALIZER;
+static StatsBlock* blocks = NULL;
+static FunctoolsStats retired;
+static pthread_key_t block_key;
+static pthread_once_t block_key_once = PTHREAD_ONCE_INIT;
+static __thread StatsBlock* thread_block = NULL;
+static __thread StatsScope* current_scope = NULL;
+
+
+/**
+ * Add the counters of src to dst, reading src atomically. -- private
+ */
+static void add_stats(FunctoolsStats* dst, FunctoolsStats* src) {
+    uint64_t* d = (uint64_t*)dst->fn;
+    uint64_t* s = (uint64_t*)src->fn;
+    for (size_t i = 0; i < STATS_FN_COUNT * STATS_FIELDS; i++) {
+        d[i] += __atomic_load_n(&s[i], __ATOMIC_RELAXED);
+    }
+}
+
+
+/**
+ * Fold the block of an exiting thread into the retired counts. -- private
+ */
+static void retire_block(void* ptr) {
+    StatsBlock* block = ptr;
+    pthread_mutex_lock(&blocks_lock);
+    add_stats(&retired, &block->stats);
+    for (StatsBlock** p = &blocks; *p; p = &(*p)->next) {
+        if (*p == block) {
+            *p = block->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&blocks_lock);
+    free(block);
+}
+
+
+static void make_block_key(void) {
+    pthread_key_create(&block_key, &retire_block);
+}
+
+
+/**
+ * Return the block of the calling thread, creating it on first use.
+ * -- private
+ */
+static StatsBlock* get_block(void) {
+    if (thread_block) return thread_block;
+    pthread_once(&block_key_once, &make_block_key);
+    StatsBlock* block = calloc(1, sizeof(StatsBlock));
+    if (!block) return NULL;
+    pthread_mutex_lock(&blocks_lock);
+    block->next = blocks;
+    blocks = block;
+    pthread_mutex_unlock(&blocks_lock);
+    pthread_setspecific(block_key, block);
+    thread_block = block;
+    return block;
+}
+
+
+/**
+ * Read a clock in nanoseconds. -- private
+ */
+static uint64_t read_clock(clockid_t id) {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+
+// Documentation in header file.
+uint64_t stats_clock(void) {
+    return read_clock(CLOCK_MONOTONIC);
+}
+
+
+// Documentation in header file.
+uint64_t stats_cpu_clock(void) {
+    return read_clock(CLOCK_THREAD_CPUTIME_ID);
+}
+
+
+// Documentation in header file.
+void stats_begin(StatsScope* scope, StatsFn fn) {
+    memset(&scope->counts, 0, sizeof(scope->counts));
+    scope->active = __atomic_load_n(&stats_enabled, __ATOMIC_RELAXED);
+    if (!scope->active) return;
+    scope->fn = (int)fn;
+    scope->outer = current_scope;
+    current_scope = scope;
+    scope->counts.calls = 1;
+    scope->cpu_start = stats_cpu_clock();
+    scope->wall_start = stats_clock();
+}
+
+
+// Documentation in header file.
+void stats_end(StatsScope* scope) {
+    if (!scope->active) return;
+    scope->counts.wall_ns = stats_clock() - scope->wall_start;
+    scope->counts.cpu_ns = stats_cpu_clock() - scope->cpu_start;
+    current_scope = scope->outer;
+    StatsBlock* block = get_block();
+    if (!block) return;
+    // functools_stats_reset() may zero the block meanwhile, so the counts
+    // are added atomically rather than stored back.
+    uint64_t* d = (uint64_t*)&block->stats.fn[scope->fn];
+    const uint64_t* s = (const uint64_t*)&scope->counts;
+    for (size_t i = 0; i < STATS_FIELDS; i++) {
+        __atomic_fetch_add(&d[i], s[i], __ATOMIC_RELAXED);
+    }
+}
+
+
+// Documentation in header file.
+void stats_alloc(size_t bytes) {
+    StatsScope* scope = current_scope;
+    if (!scope) return;
+    scope->counts.alloc_calls++;
+    scope->counts.alloc_bytes += bytes;
+}
+
+
+// Documentation in header file.
+int functools_stats_enable(int on) {
+    __atomic_store_n(&stats_enabled, on ? 1 : 0, __ATOMIC_RELAXED);
+    return 0;
+}
+
+
+// Documentation in header file.
+void functools_stats_snapshot(FunctoolsStats* out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    pthread_mutex_lock(&blocks_lock);
+    add_stats(out, &retired);
+    for (StatsBlock* b = blocks; b; b = b->next) add_stats(out, &b->stats);
+    pthread_mutex_unlock(&blocks_lock);
+}
+
+
+// Documentation in header file.
+void functools_stats_reset(void) {
+    pthread_mutex_lock(&blocks_lock);
+    memset(&retired, 0, sizeof(retired));
+    for (StatsBlock* b = blocks; b; b = b->next) {
+        uint64_t* d = (uint64_t*)b->stats.fn;
+        for (size_t i = 0; i < STATS_FN_COUNT * STATS_FIELDS; i++) {
+            __atomic_store_n(&d[i], 0, __ATOMIC_RELAXED);
+        }
+    }
+    pthread_mutex_unlock(&blocks_lock);
+}
+
+#else
+
+// Documentation in header file.
+int functools_stats_enable(int on) {
+    (void)on;
+    return -1;
+}
+
+
+// Documentation in header file.
+void functools_stats_snapshot(FunctoolsStats* out) {
+    if (out) memset(out, 0, sizeof(*out));
+}
+
+
+// Documentation in header file.
+void functools_stats_reset(void) {
+}
+
+#endif // FUNCTOOLS_STATS
+
+
+#ifdef TEST
+static int is_small(const void* elem, size_t _) {
+    return *(const int*)elem < 30;
+}
+
+static void add_into(void* acc, const void* elem, size_t _) {
+    *(long*)acc += *(const int*)elem;
+}
+
+static int is_small_slowly(const void* elem, size_t _) {
+    volatile long spin = 0;
+    for (int i = 0; i < 10000; i++) spin += i;
+    return *(const int*)elem < 30;
+}
+
+static void* run_calls(void* _) {
+    int data[100];
+    for (int i = 0; i < 100; i++) data[i] = i;
+    ObjList out = filter_data(&is_small, data, sizeof(int), 100);
+    free_list(out, 0);
+    return NULL;
+}
+
+void test_stats_counts() {
+    FunctoolsStats st;
+    assert(functools_stats_enable(1) == 0);
+    functools_stats_reset();
+    run_calls(NULL);
+    functools_stats_snapshot(&st);
+    FunctoolsFnStats* f = &st.fn[STATS_FILTER_DATA];
+    assert(f->calls == 1 && f->elements == 100 && f->survivors == 30);
+    // The list array and one copy per element kept.
+    assert(f->alloc_calls >= 31);
+    assert(f->alloc_bytes >= 30 * sizeof(int) + 31 * sizeof(void*));
+    assert(f->callback_ns <= f->wall_ns);
+    assert(f->callback_cpu_ns <= f->cpu_ns);
+    assert(st.fn[STATS_FREE_LIST].calls == 1);
+    assert(st.fn[STATS_FREE_LIST].elements == 30);
+
+    int data[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    long acc = 0;
+    reduce_data_into(&add_into, data, sizeof(int), 10, &acc);
+    assert(str_contains("haystack", 'y'));
+    assert(!str_contains("haystack", 'z'));
+    functools_stats_snapshot(&st);
+    assert(st.fn[STATS_REDUCE_DATA_INTO].elements == 10);
+    assert(st.fn[STATS_STR_CONTAINS].calls == 2);
+    assert(st.fn[STATS_STR_CONTAINS].elements == 3 + 8);
+
+    functools_stats_reset();
+    functools_stats_snapshot(&st);
+    assert(st.fn[STATS_FILTER_DATA].calls == 0);
+
+    // Busy callbacks show up in both callback times.
+    ObjList out = filter_data(&is_small_slowly, data, sizeof(int), 10);
+    free_list(out, 0);
+    functools_stats_snapshot(&st);
+    f = &st.fn[STATS_FILTER_DATA];
+    assert(f->callback_ns > 0 && f->callback_cpu_ns > 0);
+    assert(f->callback_cpu_ns <= f->cpu_ns);
+
+    // Nothing is recorded while disabled.
+    functools_stats_reset();
+    functools_stats_enable(0);
+    run_calls(NULL);
+    functools_stats_snapshot(&st);
+    assert(st.fn[STATS_FILTER_DATA].calls == 0);
+    assert(strcmp(functools_stats_name(STATS_STR_SET), "str_set") == 0);
+    assert(functools_stats_name(STATS_FN_COUNT) == NULL);
+}
+
+void test_stats_threads() {
+    FunctoolsStats st;
+    functools_stats_enable(1);
+    functools_stats_reset();
+    pthread_t threads[4];
+    for (int i = 0; i < 4; i++) {
+        pthread_create(&threads[i], NULL, &run_calls, NULL);
+    }
+    for (int i = 0; i < 4; i++) pthread_join(threads[i], NULL);
+    run_calls(NULL);
+    // The counts of the exited threads are kept.
+    functools_stats_snapshot(&st);
+    assert(st.fn[STATS_FILTER_DATA].calls == 5);
+    assert(st.fn[STATS_FILTER_DATA].survivors == 150);
+    functools_stats_enable(0);
+}
+
+int main() {
+    test_stats_counts();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_stats_counts", "Passed");
+    test_stats_threads();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_stats_threads", "Passed");
+    return 0;
+}
+
+#endif // TEST
@@ -0,0 +1,215 @@
+/**
+ * Call statistics of the library functions. (Header file)
+ *
+ * The instrumentation is compiled in only with -DFUNCTOOLS_STATS (make
+ * STATS=1), and then only records while functools_stats_enable(1) is in
+ * effect. Without the flag the STATS_ macros expand to nothing, so a normal
+ * build pays nothing at all.
+ *
+ * For every instrumented entry point it counts the calls, the elements
+ * processed, the elements that passed a filter, the bytes and calls of the
+ * allocations made by the library itself, and the wall clock and thread
+ * CPU time, in total and in user callbacks.
+ * Counters are kept per thread and added up when read.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _FUNCTOOLS_STATS_H_
+#define _FUNCTOOLS_STATS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The instrumented entry points. The plain functions are counted under
+ * their _ex variants, which they call.
+ */
+typedef enum {
+    STATS_FILTER_DATA,
+    STATS_MAP_DATA,
+    STATS_REDUCE_DATA,
+    STATS_FILTER,
+    STATS_MAP,
+    STATS_REDUCE,
+    STATS_FREE_LIST,
+    STATS_FILTER_DATA_PACKED,
+    STATS_MAP_DATA_PACKED,
+    STATS_REDUCE_DATA_INTO,
+    STATS_REDUCE_INTO,
+    STATS_STR_SPLIT,
+    STATS_STR_SPLIT_VIEWS,
+    STATS_STR_JOIN,
+    STATS_STR_JOIN_VIEWS,
+    STATS_STR_SET,
+    STATS_STR_CONTAINS,
+    STATS_FN_COUNT
+} StatsFn;
+
+/**
+ * The counters of one entry point.
+ *
+ * @param calls The number of calls.
+ * @param elements The number of elements, items or bytes processed.
+ * @param survivors The number of elements kept by filters.
+ * @param alloc_bytes The number of bytes the library allocated. A resize
+ * counts its growth.
+ * @param alloc_calls The number of allocations and resizes.
+ * @param wall_ns The wall clock time spent in the calls.
+ * @param cpu_ns The CPU time of the calling threads spent in the calls.
+ * @param callback_ns The part of wall_ns spent in user callbacks. The rest
+ * is library overhead.
+ * @param callback_cpu_ns The part of cpu_ns spent in user callbacks.
+ */
+typedef struct {
+    uint64_t calls;
+    uint64_t elements;
+    uint64_t survivors;
+    uint64_t alloc_bytes;
+    uint64_t alloc_calls;
+    uint64_t wall_ns;
+    uint64_t cpu_ns;
+    uint64_t callback_ns;
+    uint64_t callback_cpu_ns;
+} FunctoolsFnStats;
+
+/**
+ * The counters of all entry points.
+ */
+typedef struct {
+    FunctoolsFnStats fn[STATS_FN_COUNT];
+} FunctoolsStats;
+
+
+/**
+ * Start or stop recording.
+ *
+ * @param on 1 to record, 0 to stop.
+ * @return 0 on success, -1 if the library was built without
+ * FUNCTOOLS_STATS.
+ */
+int functools_stats_enable(int on);
+
+/**
+ * Return the counters of all threads, including threads that have exited.
+ * Calls running while the snapshot is taken may be partly included.
+ *
+ * @param out Receives the counters. All zero without FUNCTOOLS_STATS.
+ */
+void functools_stats_snapshot(FunctoolsStats* out);
+
+/**
+ * Reset the counters of all threads to zero. Calls running while the
+ * counters are reset may be partly kept.
+ */
+void functools_stats_reset(void);
+
+/**
+ * Return the name of an entry point.
+ *
+ * @param fn The entry point.
+ * @return The name of its function, or NULL if fn is out of range.
+ */
+const char* functools_stats_name(StatsFn fn);
+
+
+#ifdef FUNCTOOLS_STATS
+
+/**
+ * The state of an instrumented call. -- private
+ */
+typedef struct StatsScope {
+    struct StatsScope* outer;
+    int fn;
+    int active;
+    uint64_t wall_start;
+    uint64_t cpu_start;
+    FunctoolsFnStats counts;
+} StatsScope;
+
+/**
+ * Start an instrumented call. -- private
+ */
+void stats_begin(StatsScope* scope, StatsFn fn);
+
+/**
+ * Finish an instrumented call and add its counts to the thread's counters.
+ * -- private
+ */
+void stats_end(StatsScope* scope);
+
+/**
+ * Count an allocation for the innermost instrumented call. -- private
+ */
+void stats_alloc(size_t bytes);
+
+/**
+ * Read the monotonic clock, in nanoseconds. -- private
+ */
+uint64_t stats_clock(void);
+
+/**
+ * Read the CPU time of the calling thread, in nanoseconds. -- private
+ */
+uint64_t stats_cpu_clock(void);
+
+/**
+ * Instrument the rest of the enclosing block as a call of fn. The call is
+ * recorded when the block is left, by any path.
+ */
+#define STATS_BEGIN(fn) \
+    StatsScope stats_scope_ __attribute__((cleanup(stats_end))); \
+    stats_begin(&stats_scope_, (fn))
+
+/**
+ * Add to the elements processed by the current call. n is only evaluated
+ * while recording.
+ */
+#define STATS_ELEMENTS(n) ((void)(stats_scope_.active \
+    && (stats_scope_.counts.elements += (uint64_t)(n))))
+
+/**
+ * Add to the elements kept by the current call. n is only evaluated while
+ * recording.
+ */
+#define STATS_SURVIVORS(n) ((void)(stats_scope_.active \
+    && (stats_scope_.counts.survivors += (uint64_t)(n))))
+
+/**
+ * Run a statement that calls a user callback, timing it in wall clock and
+ * CPU time.
+ */
+#define STATS_CALLBACK(stmt) do { \
+        if (stats_scope_.active) { \
+            uint64_t stats_c0_ = stats_cpu_clock(); \
+            uint64_t stats_t0_ = stats_clock(); \
+            stmt; \
+            stats_scope_.counts.callback_ns += stats_clock() - stats_t0_; \
+            stats_scope_.counts.callback_cpu_ns += stats_cpu_clock() \
+                - stats_c0_; \
+        } else { \
+            stmt; \
+        } \
+    } while (0)
+
+/**
+ * Record an allocation of the given size for the current call.
+ */
+#define STATS_ALLOC(bytes) stats_alloc(bytes)
+
+#else
+
+#define STATS_BEGIN(fn) ((void)0)
+#define STATS_ELEMENTS(n) ((void)0)
+#define STATS_SURVIVORS(n) ((void)0)
+#define STATS_CALLBACK(stmt) do { stmt; } while (0)
+#define STATS_ALLOC(bytes) ((void)0)
+
+#endif // FUNCTOOLS_STATS
+
+
+#endif // _FUNCTOOLS_STATS_H_
@@ -0,0 +1,139 @@
+/**
+ * Type-specialized filter, map and reduce. (Header only)
+ *
+ * The generic functions in functools.h take the element length at run time
+ * and call the callbacks through function pointers, which stops the compiler
+ * from inlining the callbacks or vectorizing the loops. The macros below
+ * generate static inline versions of filter, map and reduce for one element
+ * type, so that both the type and the callback are known where the loop is
+ * compiled.
+ *
+ * FUNCTOOLS_DEFINE(T, SFX) defines filter_SFX, map_SFX and reduce_SFX, which
+ * take the callback as a function pointer. They are always inlined, so a
+ * call with a named function lets the compiler inline the callback too:
+ *
+ *     FUNCTOOLS_DEFINE(int32_t, i32)
+ *
+ *     static int is_even(int32_t x, size_t _) { return x % 2 == 0; }
+ *
+ *     size_t n = filter_i32(&is_even, input, count, out);
+ *
+ * FUNCTOOLS_DEFINE_FILTER, FUNCTOOLS_DEFINE_MAP and FUNCTOOLS_DEFINE_REDUCE
+ * bind the callback into the generated function itself, and also allow the
+ * output or accumulator type to differ from the element type.
+ *
+ * None of the generated functions allocate memory: the output goes to a
+ * buffer provided by the caller.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _FUNCTOOLS_TYPED_H_
+#define _FUNCTOOLS_TYPED_H_
+
+#include <stddef.h>
+
+#if defined(__GNUC__)
+#define FUNCTOOLS_INLINE static inline __attribute__((always_inline, unused))
+#else
+#define FUNCTOOLS_INLINE static inline
+#endif
+
+
+/**
+ * Define filter_SFX, map_SFX and reduce_SFX for elements of type T.
+ *
+ * size_t filter_SFX(int (*fn)(T elem, size_t index), const T* input,
+ *     size_t count, T* out);
+ *   Copies the elements for which fn returns non-zero to out, which must
+ *   hold count elements, and returns the number copied.
+ *
+ * void map_SFX(T (*fn)(T elem, size_t index), const T* input, size_t count,
+ *     T* out);
+ *   Stores fn of each element to out, which must hold count elements.
+ *
+ * T reduce_SFX(T (*fn)(T acc, T elem, size_t index), const T* input,
+ *     size_t count, T init);
+ *   Folds the elements into init and returns the result.
+ */
+#define FUNCTOOLS_DEFINE(T, SFX) \
+FUNCTOOLS_INLINE size_t filter_##SFX(int (*fn)(T, size_t), \
+    const T* input, size_t count, T* out) { \
+    size_t k = 0; \
+    for (size_t i = 0; i < count; i++) { \
+        if (fn(input[i], i)) out[k++] = input[i]; \
+    } \
+    return k; \
+} \
+ \
+FUNCTOOLS_INLINE void map_##SFX(T (*fn)(T, size_t), \
+    const T* input, size_t count, T* out) { \
+    for (size_t i = 0; i < count; i++) out[i] = fn(input[i], i); \
+} \
+ \
+FUNCTOOLS_INLINE T reduce_##SFX(T (*fn)(T, T, size_t), \
+    const T* input, size_t count, T init) { \
+    for (size_t i = 0; i < count; i++) init = fn(init, input[i], i); \
+    return init; \
+}
+
+
+/**
+ * Define a filter over elements of type T with a fixed predicate.
+ *
+ * size_t NAME(const T* input, size_t count, T* out);
+ *
+ * @param NAME The name of the generated function.
+ * @param T The element type.
+ * @param PRED A function or macro int PRED(T elem, size_t index).
+ */
+#define FUNCTOOLS_DEFINE_FILTER(NAME, T, PRED) \
+FUNCTOOLS_INLINE size_t NAME(const T* input, size_t count, T* out) { \
+    size_t k = 0; \
+    for (size_t i = 0; i < count; i++) { \
+        if (PRED(input[i], i)) out[k++] = input[i]; \
+    } \
+    return k; \
+}
+
+
+/**
+ * Define a map from elements of type TIN to elements of type TOUT with a
+ * fixed function.
+ *
+ * void NAME(const TIN* input, size_t count, TOUT* out);
+ *
+ * @param NAME The name of the generated function.
+ * @param TIN The input element type.
+ * @param TOUT The output element type.
+ * @param FN A function or macro TOUT FN(TIN elem, size_t index).
+ */
+#define FUNCTOOLS_DEFINE_MAP(NAME, TIN, TOUT, FN) \
+FUNCTOOLS_INLINE void NAME(const TIN* input, size_t count, TOUT* out) { \
+    for (size_t i = 0; i < count; i++) out[i] = FN(input[i], i); \
+}
+
+
+/**
+ * Define a reduction of elements of type T into an accumulator of type A
+ * with a fixed function.
+ *
+ * A NAME(const T* input, size_t count, A init);
+ *
+ * @param NAME The name of the generated function.
+ * @param T The element type.
+ * @param A The accumulator type.
+ * @param FN A function or macro A FN(A acc, T elem, size_t index).
+ */
+#define FUNCTOOLS_DEFINE_REDUCE(NAME, T, A, FN) \
+FUNCTOOLS_INLINE A NAME(const T* input, size_t count, A init) { \
+    for (size_t i = 0; i < count; i++) init = FN(init, input[i], i); \
+    return init; \
+}
+
+
+#endif // _FUNCTOOLS_TYPED_H_
@@ -0,0 +1,619 @@
+/**
+ * Grouping and aggregating arrays of elements.
+ *
+ * The groups of a table are stored in insertion order in parallel arrays
+ * (keys, accumulators, hashes), and a HashIndex maps keys to group
+ * numbers. Elements are processed in batches: the keys and hashes of a
+ * batch are computed first and the control bytes of their groups are
+ * prefetched, so that the table lookups of the batch overlap their cache
+ * misses instead of waiting for them one by one.
+ *
+ * The parallel version aggregates one part of the array per thread into a
+ * table of its own, then splits the groups of every table into partitions
+ * by hash. Each partition is merged by one thread into a table of its own,
+ * visiting the parts in input order, so no two threads ever touch the same
+ * key. The partitions are finally put back in order of first appearance.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include "group_data.h"
+#include "hash_index.h"
+#include "selection.h"
+#include "sort_data.h"
+#ifdef TEST
+#include <assert.h>
+#include <stdio.h>
+#endif
+
+// The number of elements whose keys are computed ahead of their lookups.
+#define GROUP_BATCH 32
+
+#define GROUP_DEFAULT_GRAIN 4096
+
+
+/**
+ * The groups found so far. -- private
+ *
+ * @param index Maps keys to group numbers.
+ * @param keys The key of every group.
+ * @param accs The accumulator of every group.
+ * @param hashes The hash of every key.
+ * @param first The index of the first element of every group, or NULL when
+ * it is not tracked.
+ * @param count The number of groups.
+ * @param cap The capacity of the arrays, in groups.
+ * @param probe The key being looked up.
+ */
+typedef struct {
+    HashIndex index;
+    unsigned char* keys;
+    unsigned char* accs;
+    uint64_t* hashes;
+    size_t* first;
+    size_t count;
+    size_t cap;
+    size_t key_len;
+    size_t acc_len;
+    const unsigned char* probe;
+} GroupTable;
+
+
+/**
+ * Compare the key looked up with the key of a group. -- private
+ */
+static int group_eq(void* ctx, size_t id) {
+    const GroupTable* t = ctx;
+    return memcmp(t->keys + id * t->key_len, t->probe, t->key_len) == 0;
+}
+
+
+/**
+ * Return the hash of the key of a group. -- private
+ */
+static uint64_t group_hash(void* ctx, size_t id) {
+    return ((const GroupTable*)ctx)->hashes[id];
+}
+
+
+/**
+ * Initialize a table sized for a number of groups. -- private
+ */
+static int table_init(GroupTable* t, size_t key_len, size_t acc_len,
+    size_t expected, int track_first) {
+    memset(t, 0, sizeof(*t));
+    t->key_len = key_len;
+    t->acc_len = acc_len;
+    t->cap = expected < 16 ? 16 : expected;
+    t->keys = malloc(t->cap * key_len);
+    t->accs = malloc(t->cap * acc_len);
+    t->hashes = malloc(t->cap * sizeof(uint64_t));
+    t->first = track_first ? malloc(t->cap * sizeof(size_t)) : NULL;
+    if (!t->keys || !t->accs || !t->hashes || (track_first && !t->first)
+        || hash_index_init(&t->index, t->cap) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+
+/**
+ * Free a table. -- private
+ */
+static void table_free(GroupTable* t) {
+    hash_index_free(&t->index);
+    free(t->keys);
+    free(t->accs);
+    free(t->hashes);
+    free(t->first);
+    memset(t, 0, sizeof(*t));
+}
+
+
+/**
+ * Grow the arrays of a table. -- private
+ */
+static int table_grow(GroupTable* t) {
+    size_t cap = t->cap * 2;
+    unsigned char* keys = realloc(t->keys, cap * t->key_len);
+    if (!keys) return -1;
+    t->keys = keys;
+    unsigned char* accs = realloc(t->accs, cap * t->acc_len);
+    if (!accs) return -1;
+    t->accs = accs;
+    uint64_t* hashes = realloc(t->hashes, cap * sizeof(uint64_t));
+    if (!hashes) return -1;
+    t->hashes = hashes;
+    if (t->first) {
+        size_t* first = realloc(t->first, cap * sizeof(size_t));
+        if (!first) return -1;
+        t->first = first;
+    }
+    t->cap = cap;
+    return 0;
+}
+
+
+/**
+ * Find the group of a key, adding it with the given accumulator if it is
+ * new. *added tells which. Returns the group number, or HASH_INDEX_NONE on
+ * allocation failure. -- private
+ */
+static size_t table_add(GroupTable* t, const unsigned char* key, uint64_t hash,
+    const void* acc, size_t first, int* added) {
+    *added = 0;
+    if (t->count == t->cap && table_grow(t) != 0) return HASH_INDEX_NONE;
+    t->probe = key;
+    size_t id = hash_index_insert(&t->index, hash, t->count, &group_eq,
+        &group_hash, t);
+    if (id != t->count) return id;
+    *added = 1;
+    memcpy(t->keys + id * t->key_len, key, t->key_len);
+    memcpy(t->accs + id * t->acc_len, acc, t->acc_len);
+    t->hashes[id] = hash;
+    if (t->first) t->first[id] = first;
+    t->count++;
+    return id;
+}
+
+
+/**
+ * Aggregate the elements lo to hi - 1 of an array into a table. -- private
+ */
+static int aggregate_range(GroupTable* t, MapIntoDataFn key,
+    ReduceIntoDataFn agg, const void* init, const unsigned char* input,
+    size_t el_len, size_t lo, size_t hi) {
+    unsigned char* batch = malloc(GROUP_BATCH * t->key_len);
+    if (!batch) return -1;
+    uint64_t hashes[GROUP_BATCH];
+    for (size_t b = lo; b < hi; b += GROUP_BATCH) {
+        size_t n = hi - b < GROUP_BATCH ? hi - b : GROUP_BATCH;
+        for (size_t j = 0; j < n; j++) {
+            unsigned char* k = batch + j * t->key_len;
+            key(k, input + (b + j) * el_len, b + j);
+            hashes[j] = hash_bytes(k, t->key_len, 0);
+            __builtin_prefetch(t->index.ctrl
+                + hash_index_group(&t->index, hashes[j]) * HASH_INDEX_GROUP);
+        }
+        for (size_t j = 0; j < n; j++) {
+            int added;
+            size_t id = table_add(t, batch + j * t->key_len, hashes[j], init,
+                b + j, &added);
+            if (id == HASH_INDEX_NONE) {
+                free(batch);
+                return -1;
+            }
+            agg(t->accs + id * t->acc_len, input + (b + j) * el_len, b + j);
+        }
+    }
+    free(batch);
+    return 0;
+}
+
+
+/**
+ * Hand the arrays of a table over to a GroupedData. -- private
+ */
+static GroupedData table_release(GroupTable* t) {
+    GroupedData out = {
+        .keys = { .data = t->keys, .count = t->count, .el_len = t->key_len,
+            .capacity = t->cap, .allocator = NULL },
+        .accs = { .data = t->accs, .count = t->count, .el_len = t->acc_len,
+            .capacity = t->cap, .allocator = NULL }
+    };
+    t->keys = NULL;
+    t->accs = NULL;
+    table_free(t);
+    return out;
+}
+
+
+// Documentation in header file.
+GroupedData group_by_data(MapIntoDataFn key, size_t key_len,
+    ReduceIntoDataFn agg, const void* init, size_t acc_len, const void* input,
+    size_t el_len, size_t el_count, size_t cardinality_hint) {
+    GroupedData out = { { 0 }, { 0 } };
+    if (key == NULL || agg == NULL || init == NULL || input == NULL
+        || key_len == 0 || acc_len == 0 || el_len == 0 || el_count == 0) {
+        return out;
+    }
+    GroupTable t;
+    if (table_init(&t, key_len, acc_len, cardinality_hint, 0) != 0
+        || aggregate_range(&t, key, agg, init, input, el_len, 0, el_count) != 0) {
+        table_free(&t);
+        return out;
+    }
+    return table_release(&t);
+}
+
+
+/**
+ * The state of a parallel grouping. -- private
+ *
+ * @param parts The table of every part of the input.
+ * @param part_order The groups of every part, sorted by partition.
+ * @param part_bounds The start of every partition in part_order, per part.
+ * @param merged The table of every partition.
+ */
+typedef struct {
+    MapIntoDataFn key;
+    ReduceIntoDataFn agg;
+    MergeIntoFn merge;
+    const void* init;
+    const unsigned char* input;
+    size_t el_len;
+    size_t el_count;
+    size_t key_len;
+    size_t acc_len;
+    size_t hint;
+    size_t n_parts;
+    size_t n_partitions;
+    GroupTable* parts;
+    size_t** part_order;
+    size_t** part_bounds;
+    GroupTable* merged;
+    int failed;
+} GroupJob;
+
+
+/**
+ * Aggregate one part of the input, then sort its groups by partition.
+ * -- private
+ */
+static void aggregate_part_task(void* arg, size_t task) {
+    GroupJob* job = arg;
+    GroupTable* t = &job->parts[task];
+    size_t lo = job->el_count * task / job->n_parts;
+    size_t hi = job->el_count * (task + 1) / job->n_parts;
+    size_t p = job->n_partitions;
+    if (table_init(t, job->key_len, job->acc_len, job->hint, 1) != 0
+        || aggregate_range(t, job->key, job->agg, job->init, job->input,
+            job->el_len, lo, hi) != 0) {
+        __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    size_t* order = malloc((t->count + 1) * sizeof(size_t));
+    size_t* bounds = calloc(p + 1, sizeof(size_t));
+    job->part_order[task] = order;
+    job->part_bounds[task] = bounds;
+    if (!order || !bounds) {
+        __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    for (size_t g = 0; g < t->count; g++) {
+        bounds[hash_index_partition(t->hashes[g], p) + 1]++;
+    }
+    for (size_t k = 0; k < p; k++) bounds[k + 1] += bounds[k];
+    size_t* next = malloc(p * sizeof(size_t));
+    if (!next) {
+        __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    memcpy(next, bounds, p * sizeof(size_t));
+    for (size_t g = 0; g < t->count; g++) {
+        order[next[hash_index_partition(t->hashes[g], p)]++] = g;
+    }
+    free(next);
+}
+
+
+/**
+ * Merge one partition of the groups of all parts. -- private
+ */
+static void merge_partition_task(void* arg, size_t task) {
+    GroupJob* job = arg;
+    GroupTable* m = &job->merged[task];
+    size_t expected = 0;
+    for (size_t k = 0; k < job->n_parts; k++) {
+        size_t n = job->part_bounds[k][task + 1] - job->part_bounds[k][task];
+        expected = n > expected ? n : expected;
+    }
+    if (table_init(m, job->key_len, job->acc_len, expected, 1) != 0) {
+        __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    for (size_t k = 0; k < job->n_parts; k++) {
+        const GroupTable* t = &job->parts[k];
+        for (size_t o = job->part_bounds[k][task];
+            o < job->part_bounds[k][task + 1]; o++) {
+            size_t g = job->part_order[k][o];
+            const unsigned char* acc = t->accs + g * t->acc_len;
+            int added;
+            size_t id = table_add(m, t->keys + g * t->key_len, t->hashes[g],
+                acc, t->first[g], &added);
+            if (id == HASH_INDEX_NONE) {
+                __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+                return;
+            }
+            if (!added) job->merge(m->accs + id * m->acc_len, acc);
+        }
+    }
+}
+
+
+/**
+ * Return the first appearance of a group as its sort key. -- private
+ */
+static uint64_t first_key(const void* elem) {
+    return sort_key_u64(*(const size_t*)elem);
+}
+
+
+/**
+ * Put the groups of all partitions in order of first appearance.
+ * -- private
+ */
+static GroupedData collect_partitions(GroupJob* job) {
+    GroupedData out = { { 0 }, { 0 } };
+    size_t total = 0;
+    for (size_t p = 0; p < job->n_partitions; p++) total += job->merged[p].count;
+    size_t* first = malloc(total * sizeof(size_t));
+    unsigned char* keys = malloc(total * job->key_len);
+    unsigned char* accs = malloc(total * job->acc_len);
+    size_t* order = NULL;
+    if (first && keys && accs) {
+        size_t off = 0;
+        for (size_t p = 0; p < job->n_partitions; p++) {
+            const GroupTable* m = &job->merged[p];
+            memcpy(first + off, m->first, m->count * sizeof(size_t));
+            memcpy(keys + off * job->key_len, m->keys, m->count * job->key_len);
+            memcpy(accs + off * job->acc_len, m->accs, m->count * job->acc_len);
+            off += m->count;
+        }
+        order = sort_data_key_index(&first_key, first, sizeof(size_t), total);
+    }
+    if (order) {
+        out.keys = gather_data(keys, job->key_len, order, total);
+        out.accs = gather_data(accs, job->acc_len, order, total);
+        if (!out.keys.data || !out.accs.data) free_grouped(&out);
+    }
+    free(first);
+    free(keys);
+    free(accs);
+    free(order);
+    return out;
+}
+
+
+// Documentation in header file.
+GroupedData group_by_data_par(MapIntoDataFn key, size_t key_len,
+    ReduceIntoDataFn agg, MergeIntoFn merge, const void* init, size_t acc_len,
+    const void* input, size_t el_len, size_t el_count,
+    size_t cardinality_hint, const ParallelOpts* opts) {
+    GroupedData out = { { 0 }, { 0 } };
+    if (merge == NULL) return out;
+    WorkerPool* pool = opts && opts->pool ? opts->pool : worker_pool_default();
+    size_t grain = opts && opts->grain ? opts->grain : GROUP_DEFAULT_GRAIN;
+    size_t threads = pool ? worker_pool_size(pool) : 1;
+    size_t n_parts = el_count / grain < threads ? el_count / grain : threads;
+    if (n_parts < 2 || key == NULL || agg == NULL || init == NULL
+        || input == NULL || key_len == 0 || acc_len == 0 || el_len == 0) {
+        return group_by_data(key, key_len, agg, init, acc_len, input, el_len,
+            el_count, cardinality_hint);
+    }
+    GroupJob job = { .key = key, .agg = agg, .merge = merge, .init = init,
+        .input = input, .el_len = el_len, .el_count = el_count,
+        .key_len = key_len, .acc_len = acc_len, .hint = cardinality_hint,
+        .n_parts = n_parts, .n_partitions = threads };
+    job.parts = calloc(n_parts, sizeof(GroupTable));
+    job.part_order = calloc(n_parts, sizeof(size_t*));
+    job.part_bounds = calloc(n_parts, sizeof(size_t*));
+    job.merged = calloc(threads, sizeof(GroupTable));
+    if (job.parts && job.part_order && job.part_bounds && job.merged) {
+        worker_pool_run(pool, aggregate_part_task, &job, n_parts);
+        if (!job.failed) {
+            worker_pool_run(pool, merge_partition_task, &job, threads);
+        }
+        if (!job.failed) out = collect_partitions(&job);
+    }
+    for (size_t k = 0; job.parts && k < n_parts; k++) {
+        table_free(&job.parts[k]);
+        free(job.part_order[k]);
+        free(job.part_bounds[k]);
+    }
+    for (size_t p = 0; job.merged && p < threads; p++) {
+        table_free(&job.merged[p]);
+    }
+    free(job.parts);
+    free(job.part_order);
+    free(job.part_bounds);
+    free(job.merged);
+    return out;
+}
+
+
+// Documentation in header file.
+void free_grouped(GroupedData* groups) {
+    if (groups == NULL) return;
+    free_packed(&groups->keys);
+    free_packed(&groups->accs);
+}
+
+
+#ifdef TEST
+/**
+ * A sale, grouped by store.
+ */
+typedef struct {
+    int store;
+    int amount;
+} Sale;
+
+/**
+ * The totals of a store.
+ */
+typedef struct {
+    long total;
+    long count;
+} Totals;
+
+void sale_store(void* key, const void* elem, size_t _) {
+    *(int*)key = ((const Sale*)elem)->store;
+}
+
+void add_sale(void* acc, const void* elem, size_t _) {
+    Totals* t = acc;
+    t->total += ((const Sale*)elem)->amount;
+    t->count++;
+}
+
+void merge_totals(void* acc, const void* other) {
+    Totals* t = acc;
+    const Totals* o = other;
+    t->total += o->total;
+    t->count += o->count;
+}
+
+/**
+ * Keep the index of the last element of the group.
+ */
+void keep_last(void* acc, const void* _, size_t index) {
+    *(size_t*)acc = index;
+}
+
+void merge_last(void* acc, const void* other) {
+    *(size_t*)acc = *(const size_t*)other;
+}
+
+Sale* make_sales(size_t n, int stores) {
+    Sale* sales = malloc(n * sizeof(Sale));
+    unsigned int seed = 42;
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1103515245u + 12345u;
+        sales[i].store = (int)((seed >> 8) % (unsigned)stores) * 17;
+        sales[i].amount = (int)(i % 100);
+    }
+    return sales;
+}
+
+/**
+ * Check the groups of make_sales() against a direct count.
+ */
+void check_sales(const GroupedData* g, const Sale* sales, size_t n) {
+    const int* keys = g->keys.data;
+    const Totals* totals = g->accs.data;
+    long sum = 0, count = 0;
+    for (size_t i = 0; i < g->keys.count; i++) {
+        sum += totals[i].total;
+        count += totals[i].count;
+        // The groups are in order of first appearance.
+        size_t first = 0;
+        while (sales[first].store != keys[i]) first++;
+        if (i > 0) {
+            size_t prev = 0;
+            while (sales[prev].store != keys[i - 1]) prev++;
+            assert(prev < first);
+        }
+    }
+    long expected = 0;
+    for (size_t i = 0; i < n; i++) expected += sales[i].amount;
+    assert(sum == expected && count == (long)n);
+}
+
+void test_group_by_data() {
+    Sale sales[] = { { 3, 10 }, { 1, 5 }, { 3, 7 }, { 2, 1 }, { 1, 1 } };
+    Totals zero = { 0, 0 };
+    GroupedData g = group_by_data(&sale_store, sizeof(int), &add_sale, &zero,
+        sizeof(Totals), sales, sizeof(Sale), 5, 0);
+    assert(g.keys.count == 3 && g.accs.count == 3);
+    const int* keys = g.keys.data;
+    const Totals* totals = g.accs.data;
+    assert(keys[0] == 3 && totals[0].total == 17 && totals[0].count == 2);
+    assert(keys[1] == 1 && totals[1].total == 6 && totals[1].count == 2);
+    assert(keys[2] == 2 && totals[2].total == 1 && totals[2].count == 1);
+    free_grouped(&g);
+    assert(g.keys.data == NULL && g.accs.count == 0);
+
+    // Many groups, with and without a hint.
+    size_t n = 50000;
+    Sale* many = make_sales(n, 3000);
+    g = group_by_data(&sale_store, sizeof(int), &add_sale, &zero,
+        sizeof(Totals), many, sizeof(Sale), n, 0);
+    assert(g.keys.count == 3000);
+    check_sales(&g, many, n);
+    GroupedData h = group_by_data(&sale_store, sizeof(int), &add_sale, &zero,
+        sizeof(Totals), many, sizeof(Sale), n, 3000);
+    assert(memcmp(g.keys.data, h.keys.data, 3000 * sizeof(int)) == 0);
+    assert(memcmp(g.accs.data, h.accs.data, 3000 * sizeof(Totals)) == 0);
+    free_grouped(&g);
+    free_grouped(&h);
+    free(many);
+
+    g = group_by_data(&sale_store, sizeof(int), &add_sale, &zero,
+        sizeof(Totals), NULL, sizeof(Sale), 5, 0);
+    assert(g.keys.data == NULL && g.keys.count == 0);
+}
+
+void test_group_by_data_par() {
+    WorkerPool* pool = worker_pool_create(4);
+    ParallelOpts opts = { .pool = pool, .grain = 100 };
+    Totals zero = { 0, 0 };
+    int cards[] = { 1, 7, 5000 };
+    for (int c = 0; c < 3; c++) {
+        size_t n = 40000;
+        Sale* sales = make_sales(n, cards[c]);
+        GroupedData ser = group_by_data(&sale_store, sizeof(int), &add_sale,
+            &zero, sizeof(Totals), sales, sizeof(Sale), n, 0);
+        GroupedData par = group_by_data_par(&sale_store, sizeof(int), &add_sale,
+            &merge_totals, &zero, sizeof(Totals), sales, sizeof(Sale), n, 0,
+            &opts);
+        assert(par.keys.count == ser.keys.count);
+        assert(memcmp(par.keys.data, ser.keys.data,
+            ser.keys.count * sizeof(int)) == 0);
+        assert(memcmp(par.accs.data, ser.accs.data,
+            ser.accs.count * sizeof(Totals)) == 0);
+        check_sales(&par, sales, n);
+        free_grouped(&ser);
+        free_grouped(&par);
+        free(sales);
+    }
+
+    // The accumulators of the parts are merged in input order.
+    size_t n = 10000;
+    Sale* sales = make_sales(n, 3);
+    size_t none = 0;
+    GroupedData ser = group_by_data(&sale_store, sizeof(int), &keep_last,
+        &none, sizeof(size_t), sales, sizeof(Sale), n, 0);
+    GroupedData par = group_by_data_par(&sale_store, sizeof(int), &keep_last,
+        &merge_last, &none, sizeof(size_t), sales, sizeof(Sale), n, 0, &opts);
+    assert(memcmp(par.accs.data, ser.accs.data, 3 * sizeof(size_t)) == 0);
+    free_grouped(&ser);
+    free_grouped(&par);
+    free(sales);
+
+    // An init that is not the identity of merge is counted once per part
+    // holding the key: here each of the one part per thread holds the only
+    // key, against once in the serial version.
+    n = 40000;
+    sales = make_sales(n, 1);
+    Totals hundred = { 100, 0 };
+    ser = group_by_data(&sale_store, sizeof(int), &add_sale, &hundred,
+        sizeof(Totals), sales, sizeof(Sale), n, 0);
+    par = group_by_data_par(&sale_store, sizeof(int), &add_sale,
+        &merge_totals, &hundred, sizeof(Totals), sales, sizeof(Sale), n, 0,
+        &opts);
+    long ser_total = ((Totals*)ser.accs.data)->total;
+    long parts = (long)worker_pool_size(pool);
+    assert(((Totals*)par.accs.data)->total == ser_total + 100 * (parts - 1));
+    assert(((Totals*)par.accs.data)->count == (long)n);
+    free_grouped(&ser);
+    free_grouped(&par);
+    free(sales);
+    worker_pool_destroy(pool);
+}
+
+int main() {
+    test_group_by_data();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_group_by_data", "Passed");
+    test_group_by_data_par();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_group_by_data_par", "Passed");
+    return 0;
+}
+
+#endif // TEST
@@ -0,0 +1,102 @@
+/**
+ * Grouping and aggregating arrays of elements. (Header file)
+ *
+ * group_by_data() replaces a filter, a bucketing loop and a reduce per
+ * bucket with one pass over the array: a key function extracts a fixed
+ * size key from every element, and an aggregation function folds the
+ * element into the accumulator of its key's group, in place. The groups
+ * live in a hash table (see hash_index.h) and are returned as two packed
+ * lists, the keys and the accumulators, in the order in which each key was
+ * first seen.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _GROUP_DATA_H_
+#define _GROUP_DATA_H_
+
+#include <stdlib.h>
+#include "functools.h"
+#include "parallel.h"
+
+/**
+ * Function type for merging two accumulators of the same group.
+ *
+ * @param acc The accumulator of the earlier elements, updated in place.
+ * @param other The accumulator of the later elements.
+ */
+typedef void (*MergeIntoFn)(void* acc, const void* other);
+
+/**
+ * The groups of an array.
+ *
+ * @param keys The key of every group, key_len bytes each.
+ * @param accs The accumulator of every group, acc_len bytes each, in the
+ * order of keys.
+ */
+typedef struct {
+    PackedList keys;
+    PackedList accs;
+} GroupedData;
+
+
+/**
+ * Group an array of elements by key and aggregate each group.
+ *
+ * @param key The function writing the key_len bytes of the key of an
+ * element. Keys are compared bytewise, so padding must be written too.
+ * @param key_len The length of the keys.
+ * @param agg The function folding an element into its group's accumulator.
+ * @param init The initial value of every accumulator, acc_len bytes.
+ * @param acc_len The length of the accumulators.
+ * @param input The input array.
+ * @param el_len The length of each element.
+ * @param el_count The number of elements.
+ * @param cardinality_hint The expected number of groups, zero if unknown.
+ * The table is sized for it up front and grows past it as needed.
+ * @return The groups, in order of first appearance. Zeroed on invalid
+ * input or allocation failure.
+ *
+ * @note The returned groups must be freed by the caller with free_grouped().
+ */
+GroupedData group_by_data(MapIntoDataFn key, size_t key_len,
+    ReduceIntoDataFn agg, const void* init, size_t acc_len, const void* input,
+    size_t el_len, size_t el_count, size_t cardinality_hint);
+
+/**
+ * Group an array of elements by key and aggregate each group, in parallel.
+ *
+ * Each thread aggregates a part of the array into a table of its own. The
+ * tables are then partitioned by hash and every partition is merged by one
+ * thread, with merge combining the accumulators of a key found in several
+ * parts in input order. The groups come out in the same order as with
+ * group_by_data(). The callbacks run concurrently and must be thread safe.
+ *
+ * Every part starts the accumulator of a group from init, so a key found in
+ * k parts merges init k times. The accumulators equal those of
+ * group_by_data() only when init is an identity of merge, such as zero for
+ * a sum.
+ *
+ * @param merge The function merging two accumulators of the same group.
+ * init must be its identity.
+ * @param opts The parallel options, NULL for the defaults.
+ * @see group_by_data()
+ */
+GroupedData group_by_data_par(MapIntoDataFn key, size_t key_len,
+    ReduceIntoDataFn agg, MergeIntoFn merge, const void* init, size_t acc_len,
+    const void* input, size_t el_len, size_t el_count,
+    size_t cardinality_hint, const ParallelOpts* opts);
+
+/**
+ * Free the groups returned by group_by_data(). The groups are left zeroed.
+ *
+ * @param groups The groups.
+ */
+void free_grouped(GroupedData* groups);
+
+
+#endif // _GROUP_DATA_H_
@@ -0,0 +1,315 @@
+/**
+ * An open-addressing hash index for the hash-based functions.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <stdlib.h>
+#include "hash_index.h"
+#ifdef TEST
+#include <assert.h>
+#include <stdio.h>
+#endif
+
+// The number of entries a group may hold: 7/8 of its slots.
+#define HASH_INDEX_GROUP_LOAD 14
+
+#define HASH_P0 0xa0761d6478bd642fu
+#define HASH_P1 0xe7037ed1a0b428dbu
+#define HASH_P2 0x8ebc6af09c88c6e3u
+
+
+/**
+ * Multiply two words and fold the 128-bit product. -- private
+ */
+static inline uint64_t hash_mix(uint64_t a, uint64_t b) {
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+
+/**
+ * Read a word from an unaligned address. -- private
+ */
+static inline uint64_t read_u64(const unsigned char* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+
+// Documentation in header file.
+uint64_t hash_bytes(const void* data, size_t len, uint64_t seed) {
+    const unsigned char* p = data;
+    uint64_t h = seed ^ HASH_P0;
+    size_t rem = len;
+    for (; rem >= 16; rem -= 16, p += 16) {
+        h = hash_mix(read_u64(p) ^ HASH_P1, read_u64(p + 8) ^ h);
+    }
+    if (rem > 0) {
+        // The padding is told apart by the length mixed in below.
+        unsigned char tail[16] = { 0 };
+        memcpy(tail, p, rem);
+        h = hash_mix(read_u64(tail) ^ HASH_P1, read_u64(tail + 8) ^ h);
+    }
+    return hash_mix(h ^ HASH_P2, (uint64_t)len ^ HASH_P0);
+}
+
+
+// Documentation in header file.
+int hash_index_init(HashIndex* index, size_t expected) {
+    memset(index, 0, sizeof(*index));
+    if (expected == 0) return 0;
+    return hash_index_reserve(index, expected, NULL, NULL);
+}
+
+
+// Documentation in header file.
+void hash_index_free(HashIndex* index) {
+    free(index->ctrl);
+    free(index->slots);
+    memset(index, 0, sizeof(*index));
+}
+
+
+// Documentation in header file.
+void hash_index_clear(HashIndex* index) {
+    if (!index->ctrl) return;
+    size_t groups = index->group_mask + 1;
+    memset(index->ctrl, HASH_INDEX_EMPTY, groups * HASH_INDEX_GROUP);
+    index->count = 0;
+    index->growth_left = groups * HASH_INDEX_GROUP_LOAD;
+}
+
+
+// Documentation in header file.
+int hash_index_reserve(HashIndex* index, size_t n, HashIndexHashFn hash,
+    void* ctx) {
+    if (n < index->count) n = index->count;
+    size_t groups = 1;
+    while (groups * HASH_INDEX_GROUP_LOAD < n) {
+        if (groups > SIZE_MAX / 2 / HASH_INDEX_GROUP / sizeof(size_t)) return -1;
+        groups *= 2;
+    }
+    HashIndex grown = {
+        .ctrl = malloc(groups * HASH_INDEX_GROUP),
+        .slots = malloc(groups * HASH_INDEX_GROUP * sizeof(size_t)),
+        .group_mask = groups - 1,
+        .count = index->count,
+        .growth_left = groups * HASH_INDEX_GROUP_LOAD - index->count
+    };
+    if (!grown.ctrl || !grown.slots) {
+        free(grown.ctrl);
+        free(grown.slots);
+        return -1;
+    }
+    memset(grown.ctrl, HASH_INDEX_EMPTY, groups * HASH_INDEX_GROUP);
+    if (index->ctrl) {
+        size_t slots = (index->group_mask + 1) * HASH_INDEX_GROUP;
+        for (size_t s = 0; s < slots; s++) {
+            if (index->ctrl[s] & 0x80) continue;
+            size_t id = index->slots[s];
+            uint64_t h = hash(ctx, id);
+            size_t slot = hash_index_free_slot(&grown, h);
+            grown.ctrl[slot] = (uint8_t)(h & 0x7f);
+            grown.slots[slot] = id;
+        }
+    }
+    free(index->ctrl);
+    free(index->slots);
+    *index = grown;
+    return 0;
+}
+
+
+// Documentation in header file.
+size_t hash_index_bytes(size_t entries) {
+    size_t groups = 1;
+    while (groups * HASH_INDEX_GROUP_LOAD < entries) groups *= 2;
+    return groups * HASH_INDEX_GROUP * (1 + sizeof(size_t));
+}
+
+
+#ifdef TEST
+/**
+ * Keys stored by the caller of the index, and the key looked up.
+ */
+typedef struct {
+    const uint64_t* keys;
+    uint64_t probe;
+} TestKeys;
+
+static int test_eq(void* ctx, size_t id) {
+    TestKeys* t = ctx;
+    return t->keys[id] == t->probe;
+}
+
+static uint64_t test_hash(void* ctx, size_t id) {
+    TestKeys* t = ctx;
+    return hash_u64(t->keys[id]);
+}
+
+/**
+ * A hash that sends every key to the same group, with the same 7 bits.
+ */
+static uint64_t test_bad_hash(void* ctx, size_t id) {
+    (void)ctx;
+    (void)id;
+    return 5;
+}
+
+static int test_bad_eq(void* ctx, size_t id) {
+    return test_eq(ctx, id);
+}
+
+void test_hash_bytes() {
+    const char a[] = "abcdefghijklmnopqrstuvwxyz";
+    assert(hash_bytes(a, 26, 0) == hash_bytes(a, 26, 0));
+    assert(hash_bytes(a, 26, 0) != hash_bytes(a, 26, 1));
+    assert(hash_bytes(a, 26, 0) != hash_bytes(a, 25, 0));
+    // A zero byte at the end is not confused with the padding.
+    const char z[4] = { 'a', 0, 0, 0 };
+    assert(hash_bytes(z, 1, 0) != hash_bytes(z, 2, 0));
+    assert(hash_bytes(z, 0, 0) != hash_bytes(z, 1, 0));
+    assert(hash_u64(1) != hash_u64(2));
+}
+
+void test_hash_index_partition() {
+    size_t counts[10] = { 0 };
+    for (uint64_t i = 0; i < 10000; i++) {
+        uint64_t h = hash_u64(i);
+        size_t p = hash_index_partition(h, 10);
+        assert(p < 10);
+        counts[p]++;
+        assert(hash_index_partition(h, 1) == 0);
+        // A power of two of partitions takes the top bits.
+        assert(hash_index_partition(h, 16) == (size_t)(h >> 60));
+    }
+    for (size_t p = 0; p < 10; p++) assert(counts[p] > 800 && counts[p] < 1200);
+
+    HashIndex index;
+    size_t sizes[] = { 1, 14, 15, 1000 };
+    for (size_t s = 0; s < 4; s++) {
+        assert(hash_index_init(&index, sizes[s]) == 0);
+        size_t slots = (index.group_mask + 1) * HASH_INDEX_GROUP;
+        assert(hash_index_bytes(sizes[s]) == slots * (1 + sizeof(size_t)));
+        hash_index_free(&index);
+    }
+}
+
+void test_hash_index() {
+    size_t n = 10000;
+    uint64_t* keys = malloc(n * sizeof(uint64_t));
+    for (size_t i = 0; i < n; i++) keys[i] = i * 7919 % 5003;
+    TestKeys t = { .keys = keys };
+    HashIndex index;
+    assert(hash_index_init(&index, 0) == 0);
+    assert(hash_index_find(&index, 1, &test_eq, &t) == HASH_INDEX_NONE);
+    // Keys repeat after 5003 elements; the first id of every key is kept.
+    for (size_t i = 0; i < n; i++) {
+        t.probe = keys[i];
+        size_t id = hash_index_insert(&index, hash_u64(keys[i]), i, &test_eq,
+            &test_hash, &t);
+        assert(id == (i < 5003 ? i : i - 5003));
+    }
+    assert(index.count == 5003);
+    for (size_t i = 0; i < 5003; i++) {
+        t.probe = keys[i];
+        assert(hash_index_find(&index, hash_u64(keys[i]), &test_eq, &t) == i);
+    }
+    t.probe = 5003;
+    assert(hash_index_find(&index, hash_u64(5003), &test_eq, &t)
+        == HASH_INDEX_NONE);
+    size_t groups = index.group_mask + 1;
+    hash_index_clear(&index);
+    assert(index.count == 0 && index.group_mask + 1 == groups);
+    t.probe = keys[0];
+    assert(hash_index_find(&index, hash_u64(keys[0]), &test_eq, &t)
+        == HASH_INDEX_NONE);
+    hash_index_free(&index);
+
+    // A presized index does not grow.
+    assert(hash_index_init(&index, 5003) == 0);
+    groups = index.group_mask + 1;
+    for (size_t i = 0; i < 5003; i++) {
+        t.probe = keys[i];
+        hash_index_insert(&index, hash_u64(keys[i]), i, &test_eq, &test_hash, &t);
+    }
+    assert(index.group_mask + 1 == groups);
+    hash_index_free(&index);
+
+    // Colliding hashes spill over into the next groups.
+    hash_index_init(&index, 0);
+    for (size_t i = 0; i < 100; i++) {
+        t.probe = keys[i];
+        assert(hash_index_insert(&index, 5, i, &test_bad_eq, &test_bad_hash,
+            &t) == i);
+    }
+    for (size_t i = 0; i < 100; i++) {
+        t.probe = keys[i];
+        assert(hash_index_find(&index, 5, &test_bad_eq, &t) == i);
+    }
+    hash_index_free(&index);
+    free(keys);
+}
+
+void test_hash_index_erase() {
+    size_t n = 2000;
+    uint64_t* keys = malloc(n * sizeof(uint64_t));
+    for (size_t i = 0; i < n; i++) keys[i] = i * 31;
+    TestKeys t = { .keys = keys };
+    HashIndex index;
+    hash_index_init(&index, 0);
+    for (size_t i = 0; i < n; i++) {
+        t.probe = keys[i];
+        hash_index_insert(&index, hash_u64(keys[i]), i, &test_eq, &test_hash, &t);
+    }
+    for (size_t i = 0; i < n; i += 2) {
+        t.probe = keys[i];
+        assert(hash_index_erase(&index, hash_u64(keys[i]), &test_eq, &t) == i);
+        assert(hash_index_erase(&index, hash_u64(keys[i]), &test_eq, &t)
+            == HASH_INDEX_NONE);
+    }
+    assert(index.count == n / 2);
+    for (size_t i = 0; i < n; i++) {
+        t.probe = keys[i];
+        size_t id = hash_index_find(&index, hash_u64(keys[i]), &test_eq, &t);
+        assert(id == (i % 2 ? i : HASH_INDEX_NONE));
+    }
+    // Churn through many more entries than slots: deleted marks are reused
+    // or dropped, so the index does not keep growing.
+    size_t groups = index.group_mask + 1;
+    for (size_t round = 0; round < 20; round++) {
+        for (size_t i = 0; i < n; i += 2) {
+            keys[i] = keys[i] + 7 * n;
+            t.probe = keys[i];
+            hash_index_insert(&index, hash_u64(keys[i]), i, &test_eq, &test_hash,
+                &t);
+        }
+        for (size_t i = 0; i < n; i += 2) {
+            t.probe = keys[i];
+            assert(hash_index_erase(&index, hash_u64(keys[i]), &test_eq, &t) == i);
+        }
+    }
+    assert(index.count == n / 2 && index.group_mask + 1 <= 2 * groups);
+    hash_index_free(&index);
+    free(keys);
+}
+
+int main() {
+    test_hash_bytes();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_hash_bytes", "Passed");
+    test_hash_index_partition();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_hash_index_partition", "Passed");
+    test_hash_index();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_hash_index", "Passed");
+    test_hash_index_erase();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_hash_index_erase", "Passed");
+    return 0;
+}
+
+#endif // TEST
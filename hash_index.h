@@ -0,0 +1,323 @@
+/**
+ * An open-addressing hash index for the hash-based functions. (Header file)
+ *
+ * A HashIndex maps hashes to the ids of entries (for example element
+ * indices or group numbers) that the caller stores elsewhere. It keeps no
+ * keys itself: lookups take an equality callback that compares the key
+ * being looked up with the key of a candidate id, and resizes take a
+ * callback that recomputes the hash of an id.
+ *
+ * The slots are split into groups of 16. Every slot has a control byte:
+ * empty, deleted, or the low 7 bits of the hash of its entry. A lookup
+ * compares the 16 control bytes of a group with the hash bits at once
+ * (with SSE2 when available), so the callback only runs for the rare
+ * slots whose 7 bits match. Groups are probed quadratically, and a lookup
+ * stops at the first group with an empty slot. The index keeps at most
+ * 7/8 of its slots full. Erased entries leave a deleted mark unless their
+ * group has an empty slot; the marks are reused by insertions and dropped
+ * when the index is resized.
+ *
+ * The lookup functions are inline, so that equality callbacks defined as
+ * static functions next to the call are inlined too.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _HASH_INDEX_H_
+#define _HASH_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * The id returned when no entry is found.
+ */
+#define HASH_INDEX_NONE ((size_t)-1)
+
+// The number of slots of a group.
+#define HASH_INDEX_GROUP 16
+
+// The control bytes of slots without an entry. Full slots hold 0 to 127.
+#define HASH_INDEX_EMPTY 0x80
+#define HASH_INDEX_DELETED 0xfe
+
+/**
+ * Function type for the equality test of a lookup.
+ *
+ * @param ctx The context given to the lookup, holding the key looked up.
+ * @param id The id of a candidate entry.
+ * @return 1 if the key of the entry equals the key looked up, 0 otherwise.
+ */
+typedef int (*HashIndexEqFn)(void* ctx, size_t id);
+
+/**
+ * Function type for recomputing the hash of an entry.
+ *
+ * @param ctx The context given to the insertion or resize.
+ * @param id The id of an entry in the index.
+ * @return The hash the entry was inserted with.
+ */
+typedef uint64_t (*HashIndexHashFn)(void* ctx, size_t id);
+
+/**
+ * A hash index. A zeroed HashIndex is an empty index without slots.
+ *
+ * @param ctrl The control bytes, one per slot.
+ * @param slots The ids of the entries.
+ * @param group_mask The number of groups minus one. The number of groups
+ * is a power of two.
+ * @param count The number of entries.
+ * @param growth_left The number of entries that can be added to empty
+ * slots before the index must be resized.
+ */
+typedef struct {
+    uint8_t* ctrl;
+    size_t* slots;
+    size_t group_mask;
+    size_t count;
+    size_t growth_left;
+} HashIndex;
+
+
+/**
+ * Hash a buffer of bytes.
+ *
+ * @param data The buffer.
+ * @param len The length of the buffer.
+ * @param seed A seed; different seeds give independent hashes.
+ * @return The hash of the buffer.
+ */
+uint64_t hash_bytes(const void* data, size_t len, uint64_t seed);
+
+/**
+ * Hash a 64-bit integer.
+ */
+static inline uint64_t hash_u64(uint64_t v) {
+    __uint128_t r = (__uint128_t)(v ^ 0x9e3779b97f4a7c15u) * 0xbf58476d1ce4e5b9u;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+/**
+ * Initialize an index with room for a number of entries.
+ *
+ * @param index The index.
+ * @param expected The number of entries to make room for. The index grows
+ * past it as needed.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int hash_index_init(HashIndex* index, size_t expected);
+
+/**
+ * Free the slots of an index. The index is left empty and zeroed.
+ *
+ * @param index The index.
+ */
+void hash_index_free(HashIndex* index);
+
+/**
+ * Remove all the entries of an index, keeping its slots.
+ *
+ * @param index The index.
+ */
+void hash_index_clear(HashIndex* index);
+
+/**
+ * Make room for a number of entries, rehashing the index. Deleted slots are
+ * reclaimed.
+ *
+ * @param index The index.
+ * @param n The number of entries to make room for.
+ * @param hash The function returning the hash of an entry.
+ * @param ctx The context passed to hash.
+ * @return 0 on success, -1 on allocation failure. The index is unchanged on
+ * failure.
+ */
+int hash_index_reserve(HashIndex* index, size_t n, HashIndexHashFn hash,
+    void* ctx);
+
+/**
+ * Return the memory taken by the slots of an index made for a number of
+ * entries with hash_index_init().
+ *
+ * @param entries The number of entries.
+ * @return The size of the control bytes and ids, in bytes.
+ */
+size_t hash_index_bytes(size_t entries);
+
+
+/**
+ * Return the bit mask of the slots of a group whose control byte equals a
+ * value. -- private
+ */
+static inline unsigned hash_index_match(const uint8_t* group, uint8_t value) {
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (unsigned)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)value)));
+#else
+    unsigned mask = 0;
+    for (int i = 0; i < HASH_INDEX_GROUP; i++) {
+        mask |= (unsigned)(group[i] == value) << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+ * Return the bit mask of the slots of a group without an entry. -- private
+ */
+static inline unsigned hash_index_match_free(const uint8_t* group) {
+#if defined(__SSE2__)
+    return (unsigned)_mm_movemask_epi8(
+        _mm_loadu_si128((const __m128i*)group));
+#else
+    unsigned mask = 0;
+    for (int i = 0; i < HASH_INDEX_GROUP; i++) {
+        mask |= (unsigned)(group[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+ * Return the first group probed for a hash. -- private
+ */
+static inline size_t hash_index_group(const HashIndex* index, uint64_t hash) {
+    return (size_t)(hash >> 7) & index->group_mask;
+}
+
+/**
+ * Split hashes into partitions, for functions that build one index per
+ * partition. The top 32 bits of the hash are scaled to the number of
+ * partitions, so the partitions of an index's entries still spread over
+ * its groups, which hash_index_group() picks from the low bits. A power of
+ * two 2^b of partitions takes the top b bits.
+ *
+ * @param hash The hash.
+ * @param n_partitions The number of partitions, at most 2^32.
+ * @return The partition, below n_partitions.
+ */
+static inline size_t hash_index_partition(uint64_t hash, size_t n_partitions) {
+    return (size_t)(((hash >> 32) * n_partitions) >> 32);
+}
+
+/**
+ * Find the slot of an entry, or HASH_INDEX_NONE. -- private
+ */
+static inline size_t hash_index_find_slot(const HashIndex* index,
+    uint64_t hash, HashIndexEqFn eq, void* ctx) {
+    if (!index->ctrl) return HASH_INDEX_NONE;
+    uint8_t h2 = (uint8_t)(hash & 0x7f);
+    size_t g = hash_index_group(index, hash);
+    for (size_t step = 1;; step++) {
+        const uint8_t* group = index->ctrl + g * HASH_INDEX_GROUP;
+        for (unsigned m = hash_index_match(group, h2); m; m &= m - 1) {
+            size_t slot = g * HASH_INDEX_GROUP + (size_t)__builtin_ctz(m);
+            if (eq(ctx, index->slots[slot])) return slot;
+        }
+        if (hash_index_match(group, HASH_INDEX_EMPTY)) return HASH_INDEX_NONE;
+        // Groups may be full, but growth_left keeps an empty slot in some
+        // group, and the triangular probe sequence visits every group.
+        g = (g + step) & index->group_mask;
+    }
+}
+
+/**
+ * Return the first slot without an entry along the probe sequence of a
+ * hash. The index must have one. -- private
+ */
+static inline size_t hash_index_free_slot(const HashIndex* index,
+    uint64_t hash) {
+    size_t g = hash_index_group(index, hash);
+    for (size_t step = 1;; step++) {
+        unsigned m = hash_index_match_free(index->ctrl + g * HASH_INDEX_GROUP);
+        if (m) return g * HASH_INDEX_GROUP + (size_t)__builtin_ctz(m);
+        g = (g + step) & index->group_mask;
+    }
+}
+
+
+/**
+ * Find an entry.
+ *
+ * @param index The index.
+ * @param hash The hash of the key.
+ * @param eq The function comparing the key with the key of an entry.
+ * @param ctx The context passed to eq.
+ * @return The id of the entry, or HASH_INDEX_NONE if there is none.
+ */
+static inline size_t hash_index_find(const HashIndex* index, uint64_t hash,
+    HashIndexEqFn eq, void* ctx) {
+    size_t slot = hash_index_find_slot(index, hash, eq, ctx);
+    return slot == HASH_INDEX_NONE ? HASH_INDEX_NONE : index->slots[slot];
+}
+
+/**
+ * Find an entry, inserting it if there is none.
+ *
+ * @param index The index.
+ * @param hash The hash of the key.
+ * @param id The id to insert if the key has no entry.
+ * @param eq The function comparing the key with the key of an entry.
+ * @param rehash The function returning the hash of an entry, used if the
+ * index has to grow.
+ * @param ctx The context passed to eq and rehash.
+ * @return The id of the existing entry, id if it was inserted, or
+ * HASH_INDEX_NONE on allocation failure.
+ */
+static inline size_t hash_index_insert(HashIndex* index, uint64_t hash,
+    size_t id, HashIndexEqFn eq, HashIndexHashFn rehash, void* ctx) {
+    size_t slot = hash_index_find_slot(index, hash, eq, ctx);
+    if (slot != HASH_INDEX_NONE) return index->slots[slot];
+    if (index->growth_left == 0) {
+        // Doubling the entries keeps resizes amortized when the index is full,
+        // and only rehashes in place when deleted slots took the room.
+        if (hash_index_reserve(index, 2 * index->count + 1, rehash, ctx) != 0) {
+            return HASH_INDEX_NONE;
+        }
+    }
+    slot = hash_index_free_slot(index, hash);
+    // Reusing a deleted slot does not take room from the empty ones.
+    if (index->ctrl[slot] == HASH_INDEX_EMPTY) index->growth_left--;
+    index->ctrl[slot] = (uint8_t)(hash & 0x7f);
+    index->slots[slot] = id;
+    index->count++;
+    return id;
+}
+
+/**
+ * Remove an entry.
+ *
+ * @param index The index.
+ * @param hash The hash of the key.
+ * @param eq The function comparing the key with the key of an entry.
+ * @param ctx The context passed to eq.
+ * @return The id of the removed entry, or HASH_INDEX_NONE if there is none.
+ */
+static inline size_t hash_index_erase(HashIndex* index, uint64_t hash,
+    HashIndexEqFn eq, void* ctx) {
+    size_t slot = hash_index_find_slot(index, hash, eq, ctx);
+    if (slot == HASH_INDEX_NONE) return HASH_INDEX_NONE;
+    // Lookups stop at a group with an empty slot, so in such a group the
+    // slot can become empty again; elsewhere it must stay in the probe path.
+    const uint8_t* group = index->ctrl + slot / HASH_INDEX_GROUP * HASH_INDEX_GROUP;
+    if (hash_index_match(group, HASH_INDEX_EMPTY)) {
+        index->ctrl[slot] = HASH_INDEX_EMPTY;
+        index->growth_left++;
+    } else {
+        index->ctrl[slot] = HASH_INDEX_DELETED;
+    }
+    index->count--;
+    return index->slots[slot];
+}
+
+
+#endif // _HASH_INDEX_H_
@@ -0,0 +1,583 @@
+/**
+ * Joining two arrays of elements by key.
+ *
+ * The keys and hashes of both sides are computed once. The build table is
+ * a HashIndex over the distinct keys of the shorter side; the elements
+ * sharing a key are chained in index order through a next array, so a
+ * probe walks its matches in ascending order.
+ *
+ * In the partitioned mode both sides are sorted into partitions by the top
+ * bits of their hashes, with a counting sort that keeps the index order
+ * within each partition. The keys of one build partition are copied next
+ * to each other, so its table, chains and keys stay in cache while the
+ * matching probe partition is streamed through it.
+ *
+ * Matches are produced in probe order. When the left side is the build
+ * side, or when partitioning interleaves the left indices, the pairs are
+ * put back in left order with a stable radix sort on the left index.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include "join_data.h"
+#include "hash_index.h"
+#include "sort_data.h"
+#ifdef TEST
+#include <assert.h>
+#include <stdio.h>
+#endif
+
+
+/**
+ * The build table of a partition. -- private
+ *
+ * @param index Maps the keys to the first element holding them.
+ * @param keys The keys of the elements of the partition.
+ * @param hashes The hashes of the keys.
+ * @param next The next element with the same key, or HASH_INDEX_NONE.
+ * @param tail The last element of the chain started by an element. Once
+ * the table is built, semi and anti joins set it to HASH_INDEX_NONE when
+ * the chain has been marked.
+ * @param probe The key being looked up.
+ */
+typedef struct {
+    HashIndex index;
+    const unsigned char* keys;
+    const uint64_t* hashes;
+    size_t key_len;
+    size_t* next;
+    size_t* tail;
+    const unsigned char* probe;
+} JoinTable;
+
+/**
+ * The keys of one side of a join, and its partitions. -- private
+ *
+ * @param keys The key of every element.
+ * @param hashes The hash of every key.
+ * @param rows The elements sorted by partition, or NULL without partitions.
+ * @param bounds The start of every partition in rows.
+ */
+typedef struct {
+    unsigned char* keys;
+    uint64_t* hashes;
+    size_t count;
+    size_t* rows;
+    size_t* bounds;
+} JoinKeys;
+
+
+/**
+ * Compare the key looked up with the key of a build element. -- private
+ */
+static int join_eq(void* ctx, size_t id) {
+    const JoinTable* t = ctx;
+    return memcmp(t->keys + id * t->key_len, t->probe, t->key_len) == 0;
+}
+
+
+/**
+ * Return the hash of the key of a build element. -- private
+ */
+static uint64_t join_hash(void* ctx, size_t id) {
+    return ((const JoinTable*)ctx)->hashes[id];
+}
+
+
+/**
+ * Compute the keys and hashes of a side. -- private
+ */
+static int compute_keys(const JoinSide* side, size_t key_len, JoinKeys* out) {
+    memset(out, 0, sizeof(*out));
+    out->count = side->el_count;
+    out->keys = malloc(side->el_count * key_len + 1);
+    out->hashes = malloc(side->el_count * sizeof(uint64_t) + 1);
+    if (!out->keys || !out->hashes) return -1;
+    const unsigned char* ix = side->data;
+    for (size_t i = 0; i < side->el_count; i++) {
+        unsigned char* k = out->keys + i * key_len;
+        side->key(k, ix + i * side->el_len, i);
+        out->hashes[i] = hash_bytes(k, key_len, 0);
+    }
+    return 0;
+}
+
+
+/**
+ * Free the keys of a side. -- private
+ */
+static void free_keys(JoinKeys* k) {
+    free(k->keys);
+    free(k->hashes);
+    free(k->rows);
+    free(k->bounds);
+}
+
+
+/**
+ * Sort the elements of a side by partition, keeping index order within
+ * each partition. -- private
+ */
+static int partition_keys(JoinKeys* k, unsigned bits) {
+    size_t n_parts = (size_t)1 << bits;
+    k->rows = malloc(k->count * sizeof(size_t) + 1);
+    k->bounds = calloc(n_parts + 1, sizeof(size_t));
+    size_t* next = malloc(n_parts * sizeof(size_t));
+    if (!k->rows || !k->bounds || !next) {
+        free(next);
+        return -1;
+    }
+    for (size_t i = 0; i < k->count; i++) {
+        k->bounds[hash_index_partition(k->hashes[i], n_parts) + 1]++;
+    }
+    for (size_t p = 0; p < n_parts; p++) k->bounds[p + 1] += k->bounds[p];
+    memcpy(next, k->bounds, n_parts * sizeof(size_t));
+    for (size_t i = 0; i < k->count; i++) {
+        k->rows[next[hash_index_partition(k->hashes[i], n_parts)]++] = i;
+    }
+    free(next);
+    return 0;
+}
+
+
+/**
+ * Build the table of n elements whose keys and hashes are contiguous.
+ * -- private
+ */
+static int build_table(JoinTable* t, size_t n) {
+    if (hash_index_init(&t->index, n) != 0) return -1;
+    for (size_t i = 0; i < n; i++) {
+        t->probe = t->keys + i * t->key_len;
+        size_t id = hash_index_insert(&t->index, t->hashes[i], i, &join_eq,
+            &join_hash, t);
+        if (id == HASH_INDEX_NONE) return -1;
+        t->next[i] = HASH_INDEX_NONE;
+        if (id == i) {
+            t->tail[i] = i;
+        } else {
+            t->next[t->tail[id]] = i;
+            t->tail[id] = i;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * Append a pair to a packed list, doubling its capacity as needed.
+ * -- private
+ */
+static int append_pair(PackedList* out, size_t left, size_t right) {
+    if (out->count == out->capacity) {
+        size_t cap = out->capacity ? out->capacity * 2 : 16;
+        JoinPair* data = realloc(out->data, cap * sizeof(JoinPair));
+        if (!data) return -1;
+        out->data = data;
+        out->capacity = cap;
+    }
+    JoinPair* pairs = out->data;
+    pairs[out->count].left = left;
+    pairs[out->count].right = right;
+    out->count++;
+    return 0;
+}
+
+
+/**
+ * Return the left index of a pair as its sort key. -- private
+ */
+static uint64_t pair_left_key(const void* elem) {
+    return sort_key_u64(((const JoinPair*)elem)->left);
+}
+
+
+/**
+ * Return the number of partition bits that bring the table of n build
+ * elements under the given size. -- private
+ */
+static unsigned partition_bits(size_t n, size_t key_len, size_t bytes) {
+    // The key, hash, chain links and row of an element, and its share of
+    // the index slots at the lowest load.
+    size_t per_element = key_len + sizeof(uint64_t) + 3 * sizeof(size_t)
+        + 2 * (1 + sizeof(size_t));
+    unsigned bits = 0;
+    while (bits < 24 && (n >> bits) > 1 && (n >> bits) * per_element > bytes) {
+        bits++;
+    }
+    return bits;
+}
+
+
+/**
+ * Join two sides. An inner join appends the matches to pairs, in left
+ * order; semi and anti joins set the bits of the matched left elements.
+ * -- private
+ */
+static int run_join(JoinKind kind, const JoinSide* left, const JoinSide* right,
+    size_t key_len, const JoinOpts* opts, PackedList* pairs, uint64_t* matched) {
+    int build_left = left->el_count < right->el_count;
+    JoinKeys lk, rk;
+    int rc = -1;
+    int ok = compute_keys(left, key_len, &lk) == 0;
+    ok = compute_keys(right, key_len, &rk) == 0 && ok;
+    JoinKeys* bk = build_left ? &lk : &rk;
+    JoinKeys* pk = build_left ? &rk : &lk;
+    unsigned bits = opts && opts->partition_bytes
+        ? partition_bits(bk->count, key_len, opts->partition_bytes) : 0;
+    if (ok && bits) {
+        ok = partition_keys(bk, bits) == 0 && partition_keys(pk, bits) == 0;
+    }
+    JoinTable t = { .key_len = key_len };
+    size_t max_build = 0;
+    for (size_t p = 0; ok && p < ((size_t)1 << bits); p++) {
+        size_t n = bits ? bk->bounds[p + 1] - bk->bounds[p] : bk->count;
+        max_build = n > max_build ? n : max_build;
+    }
+    t.next = malloc(max_build * sizeof(size_t) + 1);
+    t.tail = malloc(max_build * sizeof(size_t) + 1);
+    unsigned char* part_keys = bits ? malloc(max_build * key_len + 1) : NULL;
+    uint64_t* part_hashes = bits ? malloc(max_build * sizeof(uint64_t) + 1) : NULL;
+    if (!ok || !t.next || !t.tail || (bits && (!part_keys || !part_hashes))) {
+        goto done;
+    }
+
+    for (size_t p = 0; p < ((size_t)1 << bits); p++) {
+        size_t b_lo = bits ? bk->bounds[p] : 0;
+        size_t b_hi = bits ? bk->bounds[p + 1] : bk->count;
+        size_t p_lo = bits ? pk->bounds[p] : 0;
+        size_t p_hi = bits ? pk->bounds[p + 1] : pk->count;
+        if (bits) {
+            for (size_t i = b_lo; i < b_hi; i++) {
+                size_t row = bk->rows[i];
+                memcpy(part_keys + (i - b_lo) * key_len,
+                    bk->keys + row * key_len, key_len);
+                part_hashes[i - b_lo] = bk->hashes[row];
+            }
+            t.keys = part_keys;
+            t.hashes = part_hashes;
+        } else {
+            t.keys = bk->keys;
+            t.hashes = bk->hashes;
+        }
+        if (build_table(&t, b_hi - b_lo) != 0) goto done;
+        for (size_t i = p_lo; i < p_hi; i++) {
+            size_t row = bits ? pk->rows[i] : i;
+            t.probe = pk->keys + row * key_len;
+            size_t id = hash_index_find(&t.index, pk->hashes[row], &join_eq, &t);
+            if (id == HASH_INDEX_NONE) continue;
+            if (kind != JOIN_INNER && !build_left) {
+                matched[row / 64] |= (uint64_t)1 << (row % 64);
+                continue;
+            }
+            if (kind != JOIN_INNER) {
+                // Later probes of the same key would mark the same chain
+                // again, so every chain is only walked once.
+                if (t.tail[id] == HASH_INDEX_NONE) continue;
+                t.tail[id] = HASH_INDEX_NONE;
+                for (; id != HASH_INDEX_NONE; id = t.next[id]) {
+                    size_t b_row = bits ? bk->rows[b_lo + id] : id;
+                    matched[b_row / 64] |= (uint64_t)1 << (b_row % 64);
+                }
+                continue;
+            }
+            for (; id != HASH_INDEX_NONE; id = t.next[id]) {
+                size_t b_row = bits ? bk->rows[b_lo + id] : id;
+                if (append_pair(pairs, build_left ? b_row : row,
+                    build_left ? row : b_row) != 0) {
+                    goto done;
+                }
+            }
+        }
+        hash_index_free(&t.index);
+    }
+    if (kind == JOIN_INNER && (build_left || bits) && pairs->count > 1) {
+        PackedList sorted = sort_data_key(&pair_left_key, pairs->data,
+            sizeof(JoinPair), pairs->count);
+        if (!sorted.data) goto done;
+        free_packed(pairs);
+        *pairs = sorted;
+    }
+    rc = 0;
+done:
+    hash_index_free(&t.index);
+    free(t.next);
+    free(t.tail);
+    free(part_keys);
+    free(part_hashes);
+    free_keys(&lk);
+    free_keys(&rk);
+    return rc;
+}
+
+
+/**
+ * Check one side of a join. -- private
+ */
+static int valid_side(const JoinSide* side) {
+    return side != NULL && side->key != NULL && side->el_len > 0
+        && (side->data != NULL || side->el_count == 0);
+}
+
+
+// Documentation in header file.
+PackedList hash_join_data(JoinKind kind, const JoinSide* left,
+    const JoinSide* right, size_t key_len, const JoinOpts* opts) {
+    PackedList out = { .data = NULL, .count = 0, .el_len = 0, .capacity = 0,
+        .allocator = NULL };
+    if (!valid_side(left) || !valid_side(right) || key_len == 0
+        || left->el_count == 0 || (kind != JOIN_INNER && kind != JOIN_SEMI
+            && kind != JOIN_ANTI)) {
+        return out;
+    }
+    if (kind == JOIN_INNER) {
+        out.el_len = sizeof(JoinPair);
+        if (run_join(kind, left, right, key_len, opts, &out, NULL) != 0) {
+            free_packed(&out);
+        }
+        if (out.count == 0) free_packed(&out);
+        return out;
+    }
+    size_t n = left->el_count;
+    uint64_t* matched = calloc((n + 63) / 64, sizeof(uint64_t));
+    if (!matched) return out;
+    if (run_join(kind, left, right, key_len, opts, NULL, matched) == 0) {
+        // A semi join keeps the set bits, an anti join the clear ones.
+        uint64_t flip = kind == JOIN_ANTI ? ~(uint64_t)0 : 0;
+        size_t kept = 0;
+        for (size_t i = 0; i < n; i++) {
+            kept += ((matched[i / 64] ^ flip) >> (i % 64)) & 1;
+        }
+        size_t* idx = kept ? malloc(kept * sizeof(size_t)) : NULL;
+        if (idx) {
+            size_t k = 0;
+            for (size_t i = 0; i < n; i++) {
+                if (((matched[i / 64] ^ flip) >> (i % 64)) & 1) idx[k++] = i;
+            }
+            out.data = idx;
+            out.count = kept;
+            out.el_len = sizeof(size_t);
+            out.capacity = kept;
+        }
+    }
+    free(matched);
+    return out;
+}
+
+
+// Documentation in header file.
+PackedList hash_join_data_combine(JoinKind kind, const JoinSide* left,
+    const JoinSide* right, size_t key_len, JoinCombineFn combine,
+    size_t out_len, const JoinOpts* opts) {
+    PackedList out = { .data = NULL, .count = 0, .el_len = 0, .capacity = 0,
+        .allocator = NULL };
+    if (combine == NULL || out_len == 0) return out;
+    PackedList matches = hash_join_data(kind, left, right, key_len, opts);
+    if (matches.count == 0) return out;
+    unsigned char* rows = malloc(matches.count * out_len);
+    if (rows) {
+        const unsigned char* lx = left->data;
+        const unsigned char* rx = right->data;
+        for (size_t i = 0; i < matches.count; i++) {
+            if (kind == JOIN_INNER) {
+                const JoinPair* pair = &((const JoinPair*)matches.data)[i];
+                combine(rows + i * out_len, lx + pair->left * left->el_len,
+                    rx + pair->right * right->el_len);
+            } else {
+                size_t l = ((const size_t*)matches.data)[i];
+                combine(rows + i * out_len, lx + l * left->el_len, NULL);
+            }
+        }
+        out.data = rows;
+        out.count = matches.count;
+        out.el_len = out_len;
+        out.capacity = matches.count;
+    }
+    free_packed(&matches);
+    return out;
+}
+
+
+#ifdef TEST
+typedef struct {
+    int id;
+    int customer;
+} Order;
+
+typedef struct {
+    int id;
+    char name[12];
+} Customer;
+
+typedef struct {
+    int order;
+    char name[12];
+} OrderName;
+
+void order_customer(void* key, const void* elem, size_t _) {
+    *(int*)key = ((const Order*)elem)->customer;
+}
+
+void customer_id(void* key, const void* elem, size_t _) {
+    *(int*)key = ((const Customer*)elem)->id;
+}
+
+void int_key(void* key, const void* elem, size_t _) {
+    *(int*)key = *(const int*)elem;
+}
+
+void name_order(void* out, const void* left, const void* right) {
+    OrderName* row = out;
+    row->order = ((const Order*)left)->id;
+    memcpy(row->name, ((const Customer*)right)->name, sizeof(row->name));
+}
+
+/**
+ * Check an inner join of two int arrays against a nested loop.
+ */
+void check_inner(const int* a, size_t na, const int* b, size_t nb,
+    const JoinOpts* opts) {
+    JoinSide l = { a, sizeof(int), na, &int_key };
+    JoinSide r = { b, sizeof(int), nb, &int_key };
+    PackedList out = hash_join_data(JOIN_INNER, &l, &r, sizeof(int), opts);
+    const JoinPair* pairs = out.data;
+    size_t k = 0;
+    for (size_t i = 0; i < na; i++) {
+        for (size_t j = 0; j < nb; j++) {
+            if (a[i] != b[j]) continue;
+            assert(k < out.count);
+            assert(pairs[k].left == i && pairs[k].right == j);
+            k++;
+        }
+    }
+    assert(k == out.count);
+    free_packed(&out);
+
+    PackedList semi = hash_join_data(JOIN_SEMI, &l, &r, sizeof(int), opts);
+    PackedList anti = hash_join_data(JOIN_ANTI, &l, &r, sizeof(int), opts);
+    size_t s = 0, t = 0;
+    for (size_t i = 0; i < na; i++) {
+        size_t j = 0;
+        while (j < nb && b[j] != a[i]) j++;
+        if (j < nb) assert(((size_t*)semi.data)[s++] == i);
+        else assert(((size_t*)anti.data)[t++] == i);
+    }
+    assert(s == semi.count && t == anti.count);
+    free_packed(&semi);
+    free_packed(&anti);
+}
+
+int* make_keys(size_t n, int range, unsigned int seed) {
+    int* keys = malloc(n * sizeof(int));
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1103515245u + 12345u;
+        keys[i] = (int)((seed >> 8) % (unsigned)range);
+    }
+    return keys;
+}
+
+void test_hash_join_data() {
+    Order orders[] = { { 100, 2 }, { 101, 1 }, { 102, 2 }, { 103, 9 } };
+    Customer customers[] = { { 1, "ada" }, { 2, "bob" }, { 3, "cy" } };
+    JoinSide l = { orders, sizeof(Order), 4, &order_customer };
+    JoinSide r = { customers, sizeof(Customer), 3, &customer_id };
+    PackedList out = hash_join_data(JOIN_INNER, &l, &r, sizeof(int), NULL);
+    const JoinPair* pairs = out.data;
+    assert(out.count == 3 && out.el_len == sizeof(JoinPair));
+    assert(pairs[0].left == 0 && pairs[0].right == 1);
+    assert(pairs[1].left == 1 && pairs[1].right == 0);
+    assert(pairs[2].left == 2 && pairs[2].right == 1);
+    free_packed(&out);
+
+    out = hash_join_data_combine(JOIN_INNER, &l, &r, sizeof(int), &name_order,
+        sizeof(OrderName), NULL);
+    const OrderName* rows = out.data;
+    assert(out.count == 3);
+    assert(rows[0].order == 100 && strcmp(rows[0].name, "bob") == 0);
+    assert(rows[1].order == 101 && strcmp(rows[1].name, "ada") == 0);
+    free_packed(&out);
+
+    out = hash_join_data(JOIN_ANTI, &l, &r, sizeof(int), NULL);
+    assert(out.count == 1 && ((size_t*)out.data)[0] == 3);
+    free_packed(&out);
+
+    // Either side may be the build side, and may be empty.
+    int a[] = { 5, 3, 5, 8, 1, 3, 5 };
+    int b[] = { 3, 5, 5, 7 };
+    check_inner(a, 7, b, 4, NULL);
+    check_inner(b, 4, a, 7, NULL);
+    check_inner(a, 7, b, 0, NULL);
+    JoinSide e = { b, sizeof(int), 0, &int_key };
+    JoinSide full = { a, sizeof(int), 7, &int_key };
+    out = hash_join_data(JOIN_ANTI, &full, &e, sizeof(int), NULL);
+    assert(out.count == 7);
+    free_packed(&out);
+    out = hash_join_data(JOIN_INNER, &e, &full, sizeof(int), NULL);
+    assert(out.data == NULL && out.count == 0);
+}
+
+void test_hash_join_data_partitioned() {
+    JoinOpts opts = { .partition_bytes = 4096 };
+    size_t sizes[][2] = { { 3000, 500 }, { 500, 3000 }, { 2000, 2000 } };
+    for (size_t s = 0; s < 3; s++) {
+        int* a = make_keys(sizes[s][0], 900, 1);
+        int* b = make_keys(sizes[s][1], 900, 2);
+        check_inner(a, sizes[s][0], b, sizes[s][1], &opts);
+        check_inner(a, sizes[s][0], b, sizes[s][1], NULL);
+        free(a);
+        free(b);
+    }
+}
+
+void test_hash_join_data_skewed() {
+    // The shorter left side is the build side, and most of both sides share
+    // one key: marking its chain once per probe would take 10^10 steps.
+    size_t nl = 100000, nr = 200000;
+    int* a = make_keys(nl, 1000, 3);
+    int* b = make_keys(nr, 1000, 4);
+    for (size_t i = 0; i < nl; i++) if (i % 10) a[i] = -1;
+    // The other keys of the right side only overlap half of the left ones.
+    for (size_t i = 0; i < nr; i++) b[i] = i % 10 ? -1 : b[i] + 500;
+    char present[1500] = { 0 };
+    for (size_t i = 0; i < nr; i += 10) present[b[i]] = 1;
+    JoinSide l = { a, sizeof(int), nl, &int_key };
+    JoinSide r = { b, sizeof(int), nr, &int_key };
+    JoinOpts part = { .partition_bytes = 4096 };
+    const JoinOpts* opts[] = { NULL, &part };
+    for (size_t o = 0; o < 2; o++) {
+        PackedList semi = hash_join_data(JOIN_SEMI, &l, &r, sizeof(int),
+            opts[o]);
+        PackedList anti = hash_join_data(JOIN_ANTI, &l, &r, sizeof(int),
+            opts[o]);
+        size_t s = 0, t = 0;
+        for (size_t i = 0; i < nl; i++) {
+            if (a[i] == -1 || present[a[i]]) {
+                assert(((size_t*)semi.data)[s++] == i);
+            } else {
+                assert(((size_t*)anti.data)[t++] == i);
+            }
+        }
+        assert(s == semi.count && t == anti.count && t > 0);
+        free_packed(&semi);
+        free_packed(&anti);
+    }
+    free(a);
+    free(b);
+}
+
+int main() {
+    test_hash_join_data();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_hash_join_data", "Passed");
+    test_hash_join_data_partitioned();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_hash_join_data_partitioned", "Passed");
+    test_hash_join_data_skewed();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_hash_join_data_skewed", "Passed");
+    return 0;
+}
+
+#endif // TEST
@@ -0,0 +1,123 @@
+/**
+ * Joining two arrays of elements by key. (Header file)
+ *
+ * hash_join_data() relates the elements of two arrays whose keys are
+ * equal, in time linear in their lengths plus the number of matches. A key
+ * function per side writes a fixed size key for each element; keys are
+ * compared bytewise. A hash table is built on the shorter array and probed
+ * with the other one.
+ *
+ * Three kinds of joins are supported: the inner join returns every pair of
+ * matching elements, the semi join the left elements with at least one
+ * match, and the anti join the left elements without any.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _JOIN_DATA_H_
+#define _JOIN_DATA_H_
+
+#include <stdlib.h>
+#include "functools.h"
+
+/**
+ * A suggested partition size for hash_join_data(): the size of a typical
+ * L2 cache.
+ */
+#define JOIN_L2_BYTES (256 * 1024)
+
+/**
+ * The kinds of joins.
+ */
+typedef enum {
+    JOIN_INNER,
+    JOIN_SEMI,
+    JOIN_ANTI
+} JoinKind;
+
+/**
+ * One side of a join.
+ *
+ * @param data The array.
+ * @param el_len The length of each element.
+ * @param el_count The number of elements.
+ * @param key The function writing the key of an element.
+ */
+typedef struct {
+    const void* data;
+    size_t el_len;
+    size_t el_count;
+    MapIntoDataFn key;
+} JoinSide;
+
+/**
+ * A pair of matching elements of an inner join.
+ *
+ * @param left The index of the left element.
+ * @param right The index of the right element.
+ */
+typedef struct {
+    size_t left;
+    size_t right;
+} JoinPair;
+
+/**
+ * Options for the joins.
+ *
+ * @param partition_bytes Zero to build one table for the whole shorter
+ * array. Otherwise both arrays are split into partitions by hash so that
+ * the table of each partition takes about partition_bytes, for example
+ * JOIN_L2_BYTES, and the partitions are joined one by one with their table
+ * in cache. This pays off when the table would not fit in cache.
+ */
+typedef struct {
+    size_t partition_bytes;
+} JoinOpts;
+
+/**
+ * Function type for combining matching elements into an output row.
+ *
+ * @param out The output row to write.
+ * @param left The left element.
+ * @param right The right element, or NULL for semi and anti joins.
+ */
+typedef void (*JoinCombineFn)(void* out, const void* left, const void* right);
+
+
+/**
+ * Join two arrays by key.
+ *
+ * @param kind The kind of join.
+ * @param left The left array.
+ * @param right The right array.
+ * @param key_len The length of the keys of both sides.
+ * @param opts The options, NULL for the defaults.
+ * @return For an inner join, the JoinPair of every match, ordered by left
+ * index and then by right index. For semi and anti joins, the indices of
+ * the left elements kept, as size_t, in ascending order. Zeroed when empty,
+ * on invalid input or on allocation failure.
+ *
+ * @note The returned list must be freed by the caller with free_packed().
+ */
+PackedList hash_join_data(JoinKind kind, const JoinSide* left,
+    const JoinSide* right, size_t key_len, const JoinOpts* opts);
+
+/**
+ * Join two arrays by key, writing an output row for every result.
+ *
+ * @param combine The function writing the output row of a match, or of a
+ * left element for semi and anti joins.
+ * @param out_len The length of the output rows.
+ * @return The output rows, in the order of hash_join_data().
+ * @see hash_join_data()
+ */
+PackedList hash_join_data_combine(JoinKind kind, const JoinSide* left,
+    const JoinSide* right, size_t key_len, JoinCombineFn combine,
+    size_t out_len, const JoinOpts* opts);
+
+
+#endif // _JOIN_DATA_H_
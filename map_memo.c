@@ -0,0 +1,529 @@
+/**
+ * Memoized map with a bounded LRU cache.
+ *
+ * The entries of a cache live in an array and are chained from the most to
+ * the least recently used through prev and next indices; freed entries are
+ * chained in a free list through next. A HashIndex maps the keys to the
+ * entries, and an evicted entry is erased from it.
+ *
+ * Every cached output lives in a reference counted MemoObject. The cache
+ * holds one reference; in MEMO_SHARED mode every output list element holds
+ * another, so an evicted output lives on until its last list releases it.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "map_memo.h"
+#include "hash_index.h"
+#ifdef TEST
+#include <assert.h>
+#include <stdio.h>
+#endif
+
+#define MEMO_NONE HASH_INDEX_NONE
+
+
+//
+// Private classes - not exposed in the header
+//
+/**
+ * A cached output and its reference count.
+ */
+typedef struct {
+    size_t refs;
+    _Alignas(max_align_t) unsigned char data[];
+} MemoObject;
+
+/**
+ * An entry of the cache.
+ * @param key The element bytes.
+ * @param obj The output.
+ * @param hash The hash of the key.
+ * @param prev The next more recently used entry, or MEMO_NONE.
+ * @param next The next less recently used entry, or MEMO_NONE. For free
+ * entries, the next free entry.
+ */
+typedef struct {
+    unsigned char* key;
+    size_t key_len;
+    MemoObject* obj;
+    uint64_t hash;
+    size_t prev;
+    size_t next;
+} MemoEntry;
+
+struct MemoCache {
+    HashIndex index;
+    MemoEntry* entries;
+    size_t cap;               // entries allocated
+    size_t used;              // entries ever taken from the array
+    size_t free_head;         // first free entry
+    size_t head;              // most recently used entry
+    size_t tail;              // least recently used entry
+    MemoMode mode;
+    size_t out_len;
+    size_t max_entries;
+    size_t max_bytes;
+    MemoStats stats;
+    const unsigned char* probe; // the key being looked up
+    size_t probe_len;
+    size_t target;              // the entry being erased
+};
+
+
+/**
+ * Compare the key looked up with the key of an entry. -- private
+ */
+static int key_eq(void* ctx, size_t id) {
+    const MemoCache* c = ctx;
+    const MemoEntry* e = &c->entries[id];
+    return e->key_len == c->probe_len
+        && memcmp(e->key, c->probe, c->probe_len) == 0;
+}
+
+
+/**
+ * Tell whether an entry is the one being erased. -- private
+ */
+static int is_target(void* ctx, size_t id) {
+    return ((const MemoCache*)ctx)->target == id;
+}
+
+
+/**
+ * Return the hash of the key of an entry. -- private
+ */
+static uint64_t entry_hash(void* ctx, size_t id) {
+    return ((const MemoCache*)ctx)->entries[id].hash;
+}
+
+
+/**
+ * Return the memory used by an entry. -- private
+ */
+static size_t entry_bytes(const MemoCache* c, size_t key_len) {
+    return key_len + sizeof(MemoObject) + c->out_len + sizeof(MemoEntry);
+}
+
+
+/**
+ * Release a reference to an output. -- private
+ */
+static void release_object(MemoObject* obj) {
+    if (__atomic_sub_fetch(&obj->refs, 1, __ATOMIC_ACQ_REL) == 0) free(obj);
+}
+
+
+/**
+ * Take an entry out of the recency list. -- private
+ */
+static void unlink_entry(MemoCache* c, size_t id) {
+    MemoEntry* e = &c->entries[id];
+    if (e->prev != MEMO_NONE) c->entries[e->prev].next = e->next;
+    else c->head = e->next;
+    if (e->next != MEMO_NONE) c->entries[e->next].prev = e->prev;
+    else c->tail = e->prev;
+}
+
+
+/**
+ * Put an entry at the front of the recency list. -- private
+ */
+static void push_front(MemoCache* c, size_t id) {
+    MemoEntry* e = &c->entries[id];
+    e->prev = MEMO_NONE;
+    e->next = c->head;
+    if (c->head != MEMO_NONE) c->entries[c->head].prev = id;
+    c->head = id;
+    if (c->tail == MEMO_NONE) c->tail = id;
+}
+
+
+/**
+ * Remove an entry from the cache. -- private
+ */
+static void drop_entry(MemoCache* c, size_t id) {
+    MemoEntry* e = &c->entries[id];
+    c->target = id;
+    hash_index_erase(&c->index, e->hash, &is_target, c);
+    unlink_entry(c, id);
+    c->stats.bytes -= entry_bytes(c, e->key_len);
+    c->stats.entries--;
+    free(e->key);
+    release_object(e->obj);
+    e->key = NULL;
+    e->obj = NULL;
+    e->next = c->free_head;
+    c->free_head = id;
+}
+
+
+/**
+ * Take a free entry, growing the array as needed. -- private
+ */
+static size_t take_entry(MemoCache* c) {
+    if (c->free_head != MEMO_NONE) {
+        size_t id = c->free_head;
+        c->free_head = c->entries[id].next;
+        return id;
+    }
+    if (c->used == c->cap) {
+        size_t cap = c->cap ? c->cap * 2 : 64;
+        MemoEntry* entries = realloc(c->entries, cap * sizeof(MemoEntry));
+        if (!entries) return MEMO_NONE;
+        c->entries = entries;
+        c->cap = cap;
+    }
+    return c->used++;
+}
+
+
+/**
+ * Add an output to the cache, evicting the least recently used entries to
+ * stay within the limits. The cache takes a reference to obj. Returns -1
+ * on allocation failure. -- private
+ */
+static int add_entry(MemoCache* c, const unsigned char* key, size_t key_len,
+    uint64_t hash, MemoObject* obj) {
+    size_t bytes = entry_bytes(c, key_len);
+    if (c->max_bytes && bytes > c->max_bytes) return 0;
+    while (c->stats.entries > 0
+        && ((c->max_entries && c->stats.entries >= c->max_entries)
+            || (c->max_bytes && c->stats.bytes + bytes > c->max_bytes))) {
+        drop_entry(c, c->tail);
+        c->stats.evictions++;
+    }
+    size_t id = take_entry(c);
+    if (id == MEMO_NONE) return -1;
+    MemoEntry* e = &c->entries[id];
+    e->key = malloc(key_len);
+    if (!e->key) {
+        e->next = c->free_head;
+        c->free_head = id;
+        return -1;
+    }
+    memcpy(e->key, key, key_len);
+    e->key_len = key_len;
+    e->hash = hash;
+    c->probe = key;
+    c->probe_len = key_len;
+    if (hash_index_insert(&c->index, hash, id, &key_eq, &entry_hash, c)
+        == HASH_INDEX_NONE) {
+        free(e->key);
+        e->key = NULL;
+        e->next = c->free_head;
+        c->free_head = id;
+        return -1;
+    }
+    __atomic_add_fetch(&obj->refs, 1, __ATOMIC_RELAXED);
+    e->obj = obj;
+    push_front(c, id);
+    c->stats.entries++;
+    c->stats.bytes += bytes;
+    return 0;
+}
+
+
+/**
+ * Return the output for one element, from the cache or from the map
+ * function, as an element of an output list. -- private
+ */
+static void* memo_lookup(MemoCache* c, MapDataFn fn, const unsigned char* key,
+    size_t key_len, size_t index) {
+    uint64_t hash = hash_bytes(key, key_len, 0);
+    c->probe = key;
+    c->probe_len = key_len;
+    size_t id = hash_index_find(&c->index, hash, &key_eq, c);
+    MemoObject* obj;
+    void* out = NULL;
+    if (id != MEMO_NONE) {
+        c->stats.hits++;
+        unlink_entry(c, id);
+        push_front(c, id);
+        obj = c->entries[id].obj;
+        if (c->mode == MEMO_SHARED) {
+            __atomic_add_fetch(&obj->refs, 1, __ATOMIC_RELAXED);
+            return obj->data;
+        }
+        out = malloc(c->out_len);
+        if (out) memcpy(out, obj->data, c->out_len);
+        return out;
+    }
+    c->stats.misses++;
+    out = fn(key, index);
+    if (!out) return NULL;
+    obj = malloc(sizeof(MemoObject) + c->out_len);
+    if (!obj) {
+        free(out);
+        return NULL;
+    }
+    // The output list holds the first reference.
+    obj->refs = 1;
+    memcpy(obj->data, out, c->out_len);
+    if (add_entry(c, key, key_len, hash, obj) != 0) {
+        free(out);
+        free(obj);
+        return NULL;
+    }
+    if (c->mode == MEMO_SHARED) {
+        free(out);
+        return obj->data;
+    }
+    // A copy hands the map function's own output to the list.
+    release_object(obj);
+    return out;
+}
+
+
+/**
+ * Free the first n elements of an output list after a failure. -- private
+ */
+static void discard_outputs(MemoCache* c, ObjList out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (c->mode == MEMO_SHARED) memo_release(out[i]);
+        else free(out[i]);
+    }
+    free(out);
+}
+
+
+// Documentation in header file.
+MemoCache* memo_cache_create(MemoMode mode, size_t out_len,
+    size_t max_entries, size_t max_bytes) {
+    if (out_len == 0 || (mode != MEMO_COPY && mode != MEMO_SHARED)) {
+        return NULL;
+    }
+    MemoCache* c = calloc(1, sizeof(MemoCache));
+    if (!c) return NULL;
+    c->mode = mode;
+    c->out_len = out_len;
+    c->max_entries = max_entries;
+    c->max_bytes = max_bytes;
+    c->free_head = MEMO_NONE;
+    c->head = MEMO_NONE;
+    c->tail = MEMO_NONE;
+    return c;
+}
+
+
+// Documentation in header file.
+void memo_cache_clear(MemoCache* cache) {
+    if (cache == NULL) return;
+    while (cache->head != MEMO_NONE) drop_entry(cache, cache->head);
+}
+
+
+// Documentation in header file.
+void memo_cache_destroy(MemoCache* cache) {
+    if (cache == NULL) return;
+    memo_cache_clear(cache);
+    hash_index_free(&cache->index);
+    free(cache->entries);
+    free(cache);
+}
+
+
+// Documentation in header file.
+void memo_cache_stats(const MemoCache* cache, MemoStats* out) {
+    if (out == NULL) return;
+    if (cache == NULL) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    *out = cache->stats;
+}
+
+
+// Documentation in header file.
+ObjList map_data_memo(MapDataFn fn, const void* input, size_t el_len,
+    size_t el_count, MemoCache* cache) {
+    if (input == NULL || fn == NULL || cache == NULL || el_len == 0
+        || el_count == 0) {
+        return NULL;
+    }
+    ObjList out = malloc(sizeof(void*) * (el_count + 1));
+    if (out == NULL) return NULL;
+    const unsigned char* ix = input;
+    for (size_t j = 0; j < el_count; j++) {
+        out[j] = memo_lookup(cache, fn, ix + j * el_len, el_len, j);
+        if (out[j] == NULL) {
+            discard_outputs(cache, out, j);
+            return NULL;
+        }
+    }
+    out[el_count] = NULL;
+    return out;
+}
+
+
+// Documentation in header file.
+ObjList map_memo(MapDataFn fn, ObjList input, size_t el_len,
+    MemoCache* cache) {
+    if (input == NULL || input[0] == NULL || fn == NULL || cache == NULL
+        || el_len == 0) {
+        return NULL;
+    }
+    size_t n = 0;
+    while (input[n] != NULL) n++;
+    ObjList out = malloc(sizeof(void*) * (n + 1));
+    if (out == NULL) return NULL;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = memo_lookup(cache, fn, input[i], el_len, i);
+        if (out[i] == NULL) {
+            discard_outputs(cache, out, i);
+            return NULL;
+        }
+    }
+    out[n] = NULL;
+    return out;
+}
+
+
+// Documentation in header file.
+void memo_release(void* obj) {
+    if (obj == NULL) return;
+    release_object((MemoObject*)((unsigned char*)obj
+        - offsetof(MemoObject, data)));
+}
+
+
+// Documentation in header file.
+void memo_free_list(ObjList list) {
+    if (list == NULL) return;
+    for (size_t i = 0; list[i] != NULL; i++) memo_release(list[i]);
+    free(list);
+}
+
+
+#ifdef TEST
+static int calls = 0;
+
+void* parse_square(const void* elem, size_t _) {
+    calls++;
+    long* out = malloc(sizeof(long));
+    *out = (long)*(const int*)elem * *(const int*)elem;
+    return out;
+}
+
+void* pack_pair(const void* elem, size_t _) {
+    calls++;
+    const char* s = elem;
+    long* out = malloc(sizeof(long));
+    *out = s[0] * 256 + s[1];
+    return out;
+}
+
+void* fail_on_seven(const void* elem, size_t _) {
+    if (*(const int*)elem == 7) return NULL;
+    return parse_square(elem, _);
+}
+
+void test_map_data_memo() {
+    MemoCache* cache = memo_cache_create(MEMO_COPY, sizeof(long), 0, 0);
+    int input[] = { 3, 4, 3, 3, 5, 4 };
+    calls = 0;
+    ObjList out = map_data_memo(&parse_square, input, sizeof(int), 6, cache);
+    assert(calls == 3);
+    long expected[] = { 9, 16, 9, 9, 25, 16 };
+    for (int i = 0; i < 6; i++) assert(*(long*)out[i] == expected[i]);
+    assert(out[6] == NULL);
+    // Every element owns its copy.
+    assert(out[0] != out[2]);
+    free_list(out, 0);
+
+    // The cache stays warm across calls.
+    out = map_data_memo(&parse_square, input, sizeof(int), 6, cache);
+    assert(calls == 3);
+    free_list(out, 0);
+    MemoStats st;
+    memo_cache_stats(cache, &st);
+    assert(st.hits == 9 && st.misses == 3 && st.entries == 3);
+    assert(st.evictions == 0 && st.bytes > 3 * (sizeof(int) + sizeof(long)));
+
+    int bad[] = { 1, 7 };
+    assert(map_data_memo(&fail_on_seven, bad, sizeof(int), 2, cache) == NULL);
+    memo_cache_clear(cache);
+    memo_cache_stats(cache, &st);
+    assert(st.entries == 0 && st.bytes == 0 && st.misses == 5);
+    memo_cache_destroy(cache);
+}
+
+void test_memo_lru() {
+    MemoCache* cache = memo_cache_create(MEMO_COPY, sizeof(long), 2, 0);
+    int input[] = { 1, 2, 1, 3, 2 };
+    calls = 0;
+    // 1 and 2 are cached, 1 is used again, so 3 evicts 2, which misses.
+    ObjList out = map_data_memo(&parse_square, input, sizeof(int), 5, cache);
+    assert(calls == 4);
+    free_list(out, 0);
+    MemoStats st;
+    memo_cache_stats(cache, &st);
+    assert(st.entries == 2 && st.evictions == 2);
+    memo_cache_destroy(cache);
+
+    // A byte limit of one entry keeps only the last output.
+    MemoCache* one = memo_cache_create(MEMO_COPY, sizeof(long), 0, 0);
+    out = map_data_memo(&parse_square, input, sizeof(int), 1, one);
+    memo_cache_stats(one, &st);
+    free_list(out, 0);
+    memo_cache_destroy(one);
+    size_t entry = st.bytes;
+    cache = memo_cache_create(MEMO_COPY, sizeof(long), 0, entry);
+    calls = 0;
+    out = map_data_memo(&parse_square, input, sizeof(int), 5, cache);
+    assert(calls == 5);
+    free_list(out, 0);
+    memo_cache_stats(cache, &st);
+    assert(st.entries == 1 && st.bytes == entry);
+    memo_cache_destroy(cache);
+
+    // An entry larger than the limit is not cached.
+    cache = memo_cache_create(MEMO_COPY, sizeof(long), 0, 1);
+    out = map_data_memo(&parse_square, input, sizeof(int), 5, cache);
+    free_list(out, 0);
+    memo_cache_stats(cache, &st);
+    assert(st.entries == 0 && st.misses == 5);
+    memo_cache_destroy(cache);
+}
+
+void test_memo_shared() {
+    MemoCache* cache = memo_cache_create(MEMO_SHARED, sizeof(long), 1, 0);
+    int input[] = { 6, 6, 2 };
+    ObjList out = map_data_memo(&parse_square, input, sizeof(int), 3, cache);
+    assert(out[0] == out[1] && *(long*)out[0] == 36 && *(long*)out[2] == 4);
+    // 36 was evicted by 4 but is still held by the list.
+    MemoStats st;
+    memo_cache_stats(cache, &st);
+    assert(st.evictions == 1);
+    memo_cache_destroy(cache);
+    assert(*(long*)out[1] == 36);
+    memo_free_list(out);
+
+    char* words[] = { "ab", "cd", "ab", NULL };
+    cache = memo_cache_create(MEMO_SHARED, sizeof(long), 0, 0);
+    calls = 0;
+    out = map_memo(&pack_pair, (ObjList)words, 2, cache);
+    assert(calls == 2 && out[0] == out[2] && out[3] == NULL);
+    assert(*(long*)out[1] == 'c' * 256 + 'd');
+    memo_free_list(out);
+    memo_cache_destroy(cache);
+    assert(memo_cache_create(MEMO_COPY, 0, 0, 0) == NULL);
+}
+
+int main() {
+    test_map_data_memo();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_map_data_memo", "Passed");
+    test_memo_lru();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_memo_lru", "Passed");
+    test_memo_shared();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_memo_shared", "Passed");
+    return 0;
+}
+
+#endif // TEST
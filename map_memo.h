@@ -0,0 +1,151 @@
+/**
+ * Memoized map with a bounded LRU cache. (Header file)
+ *
+ * map_data() calls its map function once per element, even when the same
+ * element occurs many times. The memoized maps look every element up in a
+ * MemoCache first, keyed by its el_len bytes, and only call the map
+ * function on a miss. The cache keeps the most recently used outputs up to
+ * a number of entries and a number of bytes, evicting the least recently
+ * used ones, and lives across calls so that it stays warm between batches.
+ *
+ * The map function must be pure: its output may only depend on the bytes
+ * of the element, not on its index or on any other state. Its outputs must
+ * all be out_len bytes long.
+ *
+ * Depending on the mode of the cache, the output list holds copies of the
+ * cached outputs, to be freed with free_list() as with map_data(), or
+ * shared references to them, to be released with memo_free_list(). Shared
+ * outputs stay valid after they are evicted, until they are released.
+ *
+ * A cache is not thread safe: a cache must only be used by one call at a
+ * time. Shared outputs may be released from any thread.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _MAP_MEMO_H_
+#define _MAP_MEMO_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "functools.h"
+
+/**
+ * A cache of the outputs of a map function.
+ */
+typedef struct MemoCache MemoCache;
+
+/**
+ * How a memoized map returns the cached outputs.
+ */
+typedef enum {
+    MEMO_COPY,   // a copy of the output per element, freed with free_list()
+    MEMO_SHARED  // a shared reference, released with memo_free_list()
+} MemoMode;
+
+/**
+ * The counters of a cache.
+ *
+ * @param hits The number of elements whose output was in the cache.
+ * @param misses The number of elements that called the map function.
+ * @param evictions The number of outputs evicted to make room.
+ * @param entries The number of outputs in the cache.
+ * @param bytes The memory used by the entries, including their keys and
+ * bookkeeping.
+ */
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t entries;
+    size_t bytes;
+} MemoStats;
+
+
+/**
+ * Create a cache.
+ *
+ * @param mode How the outputs are returned.
+ * @param out_len The length of the outputs of the map function.
+ * @param max_entries The maximum number of entries, zero for no limit.
+ * @param max_bytes The maximum memory used by the entries, zero for no
+ * limit. An output whose entry alone would exceed it is not cached.
+ * @return The cache, or NULL on invalid input or allocation failure.
+ */
+MemoCache* memo_cache_create(MemoMode mode, size_t out_len,
+    size_t max_entries, size_t max_bytes);
+
+/**
+ * Free a cache and its entries. Shared outputs still referenced by output
+ * lists stay valid until they are released.
+ *
+ * @param cache The cache.
+ */
+void memo_cache_destroy(MemoCache* cache);
+
+/**
+ * Remove all the entries of a cache. The counters are kept.
+ *
+ * @param cache The cache.
+ */
+void memo_cache_clear(MemoCache* cache);
+
+/**
+ * Read the counters of a cache.
+ *
+ * @param cache The cache.
+ * @param out Receives the counters.
+ */
+void memo_cache_stats(const MemoCache* cache, MemoStats* out);
+
+
+/**
+ * Map an array of elements, calling the map function only for elements
+ * whose output is not in the cache. See map_data().
+ *
+ * @param fn The map function. It is passed the index of the element that
+ * missed, and must return a pointer to out_len bytes allocated with
+ * malloc(), which the cache takes over.
+ * @param input The input array.
+ * @param el_len The length of each element, and of the cache keys.
+ * @param el_count The number of elements.
+ * @param cache The cache.
+ * @return A pointer to the mapped array of objects. The last element is
+ * NULL. NULL on invalid input, allocation failure, or if fn returns NULL.
+ *
+ * @note The returned array must be freed by the caller with free_list() in
+ * MEMO_COPY mode, or with memo_free_list() in MEMO_SHARED mode.
+ */
+ObjList map_data_memo(MapDataFn fn, const void* input, size_t el_len,
+    size_t el_count, MemoCache* cache);
+
+/**
+ * Map a list of objects, calling the map function only for objects whose
+ * output is not in the cache. The objects are keyed by their first el_len
+ * bytes. See map().
+ *
+ * @see map_data_memo()
+ */
+ObjList map_memo(MapDataFn fn, ObjList input, size_t el_len,
+    MemoCache* cache);
+
+/**
+ * Release a shared output.
+ *
+ * @param obj The output, from a MEMO_SHARED output list.
+ */
+void memo_release(void* obj);
+
+/**
+ * Release the outputs of a MEMO_SHARED output list and free the list.
+ *
+ * @param list The list.
+ */
+void memo_free_list(ObjList list);
+
+
+#endif // _MAP_MEMO_H_
@@ -0,0 +1,591 @@
+/**
+ * Parallel map, filter and reduce over arrays.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "parallel.h"
+#ifdef TEST
+#include <assert.h>
+#include <stdio.h>
+#endif
+
+#define PAR_DEFAULT_GRAIN 4096
+#define PAR_CHUNKS_PER_THREAD 8
+
+
+//
+// Private classes - not exposed in the header
+//
+/**
+ * A range of task indices owned by one thread. The owner takes tasks from
+ * the front, thieves take them from the back.
+ * @param lock Guards lo and hi.
+ * @param lo The next task of the owner.
+ * @param hi One past the last task of the queue.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    size_t lo;
+    size_t hi;
+} TaskQueue;
+
+/**
+ * The start argument of a worker thread.
+ * @param pool The pool the worker belongs to.
+ * @param index The index of the worker's queue.
+ */
+typedef struct {
+    WorkerPool* pool;
+    size_t index;
+} WorkerSlot;
+
+struct WorkerPool {
+    pthread_mutex_t run_lock; // serializes worker_pool_run()
+    pthread_mutex_t lock;     // guards the fields below
+    pthread_cond_t wake;      // a new job was posted, or the pool stops
+    pthread_cond_t done;      // a job finished, or a worker left it
+    pthread_t* threads;
+    WorkerSlot* slots;
+    size_t n_threads;         // worker threads, not counting the caller
+    TaskQueue* queues;        // n_threads + 1, the last is the caller's
+    WorkerTaskFn fn;
+    void* arg;
+    size_t remaining;         // tasks of the current job not finished yet
+    size_t active;            // workers inside the current job
+    unsigned long generation; // incremented for every job
+    int stop;
+};
+
+
+/**
+ * Take the next task for a thread, stealing if its own queue is empty.
+ * -- private
+ */
+static int take_task(WorkerPool* pool, size_t self, size_t* task) {
+    size_t n = pool->n_threads + 1;
+    TaskQueue* q = &pool->queues[self];
+    pthread_mutex_lock(&q->lock);
+    if (q->lo < q->hi) {
+        *task = q->lo++;
+        pthread_mutex_unlock(&q->lock);
+        return 1;
+    }
+    pthread_mutex_unlock(&q->lock);
+    for (size_t off = 1; off < n; off++) {
+        q = &pool->queues[(self + off) % n];
+        pthread_mutex_lock(&q->lock);
+        if (q->lo < q->hi) {
+            *task = --q->hi;
+            pthread_mutex_unlock(&q->lock);
+            return 1;
+        }
+        pthread_mutex_unlock(&q->lock);
+    }
+    return 0;
+}
+
+
+/**
+ * Run tasks until every queue is empty. -- private
+ *
+ * @return The number of tasks run.
+ */
+static size_t participate(WorkerPool* pool, size_t self, WorkerTaskFn fn,
+    void* arg) {
+    size_t task, finished = 0;
+    while (take_task(pool, self, &task)) {
+        fn(arg, task);
+        finished++;
+    }
+    return finished;
+}
+
+
+/**
+ * The main loop of a worker thread. -- private
+ */
+static void* worker_main(void* slot_arg) {
+    WorkerSlot* slot = slot_arg;
+    WorkerPool* pool = slot->pool;
+    pthread_mutex_lock(&pool->lock);
+    unsigned long seen = pool->generation;
+    for (;;) {
+        while (!pool->stop && pool->generation == seen) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stop) break;
+        seen = pool->generation;
+        WorkerTaskFn fn = pool->fn;
+        void* arg = pool->arg;
+        pool->active++;
+        pthread_mutex_unlock(&pool->lock);
+        size_t finished = participate(pool, slot->index, fn, arg);
+        pthread_mutex_lock(&pool->lock);
+        pool->remaining -= finished;
+        pool->active--;
+        if (pool->remaining == 0 || pool->active == 0) {
+            pthread_cond_broadcast(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+
+// Documentation in header file.
+WorkerPool* worker_pool_create(size_t threads) {
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (size_t)cpus : 1;
+    }
+    WorkerPool* pool = calloc(1, sizeof(WorkerPool));
+    if (!pool) return NULL;
+    pool->n_threads = threads - 1;
+    pool->threads = calloc(threads, sizeof(pthread_t));
+    pool->slots = calloc(threads, sizeof(WorkerSlot));
+    pool->queues = calloc(threads, sizeof(TaskQueue));
+    if (!pool->threads || !pool->slots || !pool->queues) {
+        free(pool->threads);
+        free(pool->slots);
+        free(pool->queues);
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->run_lock, NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    for (size_t i = 0; i < threads; i++) {
+        pthread_mutex_init(&pool->queues[i].lock, NULL);
+    }
+    for (size_t i = 0; i < pool->n_threads; i++) {
+        pool->slots[i].pool = pool;
+        pool->slots[i].index = i;
+        if (pthread_create(&pool->threads[i], NULL, worker_main,
+            &pool->slots[i]) != 0) {
+            // Run with the threads that did start.
+            pool->n_threads = i;
+            break;
+        }
+    }
+    return pool;
+}
+
+
+// Documentation in header file.
+void worker_pool_destroy(WorkerPool* pool) {
+    if (!pool) return;
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 0; i < pool->n_threads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    for (size_t i = 0; i < pool->n_threads + 1; i++) {
+        pthread_mutex_destroy(&pool->queues[i].lock);
+    }
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->run_lock);
+    free(pool->threads);
+    free(pool->slots);
+    free(pool->queues);
+    free(pool);
+}
+
+
+static WorkerPool* default_pool = NULL;
+static pthread_once_t default_pool_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Create the shared default pool. -- private
+ */
+static void default_pool_init(void) {
+    default_pool = worker_pool_create(0);
+}
+
+
+// Documentation in header file.
+WorkerPool* worker_pool_default(void) {
+    pthread_once(&default_pool_once, default_pool_init);
+    return default_pool;
+}
+
+
+// Documentation in header file.
+size_t worker_pool_size(const WorkerPool* pool) {
+    return pool ? pool->n_threads + 1 : 0;
+}
+
+
+// Documentation in header file.
+void worker_pool_run(WorkerPool* pool, WorkerTaskFn fn, void* arg,
+    size_t n_tasks) {
+    if (!pool || !fn || n_tasks == 0) return;
+    size_t n = pool->n_threads + 1;
+    size_t self = pool->n_threads;
+    pthread_mutex_lock(&pool->run_lock);
+    pthread_mutex_lock(&pool->lock);
+    // Workers still draining the previous job would otherwise see the
+    // queues of this job with the task function of the previous one.
+    while (pool->active > 0) pthread_cond_wait(&pool->done, &pool->lock);
+    for (size_t i = 0; i < n; i++) {
+        pool->queues[i].lo = n_tasks * i / n;
+        pool->queues[i].hi = n_tasks * (i + 1) / n;
+    }
+    pool->fn = fn;
+    pool->arg = arg;
+    pool->remaining = n_tasks;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    size_t finished = participate(pool, self, fn, arg);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->remaining -= finished;
+    while (pool->remaining > 0) pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->run_lock);
+}
+
+
+/**
+ * The shape of a parallel run over an array.
+ * @param input The input array.
+ * @param el_len The length of each element.
+ * @param el_count The number of elements.
+ * @param chunk The number of elements per chunk.
+ * @param n_chunks The number of chunks.
+ */
+typedef struct {
+    const unsigned char* input;
+    size_t el_len;
+    size_t el_count;
+    size_t chunk;
+    size_t n_chunks;
+} ChunkPlan;
+
+
+/**
+ * Pick the pool and the chunk size for an input. -- private
+ *
+ * @return The pool to run on, or NULL if the input should run serially.
+ */
+static WorkerPool* plan_chunks(const ParallelOpts* opts, const void* input,
+    size_t el_len, size_t el_count, ChunkPlan* plan) {
+    WorkerPool* pool = opts && opts->pool ? opts->pool : worker_pool_default();
+    size_t grain = opts && opts->grain ? opts->grain : PAR_DEFAULT_GRAIN;
+    size_t threads = worker_pool_size(pool);
+    if (threads < 2 || el_count < 2 * grain) return NULL;
+    // Several chunks per thread leave room for stealing.
+    size_t chunk = el_count / (threads * PAR_CHUNKS_PER_THREAD);
+    if (chunk < grain) chunk = grain;
+    plan->input = input;
+    plan->el_len = el_len;
+    plan->el_count = el_count;
+    plan->chunk = chunk;
+    plan->n_chunks = (el_count + chunk - 1) / chunk;
+    return pool;
+}
+
+
+/**
+ * The state of a parallel map. -- private
+ */
+typedef struct {
+    ChunkPlan plan;
+    MapDataFn fn;
+    ObjList out;
+} MapJob;
+
+
+/**
+ * Map one chunk. -- private
+ */
+static void map_task(void* arg, size_t task) {
+    MapJob* job = arg;
+    size_t j = task * job->plan.chunk;
+    size_t end = j + job->plan.chunk;
+    if (end > job->plan.el_count) end = job->plan.el_count;
+    for (; j < end; j++) {
+        job->out[j] = job->fn(&job->plan.input[j * job->plan.el_len], j);
+    }
+}
+
+
+// Documentation in header file.
+ObjList map_data_par(MapDataFn fn, const void* input, size_t el_len,
+    size_t el_count, const ParallelOpts* opts) {
+    if (input == NULL || fn == NULL || el_len == 0 || el_count == 0) {
+        return NULL;
+    }
+    MapJob job = { .fn = fn };
+    WorkerPool* pool = plan_chunks(opts, input, el_len, el_count, &job.plan);
+    if (!pool) return map_data(fn, input, el_len, el_count);
+    job.out = malloc(sizeof(void*) * (el_count + 1));
+    if (!job.out) return NULL;
+    worker_pool_run(pool, map_task, &job, job.plan.n_chunks);
+    job.out[el_count] = NULL;
+    return job.out;
+}
+
+
+/**
+ * The state of a parallel filter. Each chunk fills its own list, and the
+ * lists are stitched together in chunk order afterwards. -- private
+ */
+typedef struct {
+    ChunkPlan plan;
+    FilterDataFn fn;
+    ObjList* parts;
+    size_t* counts;
+    int failed;
+} FilterJob;
+
+
+/**
+ * Filter one chunk. -- private
+ */
+static void filter_task(void* arg, size_t task) {
+    FilterJob* job = arg;
+    size_t el_len = job->plan.el_len;
+    size_t j = task * job->plan.chunk;
+    size_t end = j + job->plan.chunk;
+    if (end > job->plan.el_count) end = job->plan.el_count;
+    ObjList part = NULL;
+    size_t k = 0, cap = 0;
+    for (; j < end; j++) {
+        const unsigned char* el = &job->plan.input[j * el_len];
+        if (!job->fn(el, j)) continue;
+        if (k == cap) {
+            cap = cap ? cap * 2 : 16;
+            ObjList tmp = realloc(part, sizeof(void*) * cap);
+            if (!tmp) {
+                __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+                break;
+            }
+            part = tmp;
+        }
+        part[k] = malloc(el_len);
+        if (!part[k]) {
+            __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+            break;
+        }
+        memcpy(part[k], el, el_len);
+        k++;
+    }
+    job->parts[task] = part;
+    job->counts[task] = k;
+}
+
+
+// Documentation in header file.
+ObjList filter_data_par(FilterDataFn fn, const void* input, size_t el_len,
+    size_t el_count, const ParallelOpts* opts) {
+    if (input == NULL || fn == NULL || el_len == 0 || el_count == 0) {
+        return NULL;
+    }
+    FilterJob job = { .fn = fn };
+    WorkerPool* pool = plan_chunks(opts, input, el_len, el_count, &job.plan);
+    if (!pool) return filter_data(fn, input, el_len, el_count);
+    job.parts = calloc(job.plan.n_chunks, sizeof(ObjList));
+    job.counts = calloc(job.plan.n_chunks, sizeof(size_t));
+    ObjList out = NULL;
+    if (job.parts && job.counts) {
+        worker_pool_run(pool, filter_task, &job, job.plan.n_chunks);
+        size_t total = 0;
+        for (size_t c = 0; c < job.plan.n_chunks; c++) total += job.counts[c];
+        if (!job.failed) out = malloc(sizeof(void*) * (total + 1));
+        if (out) {
+            size_t k = 0;
+            for (size_t c = 0; c < job.plan.n_chunks; c++) {
+                memcpy(&out[k], job.parts[c], sizeof(void*) * job.counts[c]);
+                k += job.counts[c];
+            }
+            out[k] = NULL;
+        } else {
+            for (size_t c = 0; c < job.plan.n_chunks; c++) {
+                for (size_t k = 0; k < job.counts[c]; k++) {
+                    free(job.parts[c][k]);
+                }
+            }
+        }
+        for (size_t c = 0; c < job.plan.n_chunks; c++) free(job.parts[c]);
+    }
+    free(job.parts);
+    free(job.counts);
+    return out;
+}
+
+
+/**
+ * The state of a parallel reduce. -- private
+ */
+typedef struct {
+    ChunkPlan plan;
+    ReduceDataFn fn;
+    void** partials;
+} ReduceJob;
+
+
+/**
+ * Reduce one chunk. The first chunk starts from the caller's initial value,
+ * which is stored in partials[0] beforehand. -- private
+ */
+static void reduce_task(void* arg, size_t task) {
+    ReduceJob* job = arg;
+    size_t j = task * job->plan.chunk;
+    size_t end = j + job->plan.chunk;
+    if (end > job->plan.el_count) end = job->plan.el_count;
+    void* acc = job->partials[task];
+    for (; j < end; j++) {
+        void* tmp = job->fn(acc, &job->plan.input[j * job->plan.el_len], j);
+        free(acc);
+        acc = tmp;
+    }
+    job->partials[task] = acc;
+}
+
+
+// Documentation in header file.
+void* reduce_data_par(ReduceDataFn fn, CombineDataFn combine,
+    const void* input, size_t el_len, size_t el_count, void* init,
+    const ParallelOpts* opts) {
+    if (input == NULL || fn == NULL || combine == NULL || el_len == 0
+        || el_count == 0) {
+        return NULL;
+    }
+    ReduceJob job = { .fn = fn };
+    WorkerPool* pool = plan_chunks(opts, input, el_len, el_count, &job.plan);
+    if (!pool) return reduce_data(fn, input, el_len, el_count, init);
+    job.partials = calloc(job.plan.n_chunks, sizeof(void*));
+    // The serial path still consumes init, as every other path does.
+    if (!job.partials) return reduce_data(fn, input, el_len, el_count, init);
+    job.partials[0] = init;
+    worker_pool_run(pool, reduce_task, &job, job.plan.n_chunks);
+    void* acc = job.partials[0];
+    for (size_t c = 1; c < job.plan.n_chunks; c++) {
+        void* tmp = combine(acc, job.partials[c]);
+        free(acc);
+        free(job.partials[c]);
+        acc = tmp;
+    }
+    free(job.partials);
+    return acc;
+}
+
+
+#ifdef TEST
+int is_even(const void* ii, size_t _) {
+    const int* i = ii;
+    return *i % 2 == 0;
+}
+
+void* square(const void* ii, size_t _) {
+    const int* i = ii;
+    long* out = malloc(sizeof(long));
+    *out = (long)*i * *i;
+    return out;
+}
+
+void* sum(const void* prev, const void* elem, size_t _) {
+    const long zero = 0;
+    const long* p = prev ? prev : &zero;
+    const int* e = elem;
+    long* out = malloc(sizeof(long));
+    *out = *p + *e;
+    return out;
+}
+
+void* add(const void* a, const void* b) {
+    const long zero = 0;
+    const long* x = a ? a : &zero;
+    const long* y = b ? b : &zero;
+    long* out = malloc(sizeof(long));
+    *out = *x + *y;
+    return out;
+}
+
+void count_task(void* arg, size_t task) {
+    int* hits = arg;
+    __atomic_add_fetch(&hits[task], 1, __ATOMIC_RELAXED);
+}
+
+void test_worker_pool() {
+    WorkerPool* pool = worker_pool_create(4);
+    assert(worker_pool_size(pool) == 4);
+    int hits[1000] = { 0 };
+    for (int round = 0; round < 20; round++) {
+        worker_pool_run(pool, count_task, hits, 1000);
+    }
+    for (int i = 0; i < 1000; i++) assert(hits[i] == 20);
+    worker_pool_destroy(pool);
+    assert(worker_pool_default() == worker_pool_default());
+}
+
+void test_map_data_par() {
+    WorkerPool* pool = worker_pool_create(4);
+    ParallelOpts opts = { .pool = pool, .grain = 64 };
+    int input[10000];
+    for (int i = 0; i < 10000; i++) input[i] = i;
+    long** output = (long**)map_data_par(&square, input, sizeof(int), 10000, &opts);
+    for (int i = 0; i < 10000; i++) assert(*output[i] == (long)i * i);
+    assert(output[10000] == NULL);
+    free_list((ObjList)output, 0);
+    // Small inputs run serially.
+    output = (long**)map_data_par(&square, input, sizeof(int), 10, &opts);
+    assert(*output[9] == 81 && output[10] == NULL);
+    free_list((ObjList)output, 0);
+    worker_pool_destroy(pool);
+}
+
+void test_filter_data_par() {
+    WorkerPool* pool = worker_pool_create(3);
+    ParallelOpts opts = { .pool = pool, .grain = 100 };
+    int input[10001];
+    for (int i = 0; i < 10001; i++) input[i] = i;
+    int** output = (int**)filter_data_par(&is_even, input, sizeof(int), 10001, &opts);
+    for (int i = 0; i <= 5000; i++) assert(*output[i] == i * 2);
+    assert(output[5001] == NULL);
+    free_list((ObjList)output, 0);
+    worker_pool_destroy(pool);
+}
+
+void test_reduce_data_par() {
+    WorkerPool* pool = worker_pool_create(4);
+    ParallelOpts opts = { .pool = pool, .grain = 50 };
+    int input[10000];
+    for (int i = 0; i < 10000; i++) input[i] = i;
+    long* init = malloc(sizeof(long));
+    *init = 7;
+    long* output = reduce_data_par(&sum, &add, input, sizeof(int), 10000, init, &opts);
+    assert(*output == 7 + 9999L * 10000 / 2);
+    free(output);
+    worker_pool_destroy(pool);
+}
+
+int main() {
+    test_worker_pool();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_worker_pool", "Passed");
+    test_map_data_par();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_map_data_par", "Passed");
+    test_filter_data_par();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_filter_data_par", "Passed");
+    test_reduce_data_par();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_reduce_data_par", "Passed");
+    return 0;
+}
+
+#endif // TEST
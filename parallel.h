@@ -0,0 +1,147 @@
+/**
+ * Parallel map, filter and reduce over arrays. (Header file)
+ *
+ * The parallel functions split the input array into chunks that run on a
+ * persistent pool of threads. Each participating thread owns a queue of
+ * chunks and steals chunks from the other queues once its own queue is
+ * empty, so uneven callback costs balance out.
+ *
+ * Callbacks run concurrently and must be thread safe.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+#include <stdlib.h>
+#include "functools.h"
+
+/**
+ * A persistent pool of worker threads.
+ */
+typedef struct WorkerPool WorkerPool;
+
+/**
+ * Function type for pool tasks.
+ *
+ * @param arg The argument given to worker_pool_run().
+ * @param task The index of the task, from 0 to n_tasks - 1.
+ */
+typedef void (*WorkerTaskFn)(void* arg, size_t task);
+
+/**
+ * Function type for combining two partial reductions.
+ *
+ * The function must be associative. Either argument may be NULL when a
+ * chunk produced no value.
+ *
+ * @param a The partial reduction of the earlier elements.
+ * @param b The partial reduction of the later elements.
+ * @return A pointer to the combined value, allocated with malloc().
+ */
+typedef void* (*CombineDataFn)(const void* a, const void* b);
+
+/**
+ * Options for the parallel functions.
+ *
+ * @param pool The pool to run on. NULL selects the shared default pool.
+ * @param grain The minimum number of elements per chunk. Zero selects a
+ * default of 4096. Inputs shorter than two chunks run serially.
+ */
+typedef struct {
+    WorkerPool* pool;
+    size_t grain;
+} ParallelOpts;
+
+
+/**
+ * Create a pool of threads.
+ *
+ * @param threads The number of threads that run tasks, counting the thread
+ * that calls worker_pool_run(). Zero selects the number of online CPUs.
+ * @return The pool, or NULL on failure.
+ */
+WorkerPool* worker_pool_create(size_t threads);
+
+/**
+ * Stop the threads of a pool and free it.
+ *
+ * @param pool The pool.
+ */
+void worker_pool_destroy(WorkerPool* pool);
+
+/**
+ * Return the shared default pool, creating it on first use with one thread
+ * per online CPU. The default pool lives until the program exits.
+ *
+ * @return The pool, or NULL on failure.
+ */
+WorkerPool* worker_pool_default(void);
+
+/**
+ * Return the number of threads that run tasks, counting the caller.
+ *
+ * @param pool The pool.
+ */
+size_t worker_pool_size(const WorkerPool* pool);
+
+/**
+ * Run n_tasks tasks on a pool and wait for all of them to finish. The
+ * calling thread runs tasks as well. Runs on the same pool are serialized,
+ * so a task must not call worker_pool_run() on its own pool.
+ *
+ * @param pool The pool.
+ * @param fn The task function.
+ * @param arg The argument passed to every task.
+ * @param n_tasks The number of tasks.
+ */
+void worker_pool_run(WorkerPool* pool, WorkerTaskFn fn, void* arg,
+    size_t n_tasks);
+
+
+/**
+ * Map an array of elements in parallel. See map_data().
+ *
+ * @param opts The parallel options, NULL for the defaults.
+ */
+ObjList map_data_par(MapDataFn fn, const void* input, size_t el_len,
+    size_t el_count, const ParallelOpts* opts);
+
+/**
+ * Filter an array of elements in parallel. See filter_data(). The output
+ * keeps the order of the input.
+ *
+ * @param opts The parallel options, NULL for the defaults.
+ */
+ObjList filter_data_par(FilterDataFn fn, const void* input, size_t el_len,
+    size_t el_count, const ParallelOpts* opts);
+
+/**
+ * Reduce an array of elements in parallel. See reduce_data().
+ *
+ * Each chunk is reduced on its own, the first chunk starting from init and
+ * the others from NULL, so fn must accept a NULL accumulator. The partial
+ * results are then merged in input order with the combine function.
+ *
+ * @param fn The reduce function.
+ * @param combine The associative function merging two partial results.
+ * @param input The input array.
+ * @param el_len The length of each element.
+ * @param el_count The number of elements.
+ * @param init The initial value of the accumulator.
+ * @param opts The parallel options, NULL for the defaults.
+ * @return A pointer to the reduced value.
+ *
+ * @note The returned value must be freed by the caller.
+ */
+void* reduce_data_par(ReduceDataFn fn, CombineDataFn combine,
+    const void* input, size_t el_len, size_t el_count, void* init,
+    const ParallelOpts* opts);
+
+
+#endif // _PARALLEL_H_
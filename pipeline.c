@@ -0,0 +1,430 @@
+/**
+ * Fused lazy pipelines.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "pipeline.h"
+#ifdef TEST
+#include <assert.h>
+#include <stdio.h>
+#endif
+
+
+//
+// Private classes - not exposed in the header
+//
+/**
+ * The kinds of pipeline stages.
+ */
+typedef enum { STAGE_FILTER, STAGE_MAP, STAGE_TAKE } StageKind;
+
+/**
+ * A pipeline stage.
+ * @param kind The kind of the stage.
+ * @param filter The filter function of a STAGE_FILTER.
+ * @param map The map function of a STAGE_MAP.
+ * @param limit The number of elements a STAGE_TAKE lets through.
+ * @param seen The number of elements that entered the stage in this run.
+ */
+typedef struct {
+    StageKind kind;
+    FilterDataFn filter;
+    MapDataFn map;
+    size_t limit;
+    size_t seen;
+} Stage;
+
+struct Pipeline {
+    const unsigned char* data; // array source, or NULL
+    size_t el_len;
+    size_t el_count;
+    ObjList list;              // list source, or NULL
+    Stage* stages;
+    size_t n_stages;
+    size_t cap_stages;
+};
+
+/**
+ * Receives the elements that reach the end of a pipeline.
+ * @param ctx The sink state.
+ * @param elem The element.
+ * @param owned 1 if the element was made by a map stage and the sink now
+ * owns it, 0 if it belongs to the source.
+ * @param index The index of the element in the output.
+ * @return 0 to continue, non-zero to abort the run.
+ */
+typedef int (*SinkFn)(void* ctx, void* elem, int owned, size_t index);
+
+
+// Documentation in header file.
+Pipeline* pipeline_from_data(const void* input, size_t el_len, size_t el_count) {
+    if (input == NULL || el_len == 0) return NULL;
+    Pipeline* p = calloc(1, sizeof(Pipeline));
+    if (!p) return NULL;
+    p->data = input;
+    p->el_len = el_len;
+    p->el_count = el_count;
+    return p;
+}
+
+
+// Documentation in header file.
+Pipeline* pipeline_from_list(ObjList input) {
+    if (input == NULL) return NULL;
+    Pipeline* p = calloc(1, sizeof(Pipeline));
+    if (!p) return NULL;
+    p->list = input;
+    return p;
+}
+
+
+/**
+ * Append a stage, freeing the pipeline on failure. -- private
+ */
+static Pipeline* pipeline_push(Pipeline* p, Stage stage) {
+    if (!p) return NULL;
+    if (p->n_stages == p->cap_stages) {
+        size_t cap = p->cap_stages ? p->cap_stages * 2 : 4;
+        Stage* tmp = realloc(p->stages, cap * sizeof(Stage));
+        if (!tmp) {
+            pipeline_free(p);
+            return NULL;
+        }
+        p->stages = tmp;
+        p->cap_stages = cap;
+    }
+    p->stages[p->n_stages++] = stage;
+    return p;
+}
+
+
+// Documentation in header file.
+Pipeline* pipeline_filter(Pipeline* pipeline, FilterDataFn fn) {
+    if (pipeline && !fn) {
+        pipeline_free(pipeline);
+        return NULL;
+    }
+    Stage stage = { .kind = STAGE_FILTER, .filter = fn };
+    return pipeline_push(pipeline, stage);
+}
+
+
+// Documentation in header file.
+Pipeline* pipeline_map(Pipeline* pipeline, MapDataFn fn) {
+    if (pipeline && !fn) {
+        pipeline_free(pipeline);
+        return NULL;
+    }
+    Stage stage = { .kind = STAGE_MAP, .map = fn };
+    return pipeline_push(pipeline, stage);
+}
+
+
+// Documentation in header file.
+Pipeline* pipeline_take(Pipeline* pipeline, size_t n) {
+    Stage stage = { .kind = STAGE_TAKE, .limit = n };
+    return pipeline_push(pipeline, stage);
+}
+
+
+/**
+ * Run a pipeline, feeding each element through all the stages before
+ * reading the next one. -- private
+ *
+ * @return 0 on success, -1 if the sink aborted the run.
+ */
+static int pipeline_run(Pipeline* p, SinkFn sink, void* ctx) {
+    for (size_t s = 0; s < p->n_stages; s++) {
+        p->stages[s].seen = 0;
+        if (p->stages[s].kind == STAGE_TAKE && p->stages[s].limit == 0) {
+            return 0;
+        }
+    }
+    size_t out = 0; // index of the next output element
+    int done = 0;
+    for (size_t j = 0; !done; j++) {
+        void* el;
+        if (p->list) {
+            el = p->list[j];
+            if (el == NULL) break;
+        } else {
+            if (j >= p->el_count) break;
+            el = (void*)&p->data[j * p->el_len];
+        }
+        int owned = 0;
+        int keep = 1;
+        for (size_t s = 0; s < p->n_stages && keep; s++) {
+            Stage* st = &p->stages[s];
+            size_t idx = st->seen++;
+            switch (st->kind) {
+            case STAGE_FILTER:
+                keep = st->filter(el, idx);
+                break;
+            case STAGE_MAP: {
+                void* mapped = st->map(el, idx);
+                if (owned) free(el);
+                el = mapped;
+                owned = 1;
+                break;
+            }
+            case STAGE_TAKE:
+                // Nothing can get past an exhausted take, so the run ends
+                // once the last element it lets through is delivered.
+                if (st->seen == st->limit) done = 1;
+                break;
+            }
+        }
+        if (!keep) {
+            if (owned) free(el);
+            continue;
+        }
+        if (sink(ctx, el, owned, out++) != 0) return -1;
+    }
+    return 0;
+}
+
+
+/**
+ * The state of pipeline_collect(). -- private
+ */
+typedef struct {
+    ObjList out;
+    size_t cap;
+    size_t el_len;  // length of unmapped array elements to copy, or 0
+} CollectSink;
+
+
+/**
+ * Append an element to the output list. -- private
+ */
+static int collect_sink(void* ctx, void* elem, int owned, size_t index) {
+    CollectSink* c = ctx;
+    if (index + 1 >= c->cap) {
+        size_t cap = c->cap ? c->cap * 2 : 16;
+        ObjList tmp = realloc(c->out, cap * sizeof(void*));
+        if (!tmp) {
+            if (owned) free(elem);
+            return -1;
+        }
+        c->out = tmp;
+        c->cap = cap;
+    }
+    if (!owned && c->el_len) {
+        void* copy = malloc(c->el_len);
+        if (!copy) return -1;
+        memcpy(copy, elem, c->el_len);
+        elem = copy;
+    }
+    c->out[index] = elem;
+    c->out[index + 1] = NULL;
+    return 0;
+}
+
+
+// Documentation in header file.
+ObjList pipeline_collect(Pipeline* pipeline) {
+    if (!pipeline) return NULL;
+    CollectSink c = { .out = malloc(16 * sizeof(void*)), .cap = 16,
+        .el_len = pipeline->list ? 0 : pipeline->el_len };
+    if (!c.out) return NULL;
+    c.out[0] = NULL;
+    if (pipeline_run(pipeline, collect_sink, &c) != 0) {
+        // Only copies and mapped objects are owned by the list.
+        int owns_all = !pipeline->list;
+        for (size_t s = 0; s < pipeline->n_stages; s++) {
+            if (pipeline->stages[s].kind == STAGE_MAP) owns_all = 1;
+        }
+        if (owns_all) free_list(c.out, 0);
+        else free(c.out);
+        return NULL;
+    }
+    return c.out;
+}
+
+
+/**
+ * The state of pipeline_reduce(). -- private
+ */
+typedef struct {
+    ReduceDataFn fn;
+    void* acc;
+} ReduceSink;
+
+
+/**
+ * Fold an element into the accumulator. -- private
+ */
+static int reduce_sink(void* ctx, void* elem, int owned, size_t index) {
+    ReduceSink* r = ctx;
+    void* tmp = r->fn(r->acc, elem, index);
+    free(r->acc);
+    r->acc = tmp;
+    if (owned) free(elem);
+    return 0;
+}
+
+
+// Documentation in header file.
+void* pipeline_reduce(Pipeline* pipeline, ReduceDataFn fn, void* init) {
+    if (!pipeline || !fn) return NULL;
+    ReduceSink r = { .fn = fn, .acc = init };
+    pipeline_run(pipeline, reduce_sink, &r);
+    return r.acc;
+}
+
+
+/**
+ * The state of pipeline_reduce_into(). -- private
+ */
+typedef struct {
+    ReduceIntoDataFn fn;
+    void* acc;
+} ReduceIntoSink;
+
+
+/**
+ * Fold an element into the caller's accumulator. -- private
+ */
+static int reduce_into_sink(void* ctx, void* elem, int owned, size_t index) {
+    ReduceIntoSink* r = ctx;
+    r->fn(r->acc, elem, index);
+    if (owned) free(elem);
+    return 0;
+}
+
+
+// Documentation in header file.
+void* pipeline_reduce_into(Pipeline* pipeline, ReduceIntoDataFn fn, void* acc) {
+    if (!pipeline || !fn || !acc) return NULL;
+    ReduceIntoSink r = { .fn = fn, .acc = acc };
+    pipeline_run(pipeline, reduce_into_sink, &r);
+    return acc;
+}
+
+
+// Documentation in header file.
+void pipeline_free(Pipeline* pipeline) {
+    if (!pipeline) return;
+    free(pipeline->stages);
+    free(pipeline);
+}
+
+
+#ifdef TEST
+int is_even(const void* ii, size_t _) {
+    const int* i = ii;
+    return *i % 2 == 0;
+}
+
+int index_below_3(const void* _, size_t index) {
+    return index < 3;
+}
+
+void* cube(const void* ii, size_t _) {
+    const int* i = ii;
+    int* out = malloc(sizeof(int));
+    *out = *i * *i * *i;
+    return out;
+}
+
+void* sum(const void* prev, const void* elem, size_t _) {
+    const int zero = 0;
+    const int* p = prev ? prev : &zero;
+    const int* e = elem;
+    int* out = malloc(sizeof(int));
+    *out = *p + *e;
+    return out;
+}
+
+void sum_into(void* acc, const void* elem, size_t _) {
+    *(int*)acc += *(const int*)elem;
+}
+
+void test_pipeline_collect() {
+    int input[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    Pipeline* p = pipeline_map(pipeline_filter(
+        pipeline_from_data(input, sizeof(int), 8), &is_even), &cube);
+    assert(p);
+    int** output = (int**)pipeline_collect(p);
+    assert(*output[0] == 8);
+    assert(*output[1] == 64);
+    assert(*output[2] == 216);
+    assert(*output[3] == 512);
+    assert(output[4] == NULL);
+    free_list((ObjList)output, 0);
+    // A pipeline can run again.
+    output = (int**)pipeline_collect(p);
+    assert(*output[3] == 512 && output[4] == NULL);
+    free_list((ObjList)output, 0);
+    pipeline_free(p);
+
+    // Unmapped array elements are copied.
+    p = pipeline_take(pipeline_filter(
+        pipeline_from_data(input, sizeof(int), 8), &is_even), 2);
+    output = (int**)pipeline_collect(p);
+    assert(*output[0] == 2 && *output[1] == 4 && output[2] == NULL);
+    assert(output[0] != &input[1]);
+    free_list((ObjList)output, 0);
+    pipeline_free(p);
+
+    // Indices count the elements entering each stage.
+    p = pipeline_filter(pipeline_filter(
+        pipeline_from_data(input, sizeof(int), 8), &is_even), &index_below_3);
+    output = (int**)pipeline_collect(p);
+    assert(*output[0] == 2 && *output[2] == 6 && output[3] == NULL);
+    free_list((ObjList)output, 0);
+    pipeline_free(p);
+
+    // Take zero yields an empty list.
+    p = pipeline_take(pipeline_from_data(input, sizeof(int), 8), 0);
+    output = (int**)pipeline_collect(p);
+    assert(output[0] == NULL);
+    free(output);
+    pipeline_free(p);
+
+    assert(pipeline_filter(pipeline_from_data(NULL, 4, 1), &is_even) == NULL);
+}
+
+void test_pipeline_list() {
+    int values[] = { 1, 2, 3, 4, 5 };
+    void* input[] = { &values[0], &values[1], &values[2], &values[3],
+        &values[4], NULL };
+    Pipeline* p = pipeline_filter(pipeline_from_list(input), &is_even);
+    void** output = pipeline_collect(p);
+    assert(output[0] == &values[1] && output[1] == &values[3]);
+    assert(output[2] == NULL);
+    free(output); // references into the source
+    pipeline_free(p);
+}
+
+void test_pipeline_reduce() {
+    int input[] = { 1, 2, 3, 4, 5, 6 };
+    Pipeline* p = pipeline_take(pipeline_map(pipeline_filter(
+        pipeline_from_data(input, sizeof(int), 6), &is_even), &cube), 2);
+    int* output = pipeline_reduce(p, &sum, NULL);
+    assert(*output == 8 + 64);
+    free(output);
+    int acc = 0;
+    assert(pipeline_reduce_into(p, &sum_into, &acc) == &acc);
+    assert(acc == 8 + 64);
+    pipeline_free(p);
+}
+
+int main() {
+    test_pipeline_collect();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_pipeline_collect", "Passed");
+    test_pipeline_list();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_pipeline_list", "Passed");
+    test_pipeline_reduce();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_pipeline_reduce", "Passed");
+    return 0;
+}
+
+#endif // TEST
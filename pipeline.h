@@ -0,0 +1,135 @@
+/**
+ * Fused lazy pipelines. (Header file)
+ *
+ * A pipeline records a chain of filter, map and take stages over an array
+ * or a list of objects, and runs all of them in a single pass when it is
+ * collected or reduced. Each element travels through every stage before
+ * the next element is read, so no intermediate lists are built.
+ *
+ * Every callback receives the index of the element in the stream entering
+ * its stage, which is the index it would receive if the stages were run one
+ * after another with filter_data(), map() and so on.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+
+#include <stdlib.h>
+#include "functools.h"
+
+/**
+ * A lazy pipeline.
+ */
+typedef struct Pipeline Pipeline;
+
+
+/**
+ * Start a pipeline over an array of elements.
+ *
+ * @param input The input array. Must outlive the pipeline.
+ * @param el_len The length of each element.
+ * @param el_count The number of elements.
+ * @return The pipeline, or NULL on invalid input or allocation failure.
+ *
+ * @note The pipeline must be freed by the caller with pipeline_free().
+ */
+Pipeline* pipeline_from_data(const void* input, size_t el_len, size_t el_count);
+
+/**
+ * Start a pipeline over a list of objects.
+ *
+ * @param input The input list. Must outlive the pipeline.
+ * @return The pipeline, or NULL on invalid input or allocation failure.
+ *
+ * @note The pipeline must be freed by the caller with pipeline_free().
+ */
+Pipeline* pipeline_from_list(ObjList input);
+
+/**
+ * Append a filter stage.
+ *
+ * The stage functions take and return the pipeline so that calls can be
+ * chained. On failure they free the pipeline and return NULL, and given
+ * NULL they return NULL, so a chain needs only one check at the end.
+ *
+ * @param pipeline The pipeline.
+ * @param fn The filter function. Must return 1 for true, 0 for false.
+ * @return The pipeline, or NULL on failure.
+ */
+Pipeline* pipeline_filter(Pipeline* pipeline, FilterDataFn fn);
+
+/**
+ * Append a map stage. The objects returned by fn are owned by the pipeline
+ * until they reach the end of it; the pipeline frees those consumed by later
+ * stages.
+ *
+ * @param pipeline The pipeline.
+ * @param fn The map function. Must return a pointer to a malloc'ed object.
+ * @return The pipeline, or NULL on failure.
+ */
+Pipeline* pipeline_map(Pipeline* pipeline, MapDataFn fn);
+
+/**
+ * Append a take stage, which lets the first n elements through and ends
+ * the run after that.
+ *
+ * @param pipeline The pipeline.
+ * @param n The number of elements to let through.
+ * @return The pipeline, or NULL on failure.
+ */
+Pipeline* pipeline_take(Pipeline* pipeline, size_t n);
+
+/**
+ * Run a pipeline and collect its output.
+ *
+ * Elements produced by a map stage are returned as they are. Elements that
+ * reach the end unmapped are copied when the source is an array, as in
+ * filter_data(), and returned by reference when the source is a list, as in
+ * filter().
+ *
+ * @param pipeline The pipeline.
+ * @return A pointer to the list of objects. The last element is NULL.
+ *
+ * @note The returned list must be freed by the caller, with free_list()
+ * unless it holds references into a source list.
+ */
+ObjList pipeline_collect(Pipeline* pipeline);
+
+/**
+ * Run a pipeline and reduce its output. See reduce().
+ *
+ * @param pipeline The pipeline.
+ * @param fn The reduce function. Must return a pointer to the reduced value.
+ * @param init The initial value of the accumulator.
+ * @return A pointer to the reduced value.
+ *
+ * @note The returned value must be freed by the caller.
+ */
+void* pipeline_reduce(Pipeline* pipeline, ReduceDataFn fn, void* init);
+
+/**
+ * Run a pipeline and reduce its output into a caller-owned accumulator.
+ * See reduce_into().
+ *
+ * @param pipeline The pipeline.
+ * @param fn The reduce function. Must update the accumulator in place.
+ * @param acc The accumulator, holding the initial value.
+ * @return The accumulator, or NULL on invalid input.
+ */
+void* pipeline_reduce_into(Pipeline* pipeline, ReduceIntoDataFn fn, void* acc);
+
+/**
+ * Free a pipeline. The source is not touched.
+ *
+ * @param pipeline The pipeline.
+ */
+void pipeline_free(Pipeline* pipeline);
+
+
+#endif // _PIPELINE_H_
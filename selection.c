@@ -0,0 +1,358 @@
+/**
+ * Selection vectors and bitmaps.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "selection.h"
+#ifdef TEST
+#include <assert.h>
+#include <stdio.h>
+#endif
+
+#define WORDS(bits) (((bits) + 63) / 64)
+
+
+/**
+ * Append an index to a growing array of indices of width sizeof(*idx).
+ * -- private
+ */
+#define PUSH_INDEX(idx, k, cap, value, fail) \
+    do { \
+        if ((k) == (cap)) { \
+            size_t new_cap = (cap) ? (cap) * 2 : 64; \
+            void* tmp = realloc((idx), new_cap * sizeof(*(idx))); \
+            if (!tmp) goto fail; \
+            (idx) = tmp; \
+            (cap) = new_cap; \
+        } \
+        (idx)[(k)++] = (value); \
+    } while (0)
+
+
+// Documentation in header file.
+size_t* filter_data_index(FilterDataFn fn, const void* input, size_t el_len,
+    size_t el_count, size_t* count) {
+    if (count) *count = 0;
+    if (input == NULL || fn == NULL || el_len == 0 || count == NULL) {
+        return NULL;
+    }
+    size_t* idx = NULL;
+    size_t k = 0, cap = 0;
+    const unsigned char* ix = input;
+    for (size_t j = 0; j < el_count; j++) {
+        if (fn(&ix[j * el_len], j)) PUSH_INDEX(idx, k, cap, j, failed);
+    }
+    // An empty selection is still a valid allocation.
+    if (!idx && !(idx = malloc(sizeof(size_t)))) return NULL;
+    *count = k;
+    return idx;
+failed:
+    free(idx);
+    return NULL;
+}
+
+
+// Documentation in header file.
+uint32_t* filter_data_index32(FilterDataFn fn, const void* input,
+    size_t el_len, size_t el_count, size_t* count) {
+    if (count) *count = 0;
+    if (input == NULL || fn == NULL || el_len == 0 || count == NULL
+        || el_count > (size_t)UINT32_MAX + 1) {
+        return NULL;
+    }
+    uint32_t* idx = NULL;
+    size_t k = 0, cap = 0;
+    const unsigned char* ix = input;
+    for (size_t j = 0; j < el_count; j++) {
+        if (fn(&ix[j * el_len], j)) PUSH_INDEX(idx, k, cap, (uint32_t)j, failed);
+    }
+    if (!idx && !(idx = malloc(sizeof(uint32_t)))) return NULL;
+    *count = k;
+    return idx;
+failed:
+    free(idx);
+    return NULL;
+}
+
+
+// Documentation in header file.
+Bitmap filter_data_bitmap(FilterDataFn fn, const void* input, size_t el_len,
+    size_t el_count) {
+    Bitmap out = { .words = NULL, .len = 0 };
+    if (input == NULL || fn == NULL || el_len == 0) return out;
+    out.words = calloc(WORDS(el_count) ? WORDS(el_count) : 1, sizeof(uint64_t));
+    if (!out.words) return out;
+    out.len = el_count;
+    const unsigned char* ix = input;
+    size_t j = 0;
+    for (size_t w = 0; w < WORDS(el_count); w++) {
+        // Build each word in a register and store it once.
+        uint64_t word = 0;
+        size_t end = j + 64 < el_count ? j + 64 : el_count;
+        for (unsigned b = 0; j < end; j++, b++) {
+            word |= (uint64_t)(fn(&ix[j * el_len], j) != 0) << b;
+        }
+        out.words[w] = word;
+    }
+    return out;
+}
+
+
+// Documentation in header file.
+int bitmap_get(const Bitmap* bitmap, size_t index) {
+    if (!bitmap || index >= bitmap->len) return 0;
+    return (bitmap->words[index / 64] >> (index % 64)) & 1;
+}
+
+
+// Documentation in header file.
+size_t bitmap_count(const Bitmap* bitmap) {
+    if (!bitmap || !bitmap->words) return 0;
+    size_t total = 0;
+    for (size_t w = 0; w < WORDS(bitmap->len); w++) {
+        total += (size_t)__builtin_popcountll(bitmap->words[w]);
+    }
+    return total;
+}
+
+
+// Documentation in header file.
+int bitmap_and(Bitmap* dst, const Bitmap* src) {
+    if (!dst || !src || dst->len != src->len) return -1;
+    for (size_t w = 0; w < WORDS(dst->len); w++) dst->words[w] &= src->words[w];
+    return 0;
+}
+
+
+// Documentation in header file.
+int bitmap_or(Bitmap* dst, const Bitmap* src) {
+    if (!dst || !src || dst->len != src->len) return -1;
+    for (size_t w = 0; w < WORDS(dst->len); w++) dst->words[w] |= src->words[w];
+    return 0;
+}
+
+
+// Documentation in header file.
+size_t* bitmap_to_index(const Bitmap* bitmap, size_t* count) {
+    if (count) *count = 0;
+    if (!bitmap || !count) return NULL;
+    size_t n = bitmap_count(bitmap);
+    size_t* idx = malloc((n ? n : 1) * sizeof(size_t));
+    if (!idx) return NULL;
+    size_t k = 0;
+    for (size_t w = 0; w < WORDS(bitmap->len); w++) {
+        uint64_t word = bitmap->words[w];
+        while (word) {
+            idx[k++] = w * 64 + (size_t)__builtin_ctzll(word);
+            word &= word - 1;
+        }
+    }
+    *count = n;
+    return idx;
+}
+
+
+// Documentation in header file.
+void bitmap_free(Bitmap* bitmap) {
+    if (!bitmap) return;
+    free(bitmap->words);
+    bitmap->words = NULL;
+    bitmap->len = 0;
+}
+
+
+/**
+ * Allocate a packed list for count elements. -- private
+ */
+static PackedList packed_new(size_t el_len, size_t count) {
+    PackedList out = { .data = NULL, .count = 0, .el_len = el_len,
+        .capacity = 0, .allocator = NULL };
+    if (count == 0) return out;
+    out.data = malloc(count * el_len);
+    if (out.data) out.capacity = count;
+    return out;
+}
+
+
+/**
+ * Copy the elements at the given indices, with fixed-width copies for the
+ * common element lengths. -- private
+ */
+#define GATHER(out, input, el_len, index, count) \
+    do { \
+        unsigned char* ox = (out).data; \
+        const unsigned char* ix = (input); \
+        switch (el_len) { \
+        case 4: \
+            for (size_t i = 0; i < (count); i++) { \
+                memcpy(&ox[i * 4], &ix[(size_t)(index)[i] * 4], 4); \
+            } \
+            break; \
+        case 8: \
+            for (size_t i = 0; i < (count); i++) { \
+                memcpy(&ox[i * 8], &ix[(size_t)(index)[i] * 8], 8); \
+            } \
+            break; \
+        default: \
+            for (size_t i = 0; i < (count); i++) { \
+                memcpy(&ox[i * (el_len)], &ix[(size_t)(index)[i] * (el_len)], \
+                    (el_len)); \
+            } \
+        } \
+        (out).count = (count); \
+    } while (0)
+
+
+// Documentation in header file.
+PackedList gather_data(const void* input, size_t el_len, const size_t* index,
+    size_t count) {
+    if (!input || !index || el_len == 0) return packed_new(0, 0);
+    PackedList out = packed_new(el_len, count);
+    if (out.data) GATHER(out, input, el_len, index, count);
+    return out;
+}
+
+
+// Documentation in header file.
+PackedList gather_data32(const void* input, size_t el_len,
+    const uint32_t* index, size_t count) {
+    if (!input || !index || el_len == 0) return packed_new(0, 0);
+    PackedList out = packed_new(el_len, count);
+    if (out.data) GATHER(out, input, el_len, index, count);
+    return out;
+}
+
+
+// Documentation in header file.
+PackedList compress_data(const void* input, size_t el_len,
+    const Bitmap* selection) {
+    if (!input || !selection || el_len == 0) return packed_new(0, 0);
+    PackedList out = packed_new(el_len, bitmap_count(selection));
+    if (!out.data) return out;
+    const unsigned char* ix = input;
+    unsigned char* ox = out.data;
+    size_t k = 0;
+    for (size_t w = 0; w < WORDS(selection->len); w++) {
+        uint64_t word = selection->words[w];
+        if (word == UINT64_MAX) {
+            // Dense words copy 64 consecutive elements at once.
+            memcpy(&ox[k * el_len], &ix[w * 64 * el_len], 64 * el_len);
+            k += 64;
+            continue;
+        }
+        while (word) {
+            size_t j = w * 64 + (size_t)__builtin_ctzll(word);
+            memcpy(&ox[k * el_len], &ix[j * el_len], el_len);
+            k++;
+            word &= word - 1;
+        }
+    }
+    out.count = k;
+    return out;
+}
+
+
+#ifdef TEST
+int is_even(const void* ii, size_t _) {
+    const int* i = ii;
+    return *i % 2 == 0;
+}
+
+int is_mult3(const void* ii, size_t _) {
+    const int* i = ii;
+    return *i % 3 == 0;
+}
+
+void test_filter_data_index() {
+    int input[200];
+    for (int i = 0; i < 200; i++) input[i] = i;
+    size_t count;
+    size_t* idx = filter_data_index(&is_even, input, sizeof(int), 200, &count);
+    assert(count == 100);
+    for (size_t i = 0; i < count; i++) assert(idx[i] == i * 2);
+    free(idx);
+
+    uint32_t* idx32 = filter_data_index32(&is_mult3, input, sizeof(int), 200, &count);
+    assert(count == 67);
+    for (size_t i = 0; i < count; i++) assert(idx32[i] == i * 3);
+
+    // The same selection applies to a parallel column.
+    double column[200];
+    for (int i = 0; i < 200; i++) column[i] = i * 0.5;
+    PackedList out = gather_data32(column, sizeof(double), idx32, count);
+    assert(out.count == 67);
+    assert(((double*)out.data)[66] == 198 * 0.5);
+    free_packed(&out);
+    free(idx32);
+
+    int odd[] = { 1, 3 };
+    idx = filter_data_index(&is_even, odd, sizeof(int), 2, &count);
+    assert(idx && count == 0);
+    free(idx);
+}
+
+void test_bitmap() {
+    int input[130];
+    for (int i = 0; i < 130; i++) input[i] = i;
+    Bitmap even = filter_data_bitmap(&is_even, input, sizeof(int), 130);
+    Bitmap mult3 = filter_data_bitmap(&is_mult3, input, sizeof(int), 130);
+    assert(even.len == 130);
+    assert(bitmap_count(&even) == 65);
+    assert(bitmap_get(&even, 128) && !bitmap_get(&even, 129));
+    assert(!bitmap_get(&even, 130));
+
+    Bitmap both = filter_data_bitmap(&is_even, input, sizeof(int), 130);
+    assert(bitmap_and(&both, &mult3) == 0);
+    assert(bitmap_count(&both) == 22);
+    size_t count;
+    size_t* idx = bitmap_to_index(&both, &count);
+    assert(count == 22);
+    for (size_t i = 0; i < count; i++) assert(idx[i] == i * 6);
+    free(idx);
+
+    assert(bitmap_or(&even, &mult3) == 0);
+    assert(bitmap_count(&even) == 65 + 44 - 22);
+
+    PackedList out = compress_data(input, sizeof(int), &both);
+    assert(out.count == 22);
+    for (size_t i = 0; i < out.count; i++) assert(((int*)out.data)[i] == (int)i * 6);
+    free_packed(&out);
+
+    Bitmap short_map = filter_data_bitmap(&is_even, input, sizeof(int), 10);
+    assert(bitmap_and(&both, &short_map) == -1);
+    bitmap_free(&short_map);
+    bitmap_free(&both);
+    bitmap_free(&mult3);
+    bitmap_free(&even);
+}
+
+void test_compress_dense() {
+    int input[150];
+    for (int i = 0; i < 150; i++) input[i] = 2 * i;
+    Bitmap all = filter_data_bitmap(&is_even, input, sizeof(int), 150);
+    PackedList out = compress_data(input, sizeof(int), &all);
+    assert(out.count == 150);
+    assert(memcmp(out.data, input, sizeof(input)) == 0);
+    free_packed(&out);
+    bitmap_free(&all);
+}
+
+int main() {
+    test_filter_data_index();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_filter_data_index", "Passed");
+    test_bitmap();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_bitmap", "Passed");
+    test_compress_dense();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_compress_dense", "Passed");
+    return 0;
+}
+
+#endif // TEST
@@ -0,0 +1,169 @@
+/**
+ * Selection vectors and bitmaps. (Header file)
+ *
+ * These functions record which elements of an array pass a filter, as a
+ * list of indices or as a bitmap, without copying the elements. The same
+ * selection can then be applied to any number of parallel arrays with
+ * gather_data() or compress_data(), and bitmaps from several predicates can
+ * be combined with bitmap_and() and bitmap_or().
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _SELECTION_H_
+#define _SELECTION_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "functools.h"
+
+/**
+ * A packed bitmap with one bit per element.
+ *
+ * @param words The bits, element i being bit i % 64 of words[i / 64]. The
+ * unused bits of the last word are zero.
+ * @param len The number of bits.
+ */
+typedef struct {
+    uint64_t* words;
+    size_t len;
+} Bitmap;
+
+
+/**
+ * Filter an array of elements into a list of indices.
+ *
+ * @param fn The filter function. Must return 1 for true, 0 for false.
+ * @param input The input array.
+ * @param el_len The length of each element.
+ * @param el_count The number of elements.
+ * @param count Receives the number of indices.
+ * @return The ascending indices of the elements that passed, or NULL on
+ * invalid input or allocation failure.
+ *
+ * @note The returned array must be freed by the caller.
+ */
+size_t* filter_data_index(FilterDataFn fn, const void* input, size_t el_len,
+    size_t el_count, size_t* count);
+
+/**
+ * Filter an array of elements into a list of 32-bit indices. Half the size
+ * of filter_data_index() for arrays of up to 2^32 elements.
+ *
+ * @return The ascending indices of the elements that passed, or NULL on
+ * invalid input, on allocation failure, or if el_count exceeds 2^32.
+ *
+ * @note The returned array must be freed by the caller.
+ */
+uint32_t* filter_data_index32(FilterDataFn fn, const void* input,
+    size_t el_len, size_t el_count, size_t* count);
+
+/**
+ * Filter an array of elements into a bitmap.
+ *
+ * @param fn The filter function. Must return 1 for true, 0 for false.
+ * @param input The input array.
+ * @param el_len The length of each element.
+ * @param el_count The number of elements.
+ * @return A bitmap of el_count bits, bit i being set if element i passed.
+ * On invalid input or allocation failure, the bitmap is zeroed.
+ *
+ * @note The returned bitmap must be freed by the caller with bitmap_free().
+ */
+Bitmap filter_data_bitmap(FilterDataFn fn, const void* input, size_t el_len,
+    size_t el_count);
+
+/**
+ * Test one bit of a bitmap.
+ *
+ * @param bitmap The bitmap.
+ * @param index The index of the bit.
+ * @return 1 if the bit is set, 0 if it is clear or out of range.
+ */
+int bitmap_get(const Bitmap* bitmap, size_t index);
+
+/**
+ * Count the set bits of a bitmap.
+ *
+ * @param bitmap The bitmap.
+ * @return The number of set bits.
+ */
+size_t bitmap_count(const Bitmap* bitmap);
+
+/**
+ * Intersect a bitmap with another one, in place.
+ *
+ * @param dst The bitmap to update.
+ * @param src The other bitmap. Must have the same length.
+ * @return 0 on success, -1 if the lengths differ.
+ */
+int bitmap_and(Bitmap* dst, const Bitmap* src);
+
+/**
+ * Unite a bitmap with another one, in place.
+ *
+ * @param dst The bitmap to update.
+ * @param src The other bitmap. Must have the same length.
+ * @return 0 on success, -1 if the lengths differ.
+ */
+int bitmap_or(Bitmap* dst, const Bitmap* src);
+
+/**
+ * Convert a bitmap to a list of indices.
+ *
+ * @param bitmap The bitmap.
+ * @param count Receives the number of indices.
+ * @return The ascending indices of the set bits, or NULL on allocation
+ * failure.
+ *
+ * @note The returned array must be freed by the caller.
+ */
+size_t* bitmap_to_index(const Bitmap* bitmap, size_t* count);
+
+/**
+ * Free a bitmap and reset it to an empty bitmap.
+ *
+ * @param bitmap The bitmap.
+ */
+void bitmap_free(Bitmap* bitmap);
+
+/**
+ * Copy the selected elements of an array into a packed list.
+ *
+ * @param input The input array.
+ * @param el_len The length of each element.
+ * @param index The indices of the elements to copy. Must be in range.
+ * @param count The number of indices.
+ * @return A packed list of the selected elements, in index order.
+ *
+ * @note The returned list must be freed by the caller with free_packed().
+ */
+PackedList gather_data(const void* input, size_t el_len, const size_t* index,
+    size_t count);
+
+/**
+ * Copy the selected elements of an array into a packed list, using 32-bit
+ * indices. See gather_data().
+ */
+PackedList gather_data32(const void* input, size_t el_len,
+    const uint32_t* index, size_t count);
+
+/**
+ * Copy the elements of an array whose bits are set into a packed list.
+ *
+ * @param input The input array, with at least selection->len elements.
+ * @param el_len The length of each element.
+ * @param selection The bitmap of the elements to copy.
+ * @return A packed list of the selected elements, in input order.
+ *
+ * @note The returned list must be freed by the caller with free_packed().
+ */
+PackedList compress_data(const void* input, size_t el_len,
+    const Bitmap* selection);
+
+
+#endif // _SELECTION_H_
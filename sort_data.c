@@ -0,0 +1,668 @@
+/**
+ * Sorting arrays of elements.
+ *
+ * The merge sort is cache aware: the array is cut into blocks of about
+ * SORT_BLOCK_BYTES, each block is sorted completely (insertion sort of short
+ * runs, then merges) while it is in cache, and only then are the blocks
+ * merged with each other, ping-ponging between the output and one scratch
+ * buffer. A merge whose halves are already in order is a plain copy, so
+ * sorted input costs one comparison per run.
+ *
+ * The parallel sort runs the same serial sort on one part of the array per
+ * thread. The parts are then merged pairwise in rounds. So that the last
+ * rounds, with few merges, still use every thread, each merge is cut into
+ * segments of equal output length: the start of a segment in each half is
+ * found by a binary search over the halves (the co-rank of the segment).
+ *
+ * The radix sort computes the key of every element once, then sorts (key,
+ * index) pairs by one byte of the key per pass, from the lowest byte. The
+ * histograms of all eight bytes are taken in one pass over the keys, and
+ * the passes where all keys share the same byte are skipped. The elements
+ * are moved once, at the end.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include "sort_data.h"
+#ifdef TEST
+#include <assert.h>
+#include <stdio.h>
+#endif
+
+// The length of the runs sorted by insertion before merging.
+#define SORT_RUN 16
+
+// The size of the blocks sorted while they are in cache.
+#define SORT_BLOCK_BYTES (256 * 1024)
+
+#define SORT_DEFAULT_GRAIN 4096
+
+// The number of merge segments per thread in each parallel round.
+#define SORT_SEGMENTS_PER_THREAD 4
+
+
+/**
+ * What is being sorted. -- private
+ *
+ * @param cmp The comparison function.
+ * @param input For index sorts, the elements the indices refer to; NULL
+ * when the elements themselves are sorted.
+ * @param el_len The length of the elements of input.
+ * @param width The length of the items being sorted: el_len, or the size of
+ * an index.
+ */
+typedef struct {
+    CompareDataFn cmp;
+    const unsigned char* input;
+    size_t el_len;
+    size_t width;
+} SortCtx;
+
+
+/**
+ * Compare two items. -- private
+ */
+static inline int compare_items(const SortCtx* c, const unsigned char* a,
+    const unsigned char* b) {
+    if (c->input) {
+        size_t ia, ib;
+        memcpy(&ia, a, sizeof(ia));
+        memcpy(&ib, b, sizeof(ib));
+        return c->cmp(c->input + ia * c->el_len, c->input + ib * c->el_len);
+    }
+    return c->cmp(a, b);
+}
+
+
+/**
+ * Sort the items lo to hi - 1 by binary insertion. tmp holds one item.
+ * -- private
+ */
+static void insertion_sort(const SortCtx* c, unsigned char* buf, size_t lo,
+    size_t hi, unsigned char* tmp) {
+    size_t w = c->width;
+    for (size_t i = lo + 1; i < hi; i++) {
+        unsigned char* item = buf + i * w;
+        if (compare_items(c, item - w, item) <= 0) continue;
+        // Insert after the last item that is not greater, for stability.
+        size_t a = lo, b = i - 1;
+        while (a < b) {
+            size_t mid = a + (b - a) / 2;
+            if (compare_items(c, buf + mid * w, item) <= 0) a = mid + 1;
+            else b = mid;
+        }
+        memcpy(tmp, item, w);
+        memmove(buf + (a + 1) * w, buf + a * w, (i - a) * w);
+        memcpy(buf + a * w, tmp, w);
+    }
+}
+
+
+/**
+ * Merge two sorted runs into out, taking from the first run on ties.
+ * -- private
+ */
+static void merge_runs(const SortCtx* c, const unsigned char* a, size_t na,
+    const unsigned char* b, size_t nb, unsigned char* out) {
+    size_t w = c->width;
+    if (na > 0 && nb > 0 && compare_items(c, a + (na - 1) * w, b) <= 0) {
+        memcpy(out, a, na * w);
+        memcpy(out + na * w, b, nb * w);
+        return;
+    }
+    const unsigned char* a_end = a + na * w;
+    const unsigned char* b_end = b + nb * w;
+    while (a < a_end && b < b_end) {
+        if (compare_items(c, a, b) <= 0) {
+            memcpy(out, a, w);
+            a += w;
+        } else {
+            memcpy(out, b, w);
+            b += w;
+        }
+        out += w;
+    }
+    memcpy(out, a, (size_t)(a_end - a));
+    out += a_end - a;
+    memcpy(out, b, (size_t)(b_end - b));
+}
+
+
+/**
+ * Merge the sorted runs of the given length of items lo to hi - 1 until
+ * they form one run, which is left in buf. scratch is a buffer of the same
+ * size. -- private
+ */
+static void merge_passes(const SortCtx* c, unsigned char* buf,
+    unsigned char* scratch, size_t lo, size_t hi, size_t run) {
+    size_t w = c->width;
+    unsigned char* src = buf;
+    unsigned char* dst = scratch;
+    for (; run < hi - lo; run *= 2) {
+        for (size_t s = lo; s < hi; s += 2 * run) {
+            size_t mid = s + run < hi ? s + run : hi;
+            size_t end = mid + run < hi ? mid + run : hi;
+            merge_runs(c, src + s * w, mid - s, src + mid * w, end - mid,
+                dst + s * w);
+        }
+        unsigned char* t = src;
+        src = dst;
+        dst = t;
+    }
+    if (src != buf) memcpy(buf + lo * w, src + lo * w, (hi - lo) * w);
+}
+
+
+/**
+ * Sort the items lo to hi - 1 of buf, block by block. -- private
+ */
+static void sort_range(const SortCtx* c, unsigned char* buf,
+    unsigned char* scratch, size_t lo, size_t hi, unsigned char* tmp) {
+    if (hi - lo < 2) return;
+    size_t block = SORT_BLOCK_BYTES / c->width;
+    block = block < SORT_RUN ? SORT_RUN : block / SORT_RUN * SORT_RUN;
+    for (size_t s = lo; s < hi; s += block) {
+        size_t e = s + block < hi ? s + block : hi;
+        for (size_t r = s; r < e; r += SORT_RUN) {
+            insertion_sort(c, buf, r, r + SORT_RUN < e ? r + SORT_RUN : e, tmp);
+        }
+        merge_passes(c, buf, scratch, s, e, SORT_RUN);
+    }
+    merge_passes(c, buf, scratch, lo, hi, block);
+}
+
+
+/**
+ * Find how many items of the first run are among the first p items of the
+ * merge of two runs. -- private
+ */
+static size_t co_rank(const SortCtx* c, const unsigned char* a, size_t na,
+    const unsigned char* b, size_t nb, size_t p) {
+    size_t w = c->width;
+    size_t lo = p > nb ? p - nb : 0;
+    size_t hi = p < na ? p : na;
+    while (lo < hi) {
+        size_t i = lo + (hi - lo) / 2;
+        // a[i] is taken before b[p - i - 1] on ties, so more of a is needed.
+        if (compare_items(c, a + i * w, b + (p - i - 1) * w) <= 0) lo = i + 1;
+        else hi = i;
+    }
+    return lo;
+}
+
+
+/**
+ * A segment of the output of a parallel merge round. -- private
+ *
+ * @param lo The start of the first run, which is also the start of the
+ * merged output.
+ * @param mid The start of the second run.
+ * @param hi The end of the second run.
+ * @param from The first output position of the segment, relative to lo.
+ * @param to One past the last output position of the segment.
+ */
+typedef struct {
+    size_t lo;
+    size_t mid;
+    size_t hi;
+    size_t from;
+    size_t to;
+} MergeSegment;
+
+
+/**
+ * The state of a parallel sort. -- private
+ */
+typedef struct {
+    const SortCtx* ctx;
+    unsigned char* buf;
+    unsigned char* scratch;
+    unsigned char* tmp;
+    size_t* bounds;
+    const unsigned char* src;
+    unsigned char* dst;
+    MergeSegment* segments;
+} SortJob;
+
+
+/**
+ * Sort one part of the array. -- private
+ */
+static void sort_part_task(void* arg, size_t task) {
+    SortJob* job = arg;
+    sort_range(job->ctx, job->buf, job->scratch, job->bounds[task],
+        job->bounds[task + 1], job->tmp + task * job->ctx->width);
+}
+
+
+/**
+ * Merge one segment of a round. -- private
+ */
+static void merge_segment_task(void* arg, size_t task) {
+    SortJob* job = arg;
+    const MergeSegment* s = &job->segments[task];
+    size_t w = job->ctx->width;
+    const unsigned char* a = job->src + s->lo * w;
+    const unsigned char* b = job->src + s->mid * w;
+    size_t na = s->mid - s->lo, nb = s->hi - s->mid;
+    size_t i0 = co_rank(job->ctx, a, na, b, nb, s->from);
+    size_t i1 = co_rank(job->ctx, a, na, b, nb, s->to);
+    size_t j0 = s->from - i0, j1 = s->to - i1;
+    merge_runs(job->ctx, a + i0 * w, i1 - i0, b + j0 * w, j1 - j0,
+        job->dst + (s->lo + s->from) * w);
+}
+
+
+/**
+ * Sort the items of buf in parallel. Returns the buffer that holds the
+ * result, buf or scratch, or NULL on allocation failure. -- private
+ */
+static unsigned char* sort_parallel(const SortCtx* c, unsigned char* buf,
+    unsigned char* scratch, size_t n, const ParallelOpts* opts) {
+    WorkerPool* pool = opts && opts->pool ? opts->pool : worker_pool_default();
+    size_t grain = opts && opts->grain ? opts->grain : SORT_DEFAULT_GRAIN;
+    size_t threads = pool ? worker_pool_size(pool) : 1;
+    size_t parts = n / grain < threads ? n / grain : threads;
+    SortJob job = { .ctx = c, .buf = buf, .scratch = scratch };
+    if (parts < 2) {
+        job.tmp = malloc(c->width);
+        if (!job.tmp) return NULL;
+        sort_range(c, buf, scratch, 0, n, job.tmp);
+        free(job.tmp);
+        return buf;
+    }
+    size_t max_segments = parts + threads * SORT_SEGMENTS_PER_THREAD;
+    job.tmp = malloc(parts * c->width);
+    job.bounds = malloc((parts + 1) * sizeof(size_t));
+    job.segments = malloc(max_segments * sizeof(MergeSegment));
+    if (!job.tmp || !job.bounds || !job.segments) {
+        free(job.tmp);
+        free(job.bounds);
+        free(job.segments);
+        return NULL;
+    }
+    for (size_t k = 0; k <= parts; k++) job.bounds[k] = n * k / parts;
+    worker_pool_run(pool, sort_part_task, &job, parts);
+
+    // Merge the runs pairwise until one is left. bounds holds the starts of
+    // the runs of the current round.
+    unsigned char* src = buf;
+    unsigned char* dst = scratch;
+    size_t runs = parts;
+    size_t seg_len = n / (threads * SORT_SEGMENTS_PER_THREAD) + 1;
+    while (runs > 1) {
+        size_t n_segments = 0;
+        for (size_t r = 0; r < runs; r += 2) {
+            MergeSegment s = { .lo = job.bounds[r],
+                .mid = job.bounds[r + 1 < runs ? r + 1 : runs],
+                .hi = job.bounds[r + 2 < runs ? r + 2 : runs] };
+            // A run without a partner is copied as a merge with an empty run.
+            for (size_t from = 0; from < s.hi - s.lo; from += seg_len) {
+                s.from = from;
+                s.to = from + seg_len < s.hi - s.lo ? from + seg_len : s.hi - s.lo;
+                job.segments[n_segments++] = s;
+            }
+        }
+        job.src = src;
+        job.dst = dst;
+        worker_pool_run(pool, merge_segment_task, &job, n_segments);
+        for (size_t r = 0; r < runs; r += 2) job.bounds[r / 2] = job.bounds[r];
+        runs = (runs + 1) / 2;
+        job.bounds[runs] = n;
+        unsigned char* t = src;
+        src = dst;
+        dst = t;
+    }
+    free(job.tmp);
+    free(job.bounds);
+    free(job.segments);
+    return src;
+}
+
+
+/**
+ * Sort an array of items, serially if opts is NULL. On success, the sorted
+ * items are in *items and the other buffer is freed. -- private
+ */
+static int sort_items(const SortCtx* c, unsigned char** items, size_t n,
+    int parallel, const ParallelOpts* opts) {
+    unsigned char* scratch = malloc(n * c->width);
+    if (!scratch) return -1;
+    unsigned char* result;
+    if (parallel) {
+        result = sort_parallel(c, *items, scratch, n, opts);
+    } else {
+        unsigned char* tmp = malloc(c->width);
+        result = tmp ? *items : NULL;
+        if (tmp) sort_range(c, *items, scratch, 0, n, tmp);
+        free(tmp);
+    }
+    if (!result) {
+        free(scratch);
+        return -1;
+    }
+    if (result == scratch) {
+        free(*items);
+        *items = scratch;
+    } else {
+        free(scratch);
+    }
+    return 0;
+}
+
+
+/**
+ * Sort the elements of an array with a comparison function. -- private
+ */
+static PackedList sort_elements(CompareDataFn cmp, const void* input,
+    size_t el_len, size_t el_count, int parallel, const ParallelOpts* opts) {
+    PackedList out = { .data = NULL, .count = 0, .el_len = 0, .capacity = 0,
+        .allocator = NULL };
+    if (input == NULL || cmp == NULL || el_len == 0 || el_count == 0) {
+        return out;
+    }
+    unsigned char* items = malloc(el_count * el_len);
+    if (!items) return out;
+    memcpy(items, input, el_count * el_len);
+    SortCtx c = { .cmp = cmp, .input = NULL, .el_len = el_len, .width = el_len };
+    if (sort_items(&c, &items, el_count, parallel, opts) != 0) {
+        free(items);
+        return out;
+    }
+    out.data = items;
+    out.count = el_count;
+    out.el_len = el_len;
+    out.capacity = el_count;
+    return out;
+}
+
+
+/**
+ * Sort the indices of an array with a comparison function. -- private
+ */
+static size_t* sort_indices(CompareDataFn cmp, const void* input,
+    size_t el_len, size_t el_count, int parallel, const ParallelOpts* opts) {
+    if (input == NULL || cmp == NULL || el_len == 0 || el_count == 0) {
+        return NULL;
+    }
+    size_t* idx = malloc(el_count * sizeof(size_t));
+    if (!idx) return NULL;
+    for (size_t i = 0; i < el_count; i++) idx[i] = i;
+    SortCtx c = { .cmp = cmp, .input = input, .el_len = el_len,
+        .width = sizeof(size_t) };
+    unsigned char* items = (unsigned char*)idx;
+    if (sort_items(&c, &items, el_count, parallel, opts) != 0) {
+        free(idx);
+        return NULL;
+    }
+    return (size_t*)items;
+}
+
+
+// Documentation in header file.
+PackedList sort_data(CompareDataFn cmp, const void* input, size_t el_len,
+    size_t el_count) {
+    return sort_elements(cmp, input, el_len, el_count, 0, NULL);
+}
+
+
+// Documentation in header file.
+PackedList sort_data_par(CompareDataFn cmp, const void* input, size_t el_len,
+    size_t el_count, const ParallelOpts* opts) {
+    return sort_elements(cmp, input, el_len, el_count, 1, opts);
+}
+
+
+// Documentation in header file.
+size_t* sort_data_index(CompareDataFn cmp, const void* input, size_t el_len,
+    size_t el_count) {
+    return sort_indices(cmp, input, el_len, el_count, 0, NULL);
+}
+
+
+// Documentation in header file.
+size_t* sort_data_index_par(CompareDataFn cmp, const void* input,
+    size_t el_len, size_t el_count, const ParallelOpts* opts) {
+    return sort_indices(cmp, input, el_len, el_count, 1, opts);
+}
+
+
+/**
+ * A key and the index of its element. -- private
+ */
+typedef struct {
+    uint64_t key;
+    size_t idx;
+} KeyedIndex;
+
+
+/**
+ * Radix sort the keys of an array. Returns the keyed indices in ascending
+ * key order, or NULL on invalid input or allocation failure. -- private
+ */
+static KeyedIndex* radix_sort_keys(SortKeyFn key, const void* input,
+    size_t el_len, size_t el_count) {
+    if (input == NULL || key == NULL || el_len == 0 || el_count == 0) {
+        return NULL;
+    }
+    KeyedIndex* a = malloc(el_count * sizeof(KeyedIndex));
+    KeyedIndex* b = malloc(el_count * sizeof(KeyedIndex));
+    size_t (*hist)[256] = calloc(8, sizeof(*hist));
+    if (!a || !b || !hist) {
+        free(a);
+        free(b);
+        free(hist);
+        return NULL;
+    }
+    const unsigned char* ix = input;
+    for (size_t i = 0; i < el_count; i++) {
+        uint64_t k = key(ix + i * el_len);
+        a[i].key = k;
+        a[i].idx = i;
+        for (int p = 0; p < 8; p++) hist[p][(k >> (8 * p)) & 0xff]++;
+    }
+    for (int p = 0; p < 8; p++) {
+        size_t* h = hist[p];
+        // All keys share this byte: the pass would not move anything.
+        if (h[(a[0].key >> (8 * p)) & 0xff] == el_count) continue;
+        size_t sum = 0;
+        for (int d = 0; d < 256; d++) {
+            size_t count = h[d];
+            h[d] = sum;
+            sum += count;
+        }
+        for (size_t i = 0; i < el_count; i++) {
+            b[h[(a[i].key >> (8 * p)) & 0xff]++] = a[i];
+        }
+        KeyedIndex* t = a;
+        a = b;
+        b = t;
+    }
+    free(b);
+    free(hist);
+    return a;
+}
+
+
+// Documentation in header file.
+PackedList sort_data_key(SortKeyFn key, const void* input, size_t el_len,
+    size_t el_count) {
+    PackedList out = { .data = NULL, .count = 0, .el_len = 0, .capacity = 0,
+        .allocator = NULL };
+    KeyedIndex* order = radix_sort_keys(key, input, el_len, el_count);
+    if (!order) return out;
+    unsigned char* data = malloc(el_count * el_len);
+    if (!data) {
+        free(order);
+        return out;
+    }
+    const unsigned char* ix = input;
+    for (size_t i = 0; i < el_count; i++) {
+        memcpy(data + i * el_len, ix + order[i].idx * el_len, el_len);
+    }
+    free(order);
+    out.data = data;
+    out.count = el_count;
+    out.el_len = el_len;
+    out.capacity = el_count;
+    return out;
+}
+
+
+// Documentation in header file.
+size_t* sort_data_key_index(SortKeyFn key, const void* input, size_t el_len,
+    size_t el_count) {
+    KeyedIndex* order = radix_sort_keys(key, input, el_len, el_count);
+    if (!order) return NULL;
+    size_t* idx = malloc(el_count * sizeof(size_t));
+    if (idx) {
+        for (size_t i = 0; i < el_count; i++) idx[i] = order[i].idx;
+    }
+    free(order);
+    return idx;
+}
+
+
+#ifdef TEST
+/**
+ * A record with a key that repeats, and its position in the input.
+ */
+typedef struct {
+    int key;
+    int seq;
+} Record;
+
+int compare_ints(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+int compare_records(const void* a, const void* b) {
+    return compare_ints(&((const Record*)a)->key, &((const Record*)b)->key);
+}
+
+uint64_t record_key(const void* elem) {
+    return sort_key_i64(((const Record*)elem)->key);
+}
+
+uint64_t double_key(const void* elem) {
+    return sort_key_f64(*(const double*)elem);
+}
+
+Record* make_records(size_t n, int keys, unsigned int seed) {
+    Record* r = malloc(n * sizeof(Record));
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1103515245u + 12345u;
+        r[i].key = (int)((seed >> 8) % (unsigned)keys) - keys / 2;
+        r[i].seq = (int)i;
+    }
+    return r;
+}
+
+/**
+ * Check that a list of records is sorted by key and stable.
+ */
+void check_sorted(const Record* r, size_t n) {
+    for (size_t i = 1; i < n; i++) {
+        assert(r[i - 1].key <= r[i].key);
+        if (r[i - 1].key == r[i].key) assert(r[i - 1].seq < r[i].seq);
+    }
+}
+
+void test_sort_data() {
+    size_t sizes[] = { 1, 2, 15, 16, 17, 100, 1000, 40000 };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t n = sizes[s];
+        Record* input = make_records(n, 50, (unsigned)n);
+        PackedList out = sort_data(&compare_records, input, sizeof(Record), n);
+        assert(out.count == n && out.el_len == sizeof(Record));
+        check_sorted(out.data, n);
+        size_t* idx = sort_data_index(&compare_records, input, sizeof(Record), n);
+        for (size_t i = 0; i < n; i++) {
+            assert(input[idx[i]].seq == ((Record*)out.data)[i].seq);
+        }
+        // The input is left unchanged.
+        for (size_t i = 0; i < n; i++) assert(input[i].seq == (int)i);
+        free(idx);
+        free_packed(&out);
+        free(input);
+    }
+    int sorted[100];
+    for (int i = 0; i < 100; i++) sorted[i] = i;
+    PackedList out = sort_data(&compare_ints, sorted, sizeof(int), 100);
+    assert(memcmp(out.data, sorted, sizeof(sorted)) == 0);
+    free_packed(&out);
+
+    out = sort_data(&compare_ints, NULL, sizeof(int), 10);
+    assert(out.data == NULL && out.count == 0);
+    assert(sort_data_index(&compare_ints, sorted, sizeof(int), 0) == NULL);
+}
+
+void test_sort_data_par() {
+    WorkerPool* pool = worker_pool_create(4);
+    ParallelOpts opts = { .pool = pool, .grain = 64 };
+    size_t sizes[] = { 10, 127, 128, 1000, 30001 };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t n = sizes[s];
+        Record* input = make_records(n, 37, 3 * (unsigned)n);
+        PackedList par = sort_data_par(&compare_records, input, sizeof(Record),
+            n, &opts);
+        PackedList ser = sort_data(&compare_records, input, sizeof(Record), n);
+        check_sorted(par.data, n);
+        assert(memcmp(par.data, ser.data, n * sizeof(Record)) == 0);
+        size_t* idx = sort_data_index_par(&compare_records, input,
+            sizeof(Record), n, &opts);
+        for (size_t i = 0; i < n; i++) {
+            assert(input[idx[i]].seq == ((Record*)ser.data)[i].seq);
+        }
+        free(idx);
+        free_packed(&par);
+        free_packed(&ser);
+        free(input);
+    }
+    worker_pool_destroy(pool);
+}
+
+void test_sort_data_key() {
+    size_t sizes[] = { 1, 3, 256, 5000 };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t n = sizes[s];
+        Record* input = make_records(n, 1000, 7 * (unsigned)n);
+        PackedList out = sort_data_key(&record_key, input, sizeof(Record), n);
+        assert(out.count == n);
+        check_sorted(out.data, n);
+        size_t* idx = sort_data_key_index(&record_key, input, sizeof(Record), n);
+        for (size_t i = 0; i < n; i++) {
+            assert(input[idx[i]].seq == ((Record*)out.data)[i].seq);
+        }
+        free(idx);
+        free_packed(&out);
+        free(input);
+    }
+
+    double values[] = { 3.5, -0.0, -1e300, 0.0, 2.0, -2.5, 1e-300, -1e-300 };
+    double expected[] = { -1e300, -2.5, -1e-300, -0.0, 0.0, 1e-300, 2.0, 3.5 };
+    PackedList out = sort_data_key(&double_key, values, sizeof(double), 8);
+    assert(memcmp(out.data, expected, sizeof(expected)) == 0);
+    free_packed(&out);
+
+    assert(sort_key_i64(-1) < sort_key_i64(0));
+    assert(sort_key_i64(INT64_MIN) < sort_key_i64(INT64_MAX));
+    assert(sort_key_f64(-1.0) < sort_key_f64(-0.5));
+}
+
+int main() {
+    test_sort_data();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_sort_data", "Passed");
+    test_sort_data_par();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_sort_data_par", "Passed");
+    test_sort_data_key();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_sort_data_key", "Passed");
+    return 0;
+}
+
+#endif // TEST
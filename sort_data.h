@@ -0,0 +1,156 @@
+/**
+ * Sorting arrays of elements. (Header file)
+ *
+ * The sort functions follow the array conventions of filter_data(): they
+ * take an array of el_count elements of el_len bytes and leave it
+ * unchanged, returning a sorted copy in a PackedList or, for the _index
+ * variants, the order of the elements as an array of indices (an argsort).
+ *
+ * Elements are ordered either by a comparison function, with a merge sort,
+ * or by a 64-bit key extracted once per element, with an LSD radix sort
+ * that never calls back during the sort itself. The sort_key_ helpers turn
+ * integers and floating point numbers into keys that sort in the same
+ * order. All the sorts are stable: equal elements keep their input order.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _SORT_DATA_H_
+#define _SORT_DATA_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "functools.h"
+#include "parallel.h"
+
+/**
+ * Function type for comparisons.
+ *
+ * @param a The first element.
+ * @param b The second element.
+ * @return A negative value if a sorts before b, a positive value if after,
+ * zero if they are equal.
+ */
+typedef int (*CompareDataFn)(const void* a, const void* b);
+
+/**
+ * Function type for sort keys.
+ *
+ * @param elem The element.
+ * @return The key of the element. Elements are sorted by ascending key.
+ */
+typedef uint64_t (*SortKeyFn)(const void* elem);
+
+
+/**
+ * Return the sort key of an unsigned integer.
+ */
+static inline uint64_t sort_key_u64(uint64_t v) {
+    return v;
+}
+
+/**
+ * Return the sort key of a signed integer. Flipping the sign bit moves the
+ * negative numbers below the positive ones.
+ */
+static inline uint64_t sort_key_i64(int64_t v) {
+    return (uint64_t)v ^ ((uint64_t)1 << 63);
+}
+
+/**
+ * Return the sort key of a double. Negative numbers have all their bits
+ * flipped, so that larger magnitudes sort first; positive numbers only
+ * have the sign bit set. -0.0 sorts just before 0.0, and NaNs sort at the
+ * ends according to their sign bit.
+ */
+static inline uint64_t sort_key_f64(double v) {
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return bits >> 63 ? ~bits : bits | ((uint64_t)1 << 63);
+}
+
+
+/**
+ * Sort an array of elements with a comparison function, using a stable
+ * merge sort.
+ *
+ * @param cmp The comparison function.
+ * @param input The input array.
+ * @param el_len The length of each element.
+ * @param el_count The number of elements.
+ * @return The sorted elements. Zeroed on invalid input or allocation
+ * failure.
+ *
+ * @note The returned list must be freed by the caller with free_packed().
+ */
+PackedList sort_data(CompareDataFn cmp, const void* input, size_t el_len,
+    size_t el_count);
+
+/**
+ * Sort an array of elements with a comparison function in parallel. Each
+ * thread sorts a part of the array, and the parts are merged in rounds in
+ * which every merge is split between the threads. The comparison function
+ * runs concurrently and must be thread safe.
+ *
+ * @param opts The parallel options, NULL for the defaults.
+ * @see sort_data()
+ */
+PackedList sort_data_par(CompareDataFn cmp, const void* input, size_t el_len,
+    size_t el_count, const ParallelOpts* opts);
+
+/**
+ * Sort an array of elements by a key, using an LSD radix sort. The key
+ * function is called once per element.
+ *
+ * @param key The key function.
+ * @param input The input array.
+ * @param el_len The length of each element.
+ * @param el_count The number of elements.
+ * @return The sorted elements. Zeroed on invalid input or allocation
+ * failure.
+ *
+ * @note The returned list must be freed by the caller with free_packed().
+ */
+PackedList sort_data_key(SortKeyFn key, const void* input, size_t el_len,
+    size_t el_count);
+
+/**
+ * Return the order of an array of elements under a comparison function.
+ *
+ * @return An array of el_count indices, the index of the first element in
+ * sorted order first, or NULL on invalid input or allocation failure.
+ * @see sort_data()
+ *
+ * @note The returned array must be freed by the caller.
+ */
+size_t* sort_data_index(CompareDataFn cmp, const void* input, size_t el_len,
+    size_t el_count);
+
+/**
+ * Return the order of an array of elements under a comparison function,
+ * sorting in parallel.
+ *
+ * @see sort_data_index(), sort_data_par()
+ */
+size_t* sort_data_index_par(CompareDataFn cmp, const void* input,
+    size_t el_len, size_t el_count, const ParallelOpts* opts);
+
+/**
+ * Return the order of an array of elements by a key.
+ *
+ * @return An array of el_count indices, the index of the first element in
+ * sorted order first, or NULL on invalid input or allocation failure.
+ * @see sort_data_key()
+ *
+ * @note The returned array must be freed by the caller.
+ */
+size_t* sort_data_key_index(SortKeyFn key, const void* input, size_t el_len,
+    size_t el_count);
+
+
+#endif // _SORT_DATA_H_
@@ -0,0 +1,502 @@
+/**
+ * Growable string builder.
+ *
+ * Both modes write through the same two steps: builder_room() returns space
+ * for n more bytes plus a null character, and builder_commit() accounts for
+ * the bytes written there. In flat mode the space is at the end of the
+ * buffer. In rope mode it is at the end of the current segment, and a full
+ * segment is replaced by a new, larger one instead of being resized, so
+ * the bytes already appended are never moved.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include "str_builder.h"
+#include "str_join.h"
+#include "str_split.h"
+#ifdef TEST
+#include <assert.h>
+#include <unistd.h>
+#endif
+
+// The size of the first rope segment, and the largest size segments grow
+// to. Appends larger than a segment get a segment of their own.
+#define ROPE_MIN_SEGMENT 256
+#define ROPE_MAX_SEGMENT (64 * 1024)
+
+
+/**
+ * Grow an array of elements of el_len bytes to hold at least one more.
+ * -- private
+ */
+static int grow_array(void** array, size_t* cap, size_t n, size_t el_len) {
+    if (n < *cap) return 0;
+    size_t new_cap = *cap ? *cap * 2 : 8;
+    void* tmp = realloc(*array, new_cap * el_len);
+    if (!tmp) return -1;
+    *array = tmp;
+    *cap = new_cap;
+    return 0;
+}
+
+
+/**
+ * Append a chunk to a rope, merging it with the last chunk when the two are
+ * contiguous. -- private
+ */
+static int push_chunk(StrBuilder* sb, const char* ptr, size_t len) {
+    if (sb->n_chunks > 0) {
+        StrView* last = &sb->chunks[sb->n_chunks - 1];
+        if (last->ptr + last->len == ptr) {
+            last->len += len;
+            return 0;
+        }
+    }
+    if (grow_array((void**)&sb->chunks, &sb->chunks_cap, sb->n_chunks,
+        sizeof(StrView)) != 0) {
+        return -1;
+    }
+    sb->chunks[sb->n_chunks].ptr = ptr;
+    sb->chunks[sb->n_chunks].len = len;
+    sb->n_chunks++;
+    return 0;
+}
+
+
+/**
+ * Start a new rope segment of at least size bytes. -- private
+ */
+static int new_segment(StrBuilder* sb, size_t size) {
+    size_t next = sb->cap ? sb->cap * 2 : ROPE_MIN_SEGMENT;
+    if (next > ROPE_MAX_SEGMENT) next = ROPE_MAX_SEGMENT;
+    if (size < next) size = next;
+    if (grow_array((void**)&sb->segments, &sb->segments_cap, sb->n_segments,
+        sizeof(char*)) != 0) {
+        return -1;
+    }
+    char* seg = malloc(size);
+    if (!seg) return -1;
+    sb->segments[sb->n_segments++] = seg;
+    sb->buf = seg;
+    sb->len = 0;
+    sb->cap = size;
+    return 0;
+}
+
+
+/**
+ * Return space for n more bytes and a null character. -- private
+ */
+static char* builder_room(StrBuilder* sb, size_t n) {
+    if (n > (size_t)-1 - sb->len - 1) return NULL;
+    if (sb->cap - sb->len >= n + 1) return sb->buf + sb->len;
+    if (sb->rope) {
+        if (new_segment(sb, n + 1) != 0) return NULL;
+        return sb->buf;
+    }
+    size_t cap = sb->cap ? sb->cap : 64;
+    while (cap - sb->len < n + 1) cap *= 2;
+    char* tmp = realloc(sb->buf, cap);
+    if (!tmp) return NULL;
+    sb->buf = tmp;
+    sb->cap = cap;
+    return sb->buf + sb->len;
+}
+
+
+/**
+ * Account for n bytes written at the space returned by builder_room().
+ * -- private
+ */
+static int builder_commit(StrBuilder* sb, size_t n) {
+    if (sb->rope) {
+        if (n > 0 && push_chunk(sb, sb->buf + sb->len, n) != 0) return -1;
+        sb->total += n;
+    }
+    sb->len += n;
+    sb->buf[sb->len] = '\0';
+    return 0;
+}
+
+
+// Documentation in header file.
+void str_builder_init(StrBuilder* sb) {
+    if (sb) memset(sb, 0, sizeof(*sb));
+}
+
+
+// Documentation in header file.
+void str_builder_init_rope(StrBuilder* sb) {
+    if (!sb) return;
+    memset(sb, 0, sizeof(*sb));
+    sb->rope = 1;
+}
+
+
+// Documentation in header file.
+int str_builder_reserve(StrBuilder* sb, size_t extra) {
+    if (!sb) return -1;
+    return builder_room(sb, extra) ? 0 : -1;
+}
+
+
+// Documentation in header file.
+int str_builder_append(StrBuilder* sb, const char* data, size_t len) {
+    if (!sb || (!data && len > 0)) return -1;
+    char* at = builder_room(sb, len);
+    if (!at) return -1;
+    if (len) memcpy(at, data, len);
+    return builder_commit(sb, len);
+}
+
+
+// Documentation in header file.
+int str_builder_append_str(StrBuilder* sb, const char* str) {
+    if (!str) return -1;
+    return str_builder_append(sb, str, strlen(str));
+}
+
+
+// Documentation in header file.
+int str_builder_append_fmt(StrBuilder* sb, const char* fmt, ...) {
+    if (!sb || !fmt) return -1;
+    va_list args, retry;
+    va_start(args, fmt);
+    va_copy(retry, args);
+    // Format into the free space first, and again once it is large enough.
+    size_t avail = sb->cap - sb->len;
+    int n = vsnprintf(avail ? sb->buf + sb->len : NULL, avail, fmt, args);
+    va_end(args);
+    if (n < 0) {
+        va_end(retry);
+        return -1;
+    }
+    if ((size_t)n >= avail) {
+        char* at = builder_room(sb, (size_t)n);
+        if (!at) {
+            va_end(retry);
+            return -1;
+        }
+        vsnprintf(at, (size_t)n + 1, fmt, retry);
+    }
+    va_end(retry);
+    return builder_commit(sb, (size_t)n);
+}
+
+
+// Documentation in header file.
+int str_builder_append_ref(StrBuilder* sb, const char* data, size_t len) {
+    if (!sb || (!data && len > 0)) return -1;
+    if (!sb->rope) return str_builder_append(sb, data, len);
+    if (len == 0) return 0;
+    if (push_chunk(sb, data, len) != 0) return -1;
+    sb->total += len;
+    return 0;
+}
+
+
+// Documentation in header file.
+int str_builder_append_join(StrBuilder* sb, const char** list,
+    const char* sep) {
+    if (!sb || !list || !sep) return -1;
+    size_t seplen = strlen(sep);
+    for (size_t i = 0; list[i]; i++) {
+        if (i > 0 && str_builder_append(sb, sep, seplen) != 0) return -1;
+        if (str_builder_append_str(sb, list[i]) != 0) return -1;
+    }
+    return 0;
+}
+
+
+// Documentation in header file.
+int str_builder_append_views(StrBuilder* sb, const StrView* items,
+    size_t count, StrView sep) {
+    if (!sb || (!items && count > 0)) return -1;
+    if (!sb->rope) {
+        // One pass to size the result, one to copy it.
+        size_t len = str_join_views_into(NULL, 0, items, count, sep);
+        char* at = builder_room(sb, len);
+        if (!at) return -1;
+        str_join_views_into(at, len + 1, items, count, sep);
+        return builder_commit(sb, len);
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0 && str_builder_append(sb, sep.ptr, sep.len) != 0) return -1;
+        if (str_builder_append(sb, items[i].ptr, items[i].len) != 0) return -1;
+    }
+    return 0;
+}
+
+
+// Documentation in header file.
+size_t str_builder_len(const StrBuilder* sb) {
+    if (!sb) return 0;
+    return sb->rope ? sb->total : sb->len;
+}
+
+
+/**
+ * Copy the chunks of a rope into a single segment, releasing the others.
+ * -- private
+ */
+static int flatten(StrBuilder* sb) {
+    char* flat = malloc(sb->total + 1);
+    if (!flat) return -1;
+    char* p = flat;
+    for (size_t i = 0; i < sb->n_chunks; i++) {
+        memcpy(p, sb->chunks[i].ptr, sb->chunks[i].len);
+        p += sb->chunks[i].len;
+    }
+    *p = '\0';
+    // A rope of borrowed chunks only has no segment array yet.
+    if (sb->segments_cap == 0 && grow_array((void**)&sb->segments,
+        &sb->segments_cap, 0, sizeof(char*)) != 0) {
+        free(flat);
+        return -1;
+    }
+    for (size_t i = 0; i < sb->n_segments; i++) free(sb->segments[i]);
+    sb->segments[0] = flat;
+    sb->n_segments = 1;
+    sb->chunks[0].ptr = flat;
+    sb->chunks[0].len = sb->total;
+    sb->n_chunks = 1;
+    sb->buf = flat;
+    sb->len = sb->total;
+    sb->cap = sb->total + 1;
+    return 0;
+}
+
+
+/**
+ * Check whether a rope is a single chunk at the start of its only segment,
+ * which is then a valid flat string. -- private
+ */
+static int is_flat(const StrBuilder* sb) {
+    return sb->n_chunks == 1 && sb->n_segments == 1
+        && sb->chunks[0].ptr == sb->buf && sb->chunks[0].len == sb->len;
+}
+
+
+// Documentation in header file.
+const char* str_builder_cstr(StrBuilder* sb) {
+    if (!sb) return NULL;
+    if (sb->rope && sb->n_chunks > 0 && !is_flat(sb) && flatten(sb) != 0) {
+        return NULL;
+    }
+    if (sb->rope && sb->n_chunks == 0) return "";
+    return sb->buf ? sb->buf : "";
+}
+
+
+// Documentation in header file.
+char* str_builder_detach(StrBuilder* sb, size_t* len) {
+    if (!sb || !str_builder_cstr(sb)) return NULL;
+    size_t n = str_builder_len(sb);
+    char* out;
+    if (n == 0) {
+        out = calloc(1, 1);
+        if (!out) return NULL;
+    } else {
+        out = sb->buf;
+        // The flat buffer now belongs to the caller.
+        if (sb->rope) sb->n_segments = 0;
+        sb->buf = NULL;
+    }
+    int rope = sb->rope;
+    str_builder_free(sb);
+    sb->rope = rope;
+    if (len) *len = n;
+    return out;
+}
+
+
+// Documentation in header file.
+size_t str_builder_iov(const StrBuilder* sb, struct iovec* iov,
+    size_t max_iov) {
+    if (!sb) return 0;
+    if (!sb->rope) {
+        if (sb->len == 0) return 0;
+        if (max_iov > 0) {
+            iov[0].iov_base = sb->buf;
+            iov[0].iov_len = sb->len;
+        }
+        return 1;
+    }
+    for (size_t i = 0; i < sb->n_chunks && i < max_iov; i++) {
+        iov[i].iov_base = (void*)sb->chunks[i].ptr;
+        iov[i].iov_len = sb->chunks[i].len;
+    }
+    return sb->n_chunks;
+}
+
+
+// Documentation in header file.
+ssize_t str_builder_write(const StrBuilder* sb, int fd) {
+    if (!sb) return -1;
+    StrView none = { .ptr = "", .len = 0 };
+    if (!sb->rope) {
+        StrView flat = { .ptr = sb->buf, .len = sb->len };
+        return str_join_writev(fd, &flat, sb->len ? 1 : 0, none);
+    }
+    return str_join_writev(fd, sb->chunks, sb->n_chunks, none);
+}
+
+
+// Documentation in header file.
+StrView* str_builder_split(StrBuilder* sb, const char* delim, size_t* count) {
+    const char* str = str_builder_cstr(sb);
+    if (!str || !delim) {
+        if (count) *count = 0;
+        return NULL;
+    }
+    return str_split_views_n(str, str_builder_len(sb), delim, strlen(delim),
+        count);
+}
+
+
+// Documentation in header file.
+void str_builder_reset(StrBuilder* sb) {
+    if (!sb) return;
+    if (sb->rope) {
+        int rope = sb->rope;
+        str_builder_free(sb);
+        sb->rope = rope;
+        return;
+    }
+    sb->len = 0;
+    if (sb->buf) sb->buf[0] = '\0';
+}
+
+
+// Documentation in header file.
+void str_builder_free(StrBuilder* sb) {
+    if (!sb) return;
+    if (sb->rope) {
+        for (size_t i = 0; i < sb->n_segments; i++) free(sb->segments[i]);
+    } else {
+        free(sb->buf);
+    }
+    free(sb->segments);
+    free(sb->chunks);
+    memset(sb, 0, sizeof(*sb));
+}
+
+
+#ifdef TEST
+void test_builder_flat() {
+    StrBuilder sb;
+    str_builder_init(&sb);
+    assert(strcmp(str_builder_cstr(&sb), "") == 0);
+    for (int i = 0; i < 10000; i++) {
+        assert(str_builder_append_fmt(&sb, "%d,", i % 10) == 0);
+    }
+    assert(str_builder_len(&sb) == 20000);
+    assert(sb.cap < 2 * 20001 + 64);
+    const char* s = str_builder_cstr(&sb);
+    assert(strncmp(s, "0,1,2,", 6) == 0 && s[19998] == '9');
+
+    str_builder_reset(&sb);
+    assert(str_builder_len(&sb) == 0 && sb.cap > 0);
+    assert(str_builder_reserve(&sb, 1000) == 0);
+    size_t cap = sb.cap;
+    char long_text[900];
+    memset(long_text, 'x', sizeof(long_text));
+    assert(str_builder_append(&sb, long_text, sizeof(long_text)) == 0);
+    assert(sb.cap == cap);
+    assert(str_builder_append_fmt(&sb, "[%s]", "tail") == 0);
+    size_t len;
+    char* out = str_builder_detach(&sb, &len);
+    assert(len == 906 && strcmp(out + 900, "[tail]") == 0);
+    free(out);
+    assert(sb.buf == NULL && str_builder_len(&sb) == 0);
+    str_builder_free(&sb);
+
+    printf("%s - \033[0;32m%s\033[0m\n", "test_builder_flat", "Passed");
+}
+
+void test_builder_rope() {
+    StrBuilder sb;
+    str_builder_init_rope(&sb);
+    static char big[100000];
+    memset(big, 'B', sizeof(big));
+    assert(str_builder_append_str(&sb, "head:") == 0);
+    assert(str_builder_append_ref(&sb, big, sizeof(big)) == 0);
+    assert(str_builder_append_fmt(&sb, ":%d", 42) == 0);
+    assert(str_builder_append_str(&sb, ":tail") == 0);
+    assert(str_builder_len(&sb) == 5 + 100000 + 3 + 5);
+
+    // The borrowed block is a chunk of its own and was not copied.
+    struct iovec iov[8];
+    size_t n = str_builder_iov(&sb, iov, 8);
+    assert(n == 3);
+    assert(iov[1].iov_base == big && iov[1].iov_len == sizeof(big));
+    assert(iov[2].iov_len == 8 && memcmp(iov[2].iov_base, ":42:tail", 8) == 0);
+
+    FILE* tmp = tmpfile();
+    assert(str_builder_write(&sb, fileno(tmp)) == (ssize_t)str_builder_len(&sb));
+    fclose(tmp);
+
+    const char* s = str_builder_cstr(&sb);
+    assert(strncmp(s, "head:BBB", 8) == 0);
+    assert(strcmp(s + 100005, ":42:tail") == 0);
+    assert(str_builder_iov(&sb, iov, 8) == 1);
+    assert(str_builder_cstr(&sb) == s);
+
+    // Appended bytes are never moved by later appends.
+    str_builder_reset(&sb);
+    assert(str_builder_append_str(&sb, "first") == 0);
+    const char* first = sb.chunks[0].ptr;
+    for (int i = 0; i < 5000; i++) str_builder_append_str(&sb, "0123456789");
+    assert(sb.chunks[0].ptr == first && memcmp(first, "first", 5) == 0);
+    assert(str_builder_len(&sb) == 50005);
+    size_t len;
+    char* out = str_builder_detach(&sb, &len);
+    assert(len == 50005 && out[50004] == '9' && out[50005] == '\0');
+    free(out);
+    str_builder_free(&sb);
+
+    printf("%s - \033[0;32m%s\033[0m\n", "test_builder_rope", "Passed");
+}
+
+void test_builder_join_split() {
+    StrBuilder sb = { 0 };
+    const char* list[] = { "a", "b", "c", NULL };
+    assert(str_builder_append_join(&sb, list, ", ") == 0);
+    assert(str_builder_append_str(&sb, "; ") == 0);
+    StrView items[] = { str_view("x"), str_view("y") };
+    assert(str_builder_append_views(&sb, items, 2, str_view("|")) == 0);
+    assert(strcmp(str_builder_cstr(&sb), "a, b, c; x|y") == 0);
+
+    size_t count;
+    StrView* views = str_builder_split(&sb, ", ", &count);
+    assert(count == 3 && str_view_eq_str(views[2], "c; x|y"));
+    free(views);
+    str_builder_free(&sb);
+
+    str_builder_init_rope(&sb);
+    assert(str_builder_append_views(&sb, items, 2, str_view("|")) == 0);
+    assert(str_builder_append_join(&sb, list, "") == 0);
+    views = str_builder_split(&sb, "|", &count);
+    assert(count == 2 && str_view_eq_str(views[1], "yabc"));
+    free(views);
+    str_builder_free(&sb);
+
+    printf("%s - \033[0;32m%s\033[0m\n", "test_builder_join_split", "Passed");
+}
+
+int main() {
+    test_builder_flat();
+    test_builder_rope();
+    test_builder_join_split();
+    return 0;
+}
+
+#endif // TEST
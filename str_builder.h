@@ -0,0 +1,230 @@
+/**
+ * Growable string builder. (Header file)
+ *
+ * A StrBuilder collects a string from many small appends. In the default
+ * flat mode the characters live in one buffer whose capacity doubles when
+ * it is full, so n appends cost O(n) copies overall.
+ *
+ * In rope mode the string is a list of chunks instead. Appended text is
+ * copied into segments that are never moved or resized, and
+ * str_builder_append_ref() adds a chunk that borrows the caller's memory
+ * without copying it. The chunks can be written out with writev() or
+ * exported as an iovec array; they are only copied into one buffer when a
+ * contiguous string is asked for.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _STR_BUILDER_H_
+#define _STR_BUILDER_H_
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include "str_view.h"
+
+/**
+ * A string builder. A zeroed StrBuilder is an empty flat builder.
+ *
+ * @param buf The buffer in flat mode, the current segment in rope mode.
+ * @param len The number of bytes used in buf.
+ * @param cap The size of buf.
+ * @param rope 1 in rope mode, 0 in flat mode.
+ * @param chunks The chunks of the string, in rope mode.
+ * @param n_chunks The number of chunks.
+ * @param chunks_cap The capacity of the chunk array.
+ * @param segments The segments owned by the builder, in rope mode.
+ * @param n_segments The number of segments.
+ * @param segments_cap The capacity of the segment array.
+ * @param total The length of the string, in rope mode.
+ */
+typedef struct {
+    char* buf;
+    size_t len;
+    size_t cap;
+    int rope;
+    StrView* chunks;
+    size_t n_chunks;
+    size_t chunks_cap;
+    char** segments;
+    size_t n_segments;
+    size_t segments_cap;
+    size_t total;
+} StrBuilder;
+
+
+/**
+ * Initialize an empty flat builder.
+ *
+ * @param sb The builder.
+ */
+void str_builder_init(StrBuilder* sb);
+
+/**
+ * Initialize an empty builder in rope mode.
+ *
+ * @param sb The builder.
+ */
+void str_builder_init_rope(StrBuilder* sb);
+
+/**
+ * Make room for at least extra more bytes, so that the next appends of up
+ * to that many bytes do not allocate.
+ *
+ * @param sb The builder.
+ * @param extra The number of bytes.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int str_builder_reserve(StrBuilder* sb, size_t extra);
+
+/**
+ * Append bytes to a builder.
+ *
+ * @param sb The builder.
+ * @param data The bytes. Need not be null terminated.
+ * @param len The number of bytes.
+ * @return 0 on success, -1 on invalid input or allocation failure.
+ */
+int str_builder_append(StrBuilder* sb, const char* data, size_t len);
+
+/**
+ * Append a null terminated string to a builder.
+ *
+ * @param sb The builder.
+ * @param str The string.
+ * @return 0 on success, -1 on invalid input or allocation failure.
+ */
+int str_builder_append_str(StrBuilder* sb, const char* str);
+
+/**
+ * Append formatted text to a builder, as with printf().
+ *
+ * @param sb The builder.
+ * @param fmt The format string.
+ * @return 0 on success, -1 on invalid input, formatting error or allocation
+ * failure.
+ */
+int str_builder_append_fmt(StrBuilder* sb, const char* fmt, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+
+/**
+ * Append bytes to a builder without copying them, in rope mode. The bytes
+ * must stay valid and unchanged until the builder is flattened or freed. In
+ * flat mode the bytes are copied, as with str_builder_append().
+ *
+ * @param sb The builder.
+ * @param data The bytes.
+ * @param len The number of bytes.
+ * @return 0 on success, -1 on invalid input or allocation failure.
+ */
+int str_builder_append_ref(StrBuilder* sb, const char* data, size_t len);
+
+/**
+ * Append a null terminated list of strings joined with a separator. See
+ * str_join().
+ *
+ * @param sb The builder.
+ * @param list The list of strings.
+ * @param sep The separator.
+ * @return 0 on success, -1 on invalid input or allocation failure.
+ */
+int str_builder_append_join(StrBuilder* sb, const char** list,
+    const char* sep);
+
+/**
+ * Append a list of string views joined with a separator. See
+ * str_join_views().
+ *
+ * @param sb The builder.
+ * @param items The strings.
+ * @param count The number of strings.
+ * @param sep The separator.
+ * @return 0 on success, -1 on invalid input or allocation failure.
+ */
+int str_builder_append_views(StrBuilder* sb, const StrView* items,
+    size_t count, StrView sep);
+
+/**
+ * Return the length of the string held by a builder.
+ *
+ * @param sb The builder.
+ * @return The length, in bytes.
+ */
+size_t str_builder_len(const StrBuilder* sb);
+
+/**
+ * Return the string held by a builder, null terminated. In rope mode with
+ * more than one chunk, the chunks are first copied into one buffer.
+ *
+ * @param sb The builder.
+ * @return The string, valid until the next change to the builder, or NULL
+ * on allocation failure.
+ */
+const char* str_builder_cstr(StrBuilder* sb);
+
+/**
+ * Take the string out of a builder, which is left empty.
+ *
+ * @param sb The builder.
+ * @param len Receives the length of the string, if not NULL.
+ * @return The string, null terminated, or NULL on allocation failure. The
+ * caller is responsible for freeing it.
+ */
+char* str_builder_detach(StrBuilder* sb, size_t* len);
+
+/**
+ * Describe the chunks of a builder as an iovec array, in order.
+ *
+ * @param sb The builder.
+ * @param iov The array to fill. May be NULL if max_iov is zero.
+ * @param max_iov The size of the array.
+ * @return The number of chunks. Only the first max_iov are filled in.
+ */
+size_t str_builder_iov(const StrBuilder* sb, struct iovec* iov,
+    size_t max_iov);
+
+/**
+ * Write the string held by a builder to a file descriptor with writev(),
+ * chunk by chunk, without flattening it.
+ *
+ * @param sb The builder.
+ * @param fd The file descriptor.
+ * @return The number of bytes written, or -1 on error with errno set.
+ */
+ssize_t str_builder_write(const StrBuilder* sb, int fd);
+
+/**
+ * Split the string held by a builder by a separator into views. See
+ * str_split_views(). The builder is flattened first.
+ *
+ * @param sb The builder.
+ * @param delim The separator.
+ * @param count Receives the number of views.
+ * @return An array of views into the builder, valid until the next change
+ * to the builder, or NULL on failure. The array must be freed by the caller.
+ */
+StrView* str_builder_split(StrBuilder* sb, const char* delim, size_t* count);
+
+/**
+ * Empty a builder. A flat builder keeps its buffer for reuse.
+ *
+ * @param sb The builder.
+ */
+void str_builder_reset(StrBuilder* sb);
+
+/**
+ * Release the memory held by a builder and leave it empty.
+ *
+ * @param sb The builder.
+ */
+void str_builder_free(StrBuilder* sb);
+
+
+#endif // _STR_BUILDER_H_
@@ -10,26 +10,46 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/uio.h>
 #include "str_join.h"
 #ifdef TEST
 #include <assert.h>
 #include <stdio.h>
+#include <unistd.h>
+#endif
+
+// The number of buffers per writev() call. POSIX guarantees IOV_MAX >= 16.
+#if defined(IOV_MAX) && IOV_MAX < 1024
+#define JOIN_IOV_BATCH IOV_MAX
+#else
+#define JOIN_IOV_BATCH 1024
 #endif
 
  // Documentation in header file.
 char* str_join(const char** list, const char* sep) {
-    int i, len = 0, seplen = strlen(sep);
+    return str_join_ex(list, sep, NULL);
+}
+
+// Documentation in header file.
+char* str_join_ex(const char** list, const char* sep,
+    const Allocator* allocator) {
+    STATS_BEGIN(STATS_STR_JOIN);
+    size_t i, len = 0, seplen = strlen(sep);
     for (i = 0; list[i]; i++) {
         len += strlen(list[i]);
         if (list[i + 1]) len += seplen;
     }
-    char* ret = malloc(len + 1);
+    STATS_ELEMENTS(i);
+    char* ret = allocator_alloc(allocator, len + 1);
+    if (!ret) return NULL;
+    // stpcpy() returns the end of the copy, so no second strlen() is needed.
     char* p = ret;
     for (i = 0; list[i]; i++) {
-        strcpy(p, list[i]);
-        p += strlen(list[i]);
+        p = stpcpy(p, list[i]);
         if (list[i + 1]) {
-            strcpy(p, sep);
+            memcpy(p, sep, seplen);
             p += seplen;
         }
     }
@@ -37,6 +57,104 @@ char* str_join(const char** list, const char* sep) {
     return ret;
 }
 
+/**
+ * Copy up to len bytes of src to the buffer at offset pos, clipped to the
+ * first cap bytes of the buffer. -- private
+ */
+static void copy_clipped(char* buf, size_t cap, size_t pos, const char* src,
+    size_t len) {
+    if (pos >= cap || len == 0) return;
+    memcpy(buf + pos, src, len < cap - pos ? len : cap - pos);
+}
+
+// Documentation in header file.
+size_t str_join_views_into(char* buf, size_t buf_len, const StrView* items,
+    size_t count, StrView sep) {
+    if (!items && count > 0) return 0;
+    size_t pos = 0;
+    // Keep the last byte of the buffer for the null character.
+    size_t cap = buf_len > 0 ? buf_len - 1 : 0;
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            copy_clipped(buf, cap, pos, sep.ptr, sep.len);
+            pos += sep.len;
+        }
+        copy_clipped(buf, cap, pos, items[i].ptr, items[i].len);
+        pos += items[i].len;
+    }
+    if (buf_len > 0) buf[pos < cap ? pos : cap] = '\0';
+    return pos;
+}
+
+// Documentation in header file.
+char* str_join_views(const StrView* items, size_t count, StrView sep,
+    size_t* out_len, const Allocator* allocator) {
+    if (!items && count > 0) return NULL;
+    STATS_BEGIN(STATS_STR_JOIN_VIEWS);
+    STATS_ELEMENTS(count);
+    size_t len = str_join_views_into(NULL, 0, items, count, sep);
+    char* ret = allocator_alloc(allocator, len + 1);
+    if (!ret) return NULL;
+    str_join_views_into(ret, len + 1, items, count, sep);
+    if (out_len) *out_len = len;
+    return ret;
+}
+
+/**
+ * Write a batch of buffers in full, resuming after short writes and
+ * interrupts. The iovec array is consumed. -- private
+ */
+static int writev_all(int fd, struct iovec* iov, int n) {
+    while (n > 0) {
+        ssize_t w = writev(fd, iov, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        size_t left = (size_t)w;
+        while (n > 0 && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            iov++;
+            n--;
+        }
+        if (n > 0) {
+            iov->iov_base = (char*)iov->iov_base + left;
+            iov->iov_len -= left;
+        }
+    }
+    return 0;
+}
+
+// Documentation in header file.
+ssize_t str_join_writev(int fd, const StrView* items, size_t count,
+    StrView sep) {
+    if (!items && count > 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    struct iovec iov[JOIN_IOV_BATCH];
+    int n = 0;
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        // Make room for a separator and an item.
+        if (n + 2 > JOIN_IOV_BATCH) {
+            if (writev_all(fd, iov, n) != 0) return -1;
+            n = 0;
+        }
+        if (i > 0 && sep.len > 0) {
+            iov[n].iov_base = (void*)sep.ptr;
+            iov[n++].iov_len = sep.len;
+        }
+        if (items[i].len > 0) {
+            iov[n].iov_base = (void*)items[i].ptr;
+            iov[n++].iov_len = items[i].len;
+        }
+        total += (i > 0 ? sep.len : 0) + items[i].len;
+    }
+    if (writev_all(fd, iov, n) != 0) return -1;
+    return (ssize_t)total;
+}
+
 #ifdef TEST
 void test_join() {
     const char* list[] = { "a", "b", "c", NULL };
@@ -82,8 +200,74 @@ void test_join() {
     printf("%s - \033[0;32m%s\033[0m\n", "test_join", "Passed");
 }
 
+void test_join_ex() {
+    Arena arena;
+    arena_init(&arena, 0);
+    const char* list[] = { "a", "b", "c", NULL };
+    char* result = str_join_ex(list, ", ", &arena.allocator);
+    assert(strcmp(result, "a, b, c") == 0);
+    arena_destroy(&arena);
+
+    printf("%s - \033[0;32m%s\033[0m\n", "test_join_ex", "Passed");
+}
+
+void test_join_views() {
+    StrView items[] = { str_view("alpha"), str_view(""), str_view("gamma") };
+    StrView sep = str_view(", ");
+    char buf[64];
+    assert(str_join_views_into(buf, sizeof(buf), items, 3, sep) == 14);
+    assert(strcmp(buf, "alpha, , gamma") == 0);
+
+    // A short buffer is filled and terminated, and the full size reported.
+    char small[8];
+    assert(str_join_views_into(small, sizeof(small), items, 3, sep) == 14);
+    assert(strcmp(small, "alpha, ") == 0);
+    assert(str_join_views_into(NULL, 0, items, 3, sep) == 14);
+    assert(str_join_views_into(buf, sizeof(buf), items, 0, sep) == 0);
+    assert(buf[0] == '\0');
+
+    // Views need not be null terminated.
+    const char* line = "key=value";
+    StrView parts[] = { { line, 3 }, { line + 4, 5 } };
+    size_t len;
+    char* result = str_join_views(parts, 2, str_view(": "), &len, NULL);
+    assert(len == 10 && strcmp(result, "key: value") == 0);
+    free(result);
+
+    printf("%s - \033[0;32m%s\033[0m\n", "test_join_views", "Passed");
+}
+
+void test_join_writev() {
+    // More items than one writev() batch holds.
+    enum { N = 3000 };
+    static StrView items[N];
+    static char text[N][8];
+    size_t expected = 0;
+    for (int i = 0; i < N; i++) {
+        snprintf(text[i], sizeof(text[i]), "%d", i);
+        items[i] = str_view(text[i]);
+        expected += items[i].len + (i > 0);
+    }
+    FILE* tmp = tmpfile();
+    int fd = fileno(tmp);
+    assert(str_join_writev(fd, items, N, str_view("\n")) == (ssize_t)expected);
+    char* joined = str_join_views(items, N, str_view("\n"), NULL, NULL);
+    char* back = malloc(expected);
+    assert(pread(fd, back, expected, 0) == (ssize_t)expected);
+    assert(memcmp(back, joined, expected) == 0);
+    free(back);
+    free(joined);
+    fclose(tmp);
+
+    assert(str_join_writev(-1, items, 2, str_view(",")) == -1);
+    printf("%s - \033[0;32m%s\033[0m\n", "test_join_writev", "Passed");
+}
+
 int main() {
     test_join();
+    test_join_ex();
+    test_join_views();
+    test_join_writev();
     return 0;
 }
 
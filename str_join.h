@@ -11,6 +11,11 @@
 #ifndef _STR_JOIN_H_
 #define _STR_JOIN_H_
 
+#include <stddef.h>
+#include <sys/types.h>
+#include "allocator.h"
+#include "str_view.h"
+
 /**
  * Joins a list of strings with a separator.
  *
@@ -21,5 +26,66 @@
  */
 char* str_join(const char** list, const char* sep);
 
+/**
+ * Joins a list of strings with a separator, allocating from the given
+ * allocator.
+ *
+ * @param list The list of strings to join.
+ * @param sep The separator to use.
+ * @param allocator The allocator for the result, NULL for malloc().
+ *
+ * @return The joined string. The caller is responsible for releasing it to
+ * the allocator.
+ */
+char* str_join_ex(const char** list, const char* sep,
+    const Allocator* allocator);
+
+/**
+ * Joins a list of string views with a separator into a caller buffer. Like
+ * snprintf(), at most buf_len - 1 characters are written, followed by a
+ * null character, and the return value is the length of the full result.
+ *
+ * @param buf The buffer. May be NULL if buf_len is zero.
+ * @param buf_len The size of the buffer.
+ * @param items The strings to join. Need not be null terminated.
+ * @param count The number of strings.
+ * @param sep The separator.
+ *
+ * @return The length of the joined string, not counting the null character.
+ * The result was truncated if it is not less than buf_len.
+ */
+size_t str_join_views_into(char* buf, size_t buf_len, const StrView* items,
+    size_t count, StrView sep);
+
+/**
+ * Joins a list of string views with a separator into a new string.
+ *
+ * @param items The strings to join. Need not be null terminated.
+ * @param count The number of strings.
+ * @param sep The separator.
+ * @param out_len Receives the length of the result, if not NULL.
+ * @param allocator The allocator for the result, NULL for malloc().
+ *
+ * @return The joined string, null terminated, or NULL on failure. The
+ * caller is responsible for releasing it to the allocator.
+ */
+char* str_join_views(const StrView* items, size_t count, StrView sep,
+    size_t* out_len, const Allocator* allocator);
+
+/**
+ * Writes a list of string views joined by a separator to a file descriptor,
+ * without building the joined string. The items and separators are passed
+ * to writev() directly, in batches of up to IOV_MAX buffers.
+ *
+ * @param fd The file descriptor.
+ * @param items The strings to join.
+ * @param count The number of strings.
+ * @param sep The separator.
+ *
+ * @return The number of bytes written, or -1 on error with errno set.
+ */
+ssize_t str_join_writev(int fd, const StrView* items, size_t count,
+    StrView sep);
+
 
 #endif // _STR_JOIN_H_
@@ -0,0 +1,624 @@
+/**
+ * Delimiter search in strings.
+ *
+ * The single-byte search compares a whole block against the delimiter and
+ * takes the first set bit of the comparison mask. The sequence search
+ * compares each block against the first and the last byte of the delimiter
+ * at the matching offsets, and only verifies the positions where both agree.
+ * The set search looks up every byte of a block in a bitmap of the set,
+ * split into two shuffle tables indexed by the low nibble, whose entries
+ * hold one bit per high nibble.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "str_scan.h"
+#ifdef TEST
+#include <assert.h>
+#include <stdio.h>
+#endif
+
+#if defined(__x86_64__) && defined(__has_attribute)
+#if __has_attribute(target)
+#include <immintrin.h>
+#define SCAN_X86 1
+#endif
+#endif
+
+
+/**
+ * Test whether a byte belongs to the set of a scanner. -- private
+ */
+static inline int in_set(const StrScanner* scanner, unsigned char c) {
+    return charset_has(&scanner->set, c);
+}
+
+
+/**
+ * Find a byte with the C library. -- private
+ */
+static const char* find_byte_scalar(const char* str, size_t len, char c) {
+    return memchr(str, c, len);
+}
+
+
+/**
+ * Find a sequence by locating its first byte and comparing the rest.
+ * -- private
+ */
+static const char* find_seq_scalar(const char* str, size_t len,
+    const char* delim, size_t delim_len) {
+    const char* end = str + len;
+    while ((size_t)(end - str) >= delim_len) {
+        const char* p = memchr(str, delim[0], (size_t)(end - str) - delim_len + 1);
+        if (!p) return NULL;
+        if (memcmp(p + 1, delim + 1, delim_len - 1) == 0) return p;
+        str = p + 1;
+    }
+    return NULL;
+}
+
+
+/**
+ * Find a byte of a set, one byte at a time. -- private
+ */
+static const char* find_any_scalar(const char* str, size_t len,
+    const StrScanner* scanner) {
+    for (size_t i = 0; i < len; i++) {
+        if (in_set(scanner, (unsigned char)str[i])) return str + i;
+    }
+    return NULL;
+}
+
+
+#ifdef SCAN_X86
+/**
+ * Find a byte, 16 bytes at a time. SSE2 is part of the x86-64 baseline.
+ * -- private
+ */
+static const char* find_byte_sse2(const char* str, size_t len, char c) {
+    const __m128i v = _mm_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(str + i));
+        unsigned m = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, v));
+        if (m) return str + i + __builtin_ctz(m);
+    }
+    return find_byte_scalar(str + i, len - i, c);
+}
+
+
+/**
+ * Find a byte, 32 bytes at a time. -- private
+ */
+__attribute__((target("avx2")))
+static const char* find_byte_avx2(const char* str, size_t len, char c) {
+    const __m256i v = _mm256_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(str + i));
+        unsigned m = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, v));
+        if (m) return str + i + __builtin_ctz(m);
+    }
+    return find_byte_sse2(str + i, len - i, c);
+}
+
+
+/**
+ * Find a sequence of two or more bytes, 16 candidate positions at a time.
+ * -- private
+ */
+static const char* find_seq_sse2(const char* str, size_t len,
+    const char* delim, size_t delim_len) {
+    const __m128i first = _mm_set1_epi8(delim[0]);
+    const __m128i last = _mm_set1_epi8(delim[delim_len - 1]);
+    size_t i = 0;
+    for (; i + 16 + delim_len - 1 <= len; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(str + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(str + i + delim_len - 1));
+        unsigned m = (unsigned)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+        while (m) {
+            size_t at = i + (size_t)__builtin_ctz(m);
+            if (memcmp(str + at + 1, delim + 1, delim_len - 2) == 0) {
+                return str + at;
+            }
+            m &= m - 1;
+        }
+    }
+    return find_seq_scalar(str + i, len - i, delim, delim_len);
+}
+
+
+/**
+ * Find a sequence of two or more bytes, 32 candidate positions at a time.
+ * -- private
+ */
+__attribute__((target("avx2")))
+static const char* find_seq_avx2(const char* str, size_t len,
+    const char* delim, size_t delim_len) {
+    const __m256i first = _mm256_set1_epi8(delim[0]);
+    const __m256i last = _mm256_set1_epi8(delim[delim_len - 1]);
+    size_t i = 0;
+    for (; i + 32 + delim_len - 1 <= len; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(str + i));
+        __m256i b = _mm256_loadu_si256(
+            (const __m256i*)(str + i + delim_len - 1));
+        unsigned m = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last)));
+        while (m) {
+            size_t at = i + (size_t)__builtin_ctz(m);
+            if (memcmp(str + at + 1, delim + 1, delim_len - 2) == 0) {
+                return str + at;
+            }
+            m &= m - 1;
+        }
+    }
+    return find_seq_sse2(str + i, len - i, delim, delim_len);
+}
+
+
+/**
+ * Load the lookup tables of a set scanner into registers. -- private
+ */
+#define ANY_SETUP(scanner) \
+    const __m256i lut_lo = _mm256_broadcastsi128_si256( \
+        _mm_loadu_si128((const __m128i*)(scanner)->lut)); \
+    const __m256i lut_hi = _mm256_broadcastsi128_si256( \
+        _mm_loadu_si128((const __m128i*)((scanner)->lut + 16))); \
+    const __m256i bits = _mm256_setr_epi8( \
+        1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, \
+        1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128); \
+    const __m256i nibble = _mm256_set1_epi8(0x0f)
+
+/**
+ * The mask of the bytes of a 32-byte block that are in the set. Bytes of
+ * 0x80 and up have the sign bit set and use the high table. -- private
+ */
+__attribute__((target("avx2")))
+static inline unsigned any_mask_avx2(__m256i x, __m256i lut_lo, __m256i lut_hi,
+    __m256i bits, __m256i nibble) {
+    __m256i lo = _mm256_and_si256(x, nibble);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble);
+    __m256i row = _mm256_blendv_epi8(_mm256_shuffle_epi8(lut_lo, lo),
+        _mm256_shuffle_epi8(lut_hi, lo), x);
+    __m256i bit = _mm256_shuffle_epi8(bits, hi);
+    return (unsigned)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit));
+}
+
+#define ANY_MASK(x) any_mask_avx2((x), lut_lo, lut_hi, bits, nibble)
+
+
+/**
+ * Find a byte of a set, 32 bytes at a time. -- private
+ */
+__attribute__((target("avx2")))
+static const char* find_any_avx2(const char* str, size_t len,
+    const StrScanner* scanner) {
+    ANY_SETUP(scanner);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        unsigned m = ANY_MASK(_mm256_loadu_si256((const __m256i*)(str + i)));
+        if (m) return str + i + __builtin_ctz(m);
+    }
+    return find_any_scalar(str + i, len - i, scanner);
+}
+
+
+/**
+ * Count the bytes of a set, 32 bytes at a time. -- private
+ */
+__attribute__((target("avx2")))
+static size_t count_any_avx2(const char* str, size_t len,
+    const StrScanner* scanner) {
+    ANY_SETUP(scanner);
+    size_t i = 0, n = 0;
+    for (; i + 32 <= len; i += 32) {
+        n += (size_t)__builtin_popcount(
+            ANY_MASK(_mm256_loadu_si256((const __m256i*)(str + i))));
+    }
+    for (; i < len; i++) n += (size_t)in_set(scanner, (unsigned char)str[i]);
+    return n;
+}
+
+
+/**
+ * Measure the leading run of bytes of a set, 32 bytes at a time. -- private
+ */
+__attribute__((target("avx2")))
+static size_t span_any_avx2(const char* str, size_t len,
+    const StrScanner* scanner) {
+    ANY_SETUP(scanner);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        unsigned m = ~ANY_MASK(_mm256_loadu_si256((const __m256i*)(str + i)));
+        if (m) return i + (size_t)__builtin_ctz(m);
+    }
+    while (i < len && in_set(scanner, (unsigned char)str[i])) i++;
+    return i;
+}
+#endif
+
+
+// Documentation in header file.
+int str_scanner_init(StrScanner* scanner, const char* delim,
+    size_t delim_len) {
+    if (!scanner || !delim || delim_len == 0) return -1;
+    memset(scanner, 0, sizeof(*scanner));
+    scanner->mode = delim_len == 1 ? SCAN_BYTE : SCAN_SEQ;
+    scanner->delim = delim;
+    scanner->delim_len = delim_len;
+    return 0;
+}
+
+
+// Documentation in header file.
+int str_scanner_init_any(StrScanner* scanner, const char* chars) {
+    if (!scanner || !chars) return -1;
+    CharSet set = { { 0 } };
+    for (const unsigned char* c = (const unsigned char*)chars; *c; c++) {
+        charset_add(&set, *c);
+    }
+    return str_scanner_init_set(scanner, &set);
+}
+
+
+// Documentation in header file.
+int str_scanner_init_set(StrScanner* scanner, const CharSet* set) {
+    if (!scanner || !set) return -1;
+    memset(scanner, 0, sizeof(*scanner));
+    scanner->mode = SCAN_ANY;
+    scanner->set = *set;
+    for (int c = 0; c < 256; c++) {
+        if (!charset_has(set, (unsigned char)c)) continue;
+        scanner->lut[(c >> 7) * 16 + (c & 15)] |= (uint8_t)(1 << ((c >> 4) & 7));
+    }
+    return 0;
+}
+
+
+// Documentation in header file.
+const char* str_scan(const StrScanner* scanner, const char* str, size_t len) {
+    if (!scanner || !str) return NULL;
+    switch (scanner->mode) {
+    case SCAN_BYTE:
+#ifdef SCAN_X86
+        if (__builtin_cpu_supports("avx2")) {
+            return find_byte_avx2(str, len, scanner->delim[0]);
+        }
+        return find_byte_sse2(str, len, scanner->delim[0]);
+#else
+        return find_byte_scalar(str, len, scanner->delim[0]);
+#endif
+    case SCAN_SEQ:
+#ifdef SCAN_X86
+        if (__builtin_cpu_supports("avx2")) {
+            return find_seq_avx2(str, len, scanner->delim, scanner->delim_len);
+        }
+        return find_seq_sse2(str, len, scanner->delim, scanner->delim_len);
+#else
+        return find_seq_scalar(str, len, scanner->delim, scanner->delim_len);
+#endif
+    case SCAN_ANY:
+#ifdef SCAN_X86
+        if (__builtin_cpu_supports("avx2")) {
+            return find_any_avx2(str, len, scanner);
+        }
+#endif
+        return find_any_scalar(str, len, scanner);
+    }
+    return NULL;
+}
+
+
+// Documentation in header file.
+size_t str_scan_match_len(const StrScanner* scanner) {
+    return scanner->mode == SCAN_ANY ? 1 : scanner->delim_len;
+}
+
+
+/**
+ * Check whether the vectorized set kernels can run. -- private
+ */
+static inline int have_avx2(void) {
+#ifdef SCAN_X86
+    return __builtin_cpu_supports("avx2");
+#else
+    return 0;
+#endif
+}
+
+
+/**
+ * Count the matches of a scanner with the kernels picked by the caller.
+ * -- private
+ */
+static size_t count_matches(const StrScanner* scanner, const char* str,
+    size_t len, int avx2) {
+#ifdef SCAN_X86
+    if (avx2 && scanner->mode == SCAN_ANY) {
+        return count_any_avx2(str, len, scanner);
+    }
+#else
+    (void)avx2;
+#endif
+    if (scanner->mode == SCAN_ANY) {
+        size_t n = 0;
+        for (size_t i = 0; i < len; i++) {
+            n += (size_t)in_set(scanner, (unsigned char)str[i]);
+        }
+        return n;
+    }
+    // Delimiters do not overlap: the search resumes after each match.
+    size_t n = 0;
+    const char* end = str + len;
+    const char* found;
+    while ((found = str_scan(scanner, str, (size_t)(end - str)))) {
+        n++;
+        str = found + scanner->delim_len;
+    }
+    return n;
+}
+
+
+/**
+ * Measure the leading run of set bytes with the kernels picked by the
+ * caller. -- private
+ */
+static size_t span_set(const StrScanner* scanner, const char* str,
+    size_t len, int avx2) {
+    if (scanner->mode != SCAN_ANY) return 0;
+#ifdef SCAN_X86
+    if (avx2) return span_any_avx2(str, len, scanner);
+#else
+    (void)avx2;
+#endif
+    size_t i = 0;
+    while (i < len && in_set(scanner, (unsigned char)str[i])) i++;
+    return i;
+}
+
+
+// Documentation in header file.
+const char* str_find_any(const StrScanner* scanner, const char* str,
+    size_t len) {
+    return str_scan(scanner, str, len);
+}
+
+
+// Documentation in header file.
+size_t str_count_any(const StrScanner* scanner, const char* str, size_t len) {
+    if (!scanner || !str) return 0;
+    return count_matches(scanner, str, len, have_avx2());
+}
+
+
+// Documentation in header file.
+size_t str_span(const StrScanner* scanner, const char* str, size_t len) {
+    if (!scanner || !str) return 0;
+    return span_set(scanner, str, len, have_avx2());
+}
+
+
+// Documentation in header file.
+size_t str_cspan(const StrScanner* scanner, const char* str, size_t len) {
+    if (!scanner || !str) return 0;
+    const char* found = str_scan(scanner, str, len);
+    return found ? (size_t)(found - str) : len;
+}
+
+
+// Documentation in header file.
+void str_find_any_batch(const StrScanner* scanner, const StrView* items,
+    size_t count, size_t* out) {
+    if (!scanner || !items || !out) return;
+    for (size_t i = 0; i < count; i++) {
+        const char* found = items[i].ptr
+            ? str_scan(scanner, items[i].ptr, items[i].len) : NULL;
+        out[i] = found ? (size_t)(found - items[i].ptr) : STR_NPOS;
+    }
+}
+
+
+// Documentation in header file.
+void str_count_any_batch(const StrScanner* scanner, const StrView* items,
+    size_t count, size_t* out) {
+    if (!scanner || !items || !out) return;
+    int avx2 = have_avx2();
+    for (size_t i = 0; i < count; i++) {
+        out[i] = items[i].ptr
+            ? count_matches(scanner, items[i].ptr, items[i].len, avx2) : 0;
+    }
+}
+
+
+// Documentation in header file.
+void str_span_batch(const StrScanner* scanner, const StrView* items,
+    size_t count, size_t* out) {
+    if (!scanner || !items || !out) return;
+    int avx2 = have_avx2();
+    for (size_t i = 0; i < count; i++) {
+        out[i] = items[i].ptr
+            ? span_set(scanner, items[i].ptr, items[i].len, avx2) : 0;
+    }
+}
+
+
+#ifdef TEST
+/**
+ * Reference search: the first position where the scanner matches.
+ */
+const char* naive_scan(const StrScanner* scanner, const char* str,
+    size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (scanner->mode == SCAN_ANY) {
+            if (in_set(scanner, (unsigned char)str[i])) return str + i;
+        } else if (i + scanner->delim_len <= len
+            && memcmp(str + i, scanner->delim, scanner->delim_len) == 0) {
+            return str + i;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Fill a buffer with bytes from a small alphabet, so that delimiters and
+ * partial delimiters are frequent.
+ */
+void fill_random(char* buf, size_t len, const char* alphabet, unsigned seed) {
+    size_t n = strlen(alphabet);
+    for (size_t i = 0; i < len; i++) {
+        seed = seed * 1103515245u + 12345u;
+        buf[i] = alphabet[(seed >> 16) % n];
+    }
+}
+
+/**
+ * Compare the scanner with the reference on every suffix of a buffer.
+ */
+void check_scanner(const StrScanner* scanner, const char* buf, size_t len) {
+    for (size_t start = 0; start < len; start++) {
+        const char* expected = naive_scan(scanner, buf + start, len - start);
+        assert(str_scan(scanner, buf + start, len - start) == expected);
+#ifdef SCAN_X86
+        const char* s = buf + start;
+        size_t n = len - start;
+        if (scanner->mode == SCAN_BYTE) {
+            assert(find_byte_sse2(s, n, scanner->delim[0]) == expected);
+        } else if (scanner->mode == SCAN_SEQ) {
+            assert(find_seq_sse2(s, n, scanner->delim, scanner->delim_len) == expected);
+            assert(find_seq_scalar(s, n, scanner->delim, scanner->delim_len) == expected);
+        } else {
+            assert(find_any_scalar(s, n, scanner) == expected);
+        }
+#endif
+    }
+}
+
+void test_str_scan_byte() {
+    char buf[300];
+    fill_random(buf, sizeof(buf), "abcdefghijklmnopqrstuvwxyz,", 1);
+    StrScanner scanner;
+    assert(str_scanner_init(&scanner, ",", 1) == 0);
+    assert(scanner.mode == SCAN_BYTE);
+    check_scanner(&scanner, buf, sizeof(buf));
+    assert(str_scan(&scanner, "abc", 3) == NULL);
+    assert(str_scan(&scanner, "", 0) == NULL);
+    assert(str_scanner_init(&scanner, ",", 0) == -1);
+}
+
+void test_str_scan_seq() {
+    char buf[300];
+    fill_random(buf, sizeof(buf), "ab-", 2);
+    const char* delims[] = { "--", "-a-", "ab-ba", "b--b-a-a" };
+    for (size_t d = 0; d < 4; d++) {
+        StrScanner scanner;
+        assert(str_scanner_init(&scanner, delims[d], strlen(delims[d])) == 0);
+        assert(scanner.mode == SCAN_SEQ);
+        check_scanner(&scanner, buf, sizeof(buf));
+    }
+    StrScanner scanner;
+    str_scanner_init(&scanner, "xyz", 3);
+    const char* s = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaxyz";
+    assert(str_scan(&scanner, s, strlen(s)) == s + 40);
+    assert(str_scan(&scanner, s, strlen(s) - 1) == NULL);
+    assert(str_scan_match_len(&scanner) == 3);
+}
+
+void test_str_scan_any() {
+    char buf[300];
+    fill_random(buf, sizeof(buf), "abcdefghij \t\n,;\x80\xff", 3);
+    StrScanner scanner;
+    assert(str_scanner_init_any(&scanner, " \t\n") == 0);
+    check_scanner(&scanner, buf, sizeof(buf));
+    assert(str_scanner_init_any(&scanner, ",;\xff") == 0);
+    check_scanner(&scanner, buf, sizeof(buf));
+    assert(str_scan_match_len(&scanner) == 1);
+    // Bytes from all 16 high nibbles.
+    char all[256];
+    for (int i = 0; i < 256; i++) all[i] = (char)((i * 7 + 3) & 0xff);
+    char set[] = { 0x01, 0x1f, 0x7f, (char)0x80, (char)0x9a, (char)0xfe, 0 };
+    assert(str_scanner_init_any(&scanner, set) == 0);
+    check_scanner(&scanner, all, sizeof(all));
+    // Sets may include the null byte.
+    CharSet nul = { { 1 } };
+    assert(str_scanner_init_set(&scanner, &nul) == 0);
+    check_scanner(&scanner, all, sizeof(all));
+    assert(str_scan(&scanner, "ab\0c", 4) != NULL);
+    // An empty set never matches.
+    assert(str_scanner_init_any(&scanner, "") == 0);
+    assert(str_scan(&scanner, buf, sizeof(buf)) == NULL);
+}
+
+void test_str_count_span() {
+    char buf[300];
+    fill_random(buf, sizeof(buf), "abcdef \t,", 4);
+    StrScanner ws;
+    str_scanner_init_any(&ws, " \t");
+    for (size_t start = 0; start < sizeof(buf); start++) {
+        const char* s = buf + start;
+        size_t len = sizeof(buf) - start, n = 0, span = 0, cspan = 0;
+        for (size_t i = 0; i < len; i++) n += s[i] == ' ' || s[i] == '\t';
+        while (span < len && (s[span] == ' ' || s[span] == '\t')) span++;
+        while (cspan < len && s[cspan] != ' ' && s[cspan] != '\t') cspan++;
+        assert(str_count_any(&ws, s, len) == n);
+        assert(str_span(&ws, s, len) == span);
+        assert(str_cspan(&ws, s, len) == cspan);
+        assert(count_matches(&ws, s, len, 0) == n);
+        assert(span_set(&ws, s, len, 0) == span);
+    }
+    char blanks[100];
+    memset(blanks, ' ', sizeof(blanks));
+    assert(str_span(&ws, blanks, sizeof(blanks)) == 100);
+    assert(str_find_any(&ws, "abc", 3) == NULL);
+
+    StrScanner seq;
+    str_scanner_init(&seq, "aa", 2);
+    assert(str_count_any(&seq, "aaaaa", 5) == 2);
+    assert(str_span(&seq, "aaaaa", 5) == 0);
+}
+
+void test_str_scan_batch() {
+    StrScanner digits;
+    str_scanner_init_any(&digits, "0123456789");
+    StrView items[] = { str_view("abc123"), str_view("42"), str_view(""),
+        str_view("none") };
+    size_t out[4];
+    str_find_any_batch(&digits, items, 4, out);
+    assert(out[0] == 3 && out[1] == 0 && out[2] == STR_NPOS && out[3] == STR_NPOS);
+    str_count_any_batch(&digits, items, 4, out);
+    assert(out[0] == 3 && out[1] == 2 && out[2] == 0 && out[3] == 0);
+    str_span_batch(&digits, items, 4, out);
+    assert(out[0] == 0 && out[1] == 2 && out[2] == 0 && out[3] == 0);
+    // A NULL view has no matches, whatever its length.
+    StrView none = { NULL, 8 };
+    str_find_any_batch(&digits, &none, 1, out);
+    assert(out[0] == STR_NPOS);
+    str_count_any_batch(&digits, &none, 1, out);
+    assert(out[0] == 0);
+    str_span_batch(&digits, &none, 1, out);
+    assert(out[0] == 0);
+}
+
+int main() {
+    test_str_scan_byte();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_str_scan_byte", "Passed");
+    test_str_scan_seq();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_str_scan_seq", "Passed");
+    test_str_scan_any();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_str_scan_any", "Passed");
+    test_str_count_span();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_str_count_span", "Passed");
+    test_str_scan_batch();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_str_scan_batch", "Passed");
+    return 0;
+}
+
+#endif // TEST
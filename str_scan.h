@@ -0,0 +1,181 @@
+/**
+ * Delimiter search in strings. (Header file)
+ *
+ * A StrScanner finds the next delimiter in a buffer, in one of three modes:
+ * a single byte, a multi-byte sequence, or any byte of a set. On x86-64 the
+ * search runs on 32-byte AVX2 or 16-byte SSE2 blocks, picked at run time
+ * from the CPU features, with a scalar fallback elsewhere.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _STR_SCAN_H_
+#define _STR_SCAN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "str_set.h"
+#include "str_view.h"
+
+/**
+ * The offset reported by the batch functions when nothing was found.
+ */
+#define STR_NPOS ((size_t)-1)
+
+/**
+ * The delimiter modes of a StrScanner.
+ */
+typedef enum {
+    SCAN_BYTE,   // One delimiter byte.
+    SCAN_SEQ,    // A delimiter sequence of two or more bytes.
+    SCAN_ANY     // Any byte of a set.
+} ScanMode;
+
+/**
+ * A prepared delimiter search.
+ *
+ * @param mode The delimiter mode.
+ * @param delim The delimiter sequence, for SCAN_BYTE and SCAN_SEQ. Not
+ * copied: it must outlive the scanner.
+ * @param delim_len The length of the delimiter sequence.
+ * @param set The delimiter bytes for SCAN_ANY.
+ * @param lut The lookup tables of the vectorized set search. -- private
+ */
+typedef struct {
+    ScanMode mode;
+    const char* delim;
+    size_t delim_len;
+    CharSet set;
+    uint8_t lut[32];
+} StrScanner;
+
+
+/**
+ * Prepare a search for a delimiter sequence.
+ *
+ * @param scanner The scanner to initialize.
+ * @param delim The delimiter.
+ * @param delim_len The length of the delimiter. Must not be zero.
+ * @return 0 on success, -1 on invalid input.
+ */
+int str_scanner_init(StrScanner* scanner, const char* delim,
+    size_t delim_len);
+
+/**
+ * Prepare a search for any byte of a set.
+ *
+ * @param scanner The scanner to initialize.
+ * @param chars The delimiter bytes, null terminated. Repeated bytes are
+ * allowed. An empty set never matches.
+ * @return 0 on success, -1 on invalid input.
+ */
+int str_scanner_init_any(StrScanner* scanner, const char* chars);
+
+/**
+ * Prepare a search for any byte of a character set.
+ *
+ * @param scanner The scanner to initialize.
+ * @param set The delimiter bytes. May include the null byte.
+ * @return 0 on success, -1 on invalid input.
+ */
+int str_scanner_init_set(StrScanner* scanner, const CharSet* set);
+
+/**
+ * Find the next delimiter in a buffer.
+ *
+ * @param scanner The scanner.
+ * @param str The buffer. Need not be null terminated.
+ * @param len The length of the buffer.
+ * @return A pointer to the first delimiter that lies entirely in the buffer,
+ * or NULL if there is none.
+ */
+const char* str_scan(const StrScanner* scanner, const char* str, size_t len);
+
+/**
+ * Return the length of the delimiters a scanner matches.
+ *
+ * @param scanner The scanner.
+ * @return The length of the delimiter sequence, or 1 for SCAN_ANY.
+ */
+size_t str_scan_match_len(const StrScanner* scanner);
+
+
+/**
+ * Find the first byte of a set. Same as str_scan(), named for use with
+ * scanners prepared by str_scanner_init_any() or str_scanner_init_set().
+ *
+ * @param scanner The scanner.
+ * @param str The buffer.
+ * @param len The length of the buffer.
+ * @return A pointer to the first match, or NULL if there is none.
+ */
+const char* str_find_any(const StrScanner* scanner, const char* str,
+    size_t len);
+
+/**
+ * Count the matches of a scanner in a buffer, in a single pass. For a set
+ * scanner, this is the number of bytes of the buffer in the set; for a
+ * sequence scanner, the number of non-overlapping occurrences.
+ *
+ * @param scanner The scanner.
+ * @param str The buffer.
+ * @param len The length of the buffer.
+ * @return The number of matches.
+ */
+size_t str_count_any(const StrScanner* scanner, const char* str, size_t len);
+
+/**
+ * Measure the leading run of bytes of a set, like strspn().
+ *
+ * @param scanner A scanner prepared by str_scanner_init_any() or
+ * str_scanner_init_set(). Other scanners give 0.
+ * @param str The buffer.
+ * @param len The length of the buffer.
+ * @return The number of leading bytes that are in the set.
+ */
+size_t str_span(const StrScanner* scanner, const char* str, size_t len);
+
+/**
+ * Measure the leading run of bytes before the first match, like strcspn().
+ *
+ * @param scanner The scanner.
+ * @param str The buffer.
+ * @param len The length of the buffer.
+ * @return The offset of the first match, or len if there is none.
+ */
+size_t str_cspan(const StrScanner* scanner, const char* str, size_t len);
+
+/**
+ * Run str_find_any() over an array of buffers.
+ *
+ * @param scanner The scanner.
+ * @param items The buffers.
+ * @param count The number of buffers.
+ * @param out Receives, for each buffer, the offset of its first match or
+ * STR_NPOS.
+ */
+void str_find_any_batch(const StrScanner* scanner, const StrView* items,
+    size_t count, size_t* out);
+
+/**
+ * Run str_count_any() over an array of buffers.
+ *
+ * @param out Receives the number of matches of each buffer.
+ */
+void str_count_any_batch(const StrScanner* scanner, const StrView* items,
+    size_t count, size_t* out);
+
+/**
+ * Run str_span() over an array of buffers.
+ *
+ * @param out Receives the leading run of set bytes of each buffer.
+ */
+void str_span_batch(const StrScanner* scanner, const StrView* items,
+    size_t count, size_t* out);
+
+
+#endif // _STR_SCAN_H_
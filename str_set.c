@@ -20,20 +20,110 @@
  // Documentation in header file.
 int str_contains(const char* haystack, char needle) {
     if (!haystack || needle == 0) return 0;
-    for (; *haystack; haystack++)
-        if (*haystack == needle) return 1;
-    return 0;
+    STATS_BEGIN(STATS_STR_CONTAINS);
+    // The C library searches a word or a vector register at a time.
+    const char* found = strchr(haystack, needle);
+    STATS_ELEMENTS(found ? (size_t)(found - haystack) + 1 : strlen(haystack));
+    return found != NULL;
+}
+
+
+// Documentation in header file.
+int str_contains_n(const char* haystack, size_t len, char needle) {
+    if (!haystack) return 0;
+    STATS_BEGIN(STATS_STR_CONTAINS);
+    const char* found = memchr(haystack, needle, len);
+    STATS_ELEMENTS(found ? (size_t)(found - haystack) + 1 : len);
+    return found != NULL;
 }
 
 
 // Documentation in header file.
 char* str_set(const char* letters) {
+    return str_set_ex(letters, NULL);
+}
+
+
+// Documentation in header file.
+char* str_set_ex(const char* letters, const Allocator* allocator) {
     if (!letters) return NULL;
-    char* ret = calloc(strlen(letters) + 1, sizeof(char)); // calloc inits mem with 0
-    int retPtr = 0;
-    for (int ix = 0; ix < strlen(letters); ix++) {
-        if (!str_contains(ret, letters[ix])) ret[retPtr++] = letters[ix];
+    STATS_BEGIN(STATS_STR_SET);
+    size_t len = strlen(letters);
+    STATS_ELEMENTS(len);
+    // At most 255 distinct characters, plus the null character.
+    size_t cap = len < 255 ? len + 1 : 256;
+    char* ret = allocator_alloc(allocator, cap);
+    if (!ret) return NULL;
+    CharSet seen = { { 0 } };
+    size_t ret_len = 0;
+    for (size_t ix = 0; ix < len; ix++) {
+        unsigned char c = (unsigned char)letters[ix];
+        if (!charset_has(&seen, c)) {
+            charset_add(&seen, c);
+            ret[ret_len++] = (char)c;
+        }
+    }
+    ret[ret_len] = '\0';
+    return ret;
+}
+
+
+/**
+ * Pack a table of 256 flags into a character set. -- private
+ */
+static CharSet charset_pack(const uint8_t seen[256]) {
+    CharSet set = { { 0 } };
+    for (int w = 0; w < 4; w++) {
+        uint64_t word = 0;
+        for (int b = 0; b < 64; b++) {
+            word |= (uint64_t)(seen[w * 64 + b] != 0) << b;
+        }
+        set.bits[w] = word;
+    }
+    return set;
+}
+
+
+// Documentation in header file.
+CharSet charset_from_str(const char* letters) {
+    if (!letters) {
+        CharSet empty = { { 0 } };
+        return empty;
+    }
+    return charset_from_bytes(letters, strlen(letters));
+}
+
+
+// Documentation in header file.
+CharSet charset_from_bytes(const char* data, size_t len) {
+    // Plain stores to a flag table have no dependency between iterations,
+    // unlike read-modify-write updates of the bitmap words.
+    uint8_t seen[256] = { 0 };
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; data && i < len; i++) seen[p[i]] = 1;
+    return charset_pack(seen);
+}
+
+
+// Documentation in header file.
+size_t charset_count(const CharSet* set) {
+    if (!set) return 0;
+    size_t n = 0;
+    for (int i = 0; i < 4; i++) n += (size_t)__builtin_popcountll(set->bits[i]);
+    return n;
+}
+
+
+// Documentation in header file.
+char* charset_to_str(const CharSet* set, const Allocator* allocator) {
+    if (!set) return NULL;
+    char* ret = allocator_alloc(allocator, charset_count(set) + 1);
+    if (!ret) return NULL;
+    size_t n = 0;
+    for (int c = 1; c < 256; c++) {
+        if (charset_has(set, (unsigned char)c)) ret[n++] = (char)c;
     }
+    ret[n] = '\0';
     return ret;
 }
 
@@ -51,6 +141,12 @@ void test_str_contains() {
     assert(!str_contains("abc", '0'));
     assert(!str_contains("abc", '1'));
     assert(!str_contains("abc", '2'));
+
+    const char record[] = { 'k', 0, 'v' };
+    assert(str_contains_n(record, sizeof(record), 'v'));
+    assert(str_contains_n(record, sizeof(record), '\0'));
+    assert(!str_contains_n(record, 2, 'v'));
+    assert(!str_contains_n(NULL, 3, 'k'));
 }
 
 void test_str_set() {
@@ -76,11 +172,76 @@ void test_str_set() {
     free(ret);
 }
 
+void test_str_set_ex() {
+    Arena arena;
+    arena_init(&arena, 0);
+    char* ret = str_set_ex("hello world", &arena.allocator);
+    assert(strcmp(ret, "helo wrd") == 0);
+    assert(!str_set_ex(NULL, &arena.allocator));
+    arena_destroy(&arena);
+}
+
+void test_charset() {
+    CharSet vowels = charset_from_str("aeiouaeiou");
+    CharSet letters = charset_from_str("abcde");
+    assert(charset_count(&vowels) == 5);
+    assert(charset_has(&vowels, 'e') && !charset_has(&vowels, 'b'));
+
+    CharSet u = charset_union(vowels, letters);
+    CharSet i = charset_intersect(vowels, letters);
+    CharSet d = charset_diff(letters, vowels);
+    char* s = charset_to_str(&u, NULL);
+    assert(strcmp(s, "abcdeiou") == 0);
+    free(s);
+    s = charset_to_str(&i, NULL);
+    assert(strcmp(s, "ae") == 0);
+    free(s);
+    s = charset_to_str(&d, NULL);
+    assert(strcmp(s, "bcd") == 0);
+    free(s);
+
+    CharSet c = charset_complement(vowels);
+    assert(charset_count(&c) == 255 - 5);
+    assert(!charset_has(&c, 'a') && charset_has(&c, 'z') && !charset_has(&c, 0));
+    assert(charset_has(&c, 0xff));
+    CharSet back = charset_complement(c);
+    assert(charset_count(&back) == 5 && charset_has(&back, 'u'));
+
+    const char blob[] = { 'x', 0, (char)0x80, 'x' };
+    CharSet b = charset_from_bytes(blob, sizeof(blob));
+    assert(charset_count(&b) == 3 && charset_has(&b, 0) && charset_has(&b, 0x80));
+    s = charset_to_str(&b, NULL);
+    assert(strcmp(s, "x\x80") == 0);
+    free(s);
+
+    CharSet empty = charset_from_str(NULL);
+    assert(charset_count(&empty) == 0);
+}
+
+void test_str_set_large() {
+    // All 255 non-null bytes, repeated, keep their first-seen order.
+    size_t len = 255 * 400;
+    char* input = malloc(len + 1);
+    for (size_t ix = 0; ix < len; ix++) input[ix] = (char)(255 - ix % 255);
+    input[len] = '\0';
+    char* ret = str_set(input);
+    assert(strlen(ret) == 255);
+    assert((unsigned char)ret[0] == 255 && ret[254] == 1);
+    free(ret);
+    free(input);
+}
+
 int main() {
     test_str_contains();
     printf("%s - \033[0;32m%s\033[0m\n", "test_str_contains", "Passed");
     test_str_set();
     printf("%s - \033[0;32m%s\033[0m\n", "test_str_set", "Passed");
+    test_str_set_ex();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_str_set_ex", "Passed");
+    test_charset();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_charset", "Passed");
+    test_str_set_large();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_str_set_large", "Passed");
     return 0;
 }
 
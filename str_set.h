@@ -10,6 +10,19 @@
 #ifndef _STR_SET_H_
 #define _STR_SET_H_
 
+#include <stddef.h>
+#include <stdint.h>
+#include "allocator.h"
+
+/**
+ * A set of byte values, one bit per value.
+ *
+ * @param bits Byte c is in the set if bit c % 64 of bits[c / 64] is set.
+ */
+typedef struct {
+    uint64_t bits[4];
+} CharSet;
+
 
 /**
  * Checks if the given string contains the given character.
@@ -21,7 +34,19 @@
 int str_contains(const char* haystack, char needle);
 
 /**
- * Returns a set of characters from the given string.
+ * Checks if a buffer of explicit length contains the given byte. The buffer
+ * need not be null terminated, and the null byte can be searched for.
+ *
+ * @param haystack The buffer to check.
+ * @param len The length of the buffer.
+ * @param needle The byte to check for.
+ * @return 1 if the buffer contains the byte, 0 otherwise.
+ */
+int str_contains_n(const char* haystack, size_t len, char needle);
+
+/**
+ * Returns a set of characters from the given string, in the order in which
+ * they first appear. Runs in a single pass over the string.
  *
  * @param letters The string to get the set from.
  * @return A set of characters from the given string.
@@ -29,5 +54,109 @@ int str_contains(const char* haystack, char needle);
  */
 char* str_set(const char* letters);
 
+/**
+ * Returns a set of characters from the given string, allocating from the
+ * given allocator.
+ *
+ * @param letters The string to get the set from.
+ * @param allocator The allocator for the result, NULL for malloc().
+ * @return A set of characters from the given string.
+ */
+char* str_set_ex(const char* letters, const Allocator* allocator);
+
+
+/**
+ * Checks if a byte is in a character set.
+ *
+ * @param set The set.
+ * @param c The byte.
+ * @return 1 if the byte is in the set, 0 otherwise.
+ */
+static inline int charset_has(const CharSet* set, unsigned char c) {
+    return (int)((set->bits[c >> 6] >> (c & 63)) & 1);
+}
+
+/**
+ * Adds a byte to a character set.
+ *
+ * @param set The set.
+ * @param c The byte.
+ */
+static inline void charset_add(CharSet* set, unsigned char c) {
+    set->bits[c >> 6] |= (uint64_t)1 << (c & 63);
+}
+
+/**
+ * Returns the bytes that are in either of two sets.
+ */
+static inline CharSet charset_union(CharSet a, CharSet b) {
+    for (int i = 0; i < 4; i++) a.bits[i] |= b.bits[i];
+    return a;
+}
+
+/**
+ * Returns the bytes that are in both of two sets.
+ */
+static inline CharSet charset_intersect(CharSet a, CharSet b) {
+    for (int i = 0; i < 4; i++) a.bits[i] &= b.bits[i];
+    return a;
+}
+
+/**
+ * Returns the bytes of the first set that are not in the second.
+ */
+static inline CharSet charset_diff(CharSet a, CharSet b) {
+    for (int i = 0; i < 4; i++) a.bits[i] &= ~b.bits[i];
+    return a;
+}
+
+/**
+ * Returns the bytes that are not in a set. The null byte is never part of
+ * the complement, so that the result can be used with null terminated
+ * strings.
+ */
+static inline CharSet charset_complement(CharSet a) {
+    for (int i = 0; i < 4; i++) a.bits[i] = ~a.bits[i];
+    a.bits[0] &= ~(uint64_t)1;
+    return a;
+}
+
+/**
+ * Returns a character set of the characters of a string.
+ *
+ * @param letters The string. NULL gives an empty set.
+ * @return The set.
+ */
+CharSet charset_from_str(const char* letters);
+
+/**
+ * Returns a character set of the bytes of a buffer, which may include null
+ * bytes.
+ *
+ * @param data The buffer.
+ * @param len The length of the buffer.
+ * @return The set.
+ */
+CharSet charset_from_bytes(const char* data, size_t len);
+
+/**
+ * Returns the number of bytes in a character set.
+ *
+ * @param set The set.
+ * @return The number of bytes.
+ */
+size_t charset_count(const CharSet* set);
+
+/**
+ * Returns the characters of a set as a string, in ascending byte order. The
+ * null byte cannot appear in a string and is left out.
+ *
+ * @param set The set.
+ * @param allocator The allocator for the result, NULL for malloc().
+ * @return The string, or NULL on allocation failure.
+ * @note The caller is responsible for freeing the returned string.
+ */
+char* charset_to_str(const CharSet* set, const Allocator* allocator);
+
 
 #endif /* _STR_SET_H_ */
@@ -11,6 +11,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "str_split.h"
+#include "str_scan.h"
 #ifdef TEST
 #include <stdio.h>
 #include <assert.h>
@@ -21,12 +22,18 @@
 // Private classes - not exposed in the header
 //
 /**
- * The result of a collect operation.
- * @param el The current element.
- * @param nx The next element.
- * @param next 1 if there is a next element, 0 otherwise.
+ * The state of a split in progress.
+ * @param p The start of the next element.
+ * @param end The end of the string.
+ * @param scanner The delimiter search, NULL to split into single characters.
+ * @param done 1 once the last element was returned, 0 otherwise.
  */
-typedef struct { char* el; char* nx; int next; } CollectResponse; // private
+typedef struct {
+    const char* p;
+    const char* end;
+    const StrScanner* scanner;
+    int done;
+} SplitIter; // private
 
 /**
  * The result of a split operation.
@@ -39,55 +46,182 @@ typedef struct { char** list; size_t length; } SplitResult;
 /**
  * Find the next element before the separator. -- private
  *
- * @param curr_el The current element.
- * @param sep The separator.
- * @return A copy of the current element and the next element.
+ * With an empty separator every character is an element, followed by one
+ * empty element. Otherwise the elements are the text between separators,
+ * the last one running to the end of the string.
+ *
+ * @param it The split in progress.
+ * @param el Receives the element.
+ * @return 1 if an element was found, 0 once the string is exhausted.
  */
-CollectResponse collect_element(char* curr_el, const char* sep) {
-    CollectResponse res;
-    char* found = strstr(curr_el, sep);
-    if (!found) { // No separator found, the whole string is the element
-        res.el = strdup(curr_el);
-        res.nx = curr_el + strlen(curr_el);
-        res.next = 0;
-    } else if (sep[0] == 0) { // if separator is empty return a 1-char string
-        res.el = malloc(2);
-        res.el[0] = curr_el[0];
-        res.el[1] = 0;
-        if (curr_el[0] == 0) {
-            res.nx = curr_el;
-            res.next = 0;
-        } else {
-            res.nx = curr_el + 1;
-            res.next = 1;
+static int collect_element(SplitIter* it, StrView* el) {
+    if (it->done) return 0;
+    if (!it->scanner) {
+        el->ptr = it->p;
+        el->len = it->p < it->end ? 1 : 0;
+        if (it->p < it->end) it->p++;
+        else it->done = 1;
+        return 1;
+    }
+    const char* found = str_scan(it->scanner, it->p, (size_t)(it->end - it->p));
+    el->ptr = it->p;
+    if (found) {
+        el->len = (size_t)(found - it->p);
+        it->p = found + str_scan_match_len(it->scanner);
+    } else {
+        el->len = (size_t)(it->end - it->p);
+        it->done = 1;
+    }
+    return 1;
+}
+
+/**
+ * Copy the elements of a split into a null terminated list. -- private
+ */
+static char** collect_strings(SplitIter* it, const Allocator* allocator) {
+    SplitResult result = { .list = NULL, .length = 0 };
+    size_t cap = 0; // capacity of result.list, including the NULL
+    StrView el;
+    while (collect_element(it, &el)) {
+        if (result.length + 1 >= cap) {
+            size_t new_cap = cap ? cap * 2 : 8;
+            char** tmp = allocator_realloc(allocator, result.list,
+                cap * sizeof(void*), new_cap * sizeof(void*));
+            if (!tmp) goto failed;
+            result.list = tmp;
+            cap = new_cap;
+        }
+        result.list[result.length] = str_view_dup(el, allocator);
+        if (!result.list[result.length]) goto failed;
+        result.length++;
+    }
+    result.list[result.length] = NULL;
+    return result.list;
+failed:
+    if (result.list) {
+        for (size_t i = 0; i < result.length; i++) {
+            allocator_free(allocator, result.list[i]);
         }
-    } else if (found) { // return the string before next separator
-        found[0] = 0;
-        res.el = strdup(curr_el);
-        res.nx = found + strlen(sep);
-        res.next = 1;
+        allocator_free(allocator, result.list);
     }
-    return res;
+    return NULL;
+}
+
+/**
+ * Append a view to a growing array of views. -- private
+ */
+static int push_view(StrView** views, size_t* n, size_t* cap,
+    const char* ptr, size_t len) {
+    if (*n == *cap) {
+        size_t new_cap = *cap ? *cap * 2 : 16;
+        STATS_ALLOC((new_cap - *cap) * sizeof(StrView));
+        StrView* tmp = realloc(*views, new_cap * sizeof(StrView));
+        if (!tmp) return -1;
+        *views = tmp;
+        *cap = new_cap;
+    }
+    (*views)[*n].ptr = ptr;
+    (*views)[*n].len = len;
+    (*n)++;
+    return 0;
+}
+
+/**
+ * Collect the elements of a split as views. -- private
+ */
+static StrView* collect_views(SplitIter* it, size_t* count) {
+    StrView* views = NULL;
+    size_t n = 0, cap = 0;
+    StrView el;
+    while (collect_element(it, &el)) {
+        if (push_view(&views, &n, &cap, el.ptr, el.len) != 0) {
+            free(views);
+            return NULL;
+        }
+    }
+    *count = n;
+    return views;
 }
 
 // Documentation in header file.
 char** str_split(const char* str, const char* delim) {
+    return str_split_ex(str, delim, NULL);
+}
+
+// Documentation in header file.
+char** str_split_ex(const char* str, const char* delim,
+    const Allocator* allocator) {
     if (!str || !delim) {
         return NULL;
     }
-    char* local = strdup(str);
-    SplitResult result = { .length = 0 };
-    CollectResponse resp = { .nx = local };
-    do {
-        resp = collect_element(resp.nx, delim);
-        result.list = realloc(result.list, (result.length + 1) * sizeof(void*));
-        result.list[result.length] = resp.el;
-        result.length++;
-    } while (resp.next);
-    result.list = realloc(result.list, (result.length + 1) * sizeof(void*));
-    result.list[result.length] = NULL;
-    free(local);
-    return result.list;
+    STATS_BEGIN(STATS_STR_SPLIT);
+    StrScanner scanner;
+    SplitIter it = { .p = str, .end = str + strlen(str), .done = 0 };
+    STATS_ELEMENTS(it.end - it.p);
+    it.scanner = str_scanner_init(&scanner, delim, strlen(delim)) == 0
+        ? &scanner : NULL;
+    return collect_strings(&it, allocator);
+}
+
+// Documentation in header file.
+char** str_split_any(const char* str, const char* chars) {
+    return str_split_any_ex(str, chars, NULL);
+}
+
+// Documentation in header file.
+char** str_split_any_ex(const char* str, const char* chars,
+    const Allocator* allocator) {
+    if (!str || !chars) {
+        return NULL;
+    }
+    STATS_BEGIN(STATS_STR_SPLIT);
+    StrScanner scanner;
+    str_scanner_init_any(&scanner, chars);
+    SplitIter it = { .p = str, .end = str + strlen(str), .scanner = &scanner,
+        .done = 0 };
+    STATS_ELEMENTS(it.end - it.p);
+    return collect_strings(&it, allocator);
+}
+
+// Documentation in header file.
+StrView* str_split_views(const char* str, const char* delim, size_t* count) {
+    if (!str || !delim) {
+        if (count) *count = 0;
+        return NULL;
+    }
+    return str_split_views_n(str, strlen(str), delim, strlen(delim), count);
+}
+
+// Documentation in header file.
+StrView* str_split_views_n(const char* str, size_t len, const char* delim,
+    size_t delim_len, size_t* count) {
+    if (count) *count = 0;
+    if (!str || !delim || !count) {
+        return NULL;
+    }
+    STATS_BEGIN(STATS_STR_SPLIT_VIEWS);
+    STATS_ELEMENTS(len);
+    StrScanner scanner;
+    SplitIter it = { .p = str, .end = str + len, .done = 0 };
+    it.scanner = str_scanner_init(&scanner, delim, delim_len) == 0
+        ? &scanner : NULL;
+    return collect_views(&it, count);
+}
+
+// Documentation in header file.
+StrView* str_split_views_any(const char* str, size_t len, const char* chars,
+    size_t* count) {
+    if (count) *count = 0;
+    if (!str || !chars || !count) {
+        return NULL;
+    }
+    STATS_BEGIN(STATS_STR_SPLIT_VIEWS);
+    STATS_ELEMENTS(len);
+    StrScanner scanner;
+    str_scanner_init_any(&scanner, chars);
+    SplitIter it = { .p = str, .end = str + len, .scanner = &scanner,
+        .done = 0 };
+    return collect_views(&it, count);
 }
 
 // Documentation in header file.
@@ -154,9 +288,116 @@ void test_str_split() {
     printf("%s - \033[0;32m%s\033[0m\n", "test_split", "Passed");
 }
 
+/**
+ * Unit tests for str_split_ex.
+ */
+void test_str_split_ex() {
+    Arena arena;
+    arena_init(&arena, 0);
+    char** result = str_split_ex("a,b,c,d,e,f,g,h,i,j", ",", &arena.allocator);
+    assert(strcmp(result[0], "a") == 0);
+    assert(strcmp(result[9], "j") == 0);
+    assert(result[10] == NULL);
+    arena_destroy(&arena);
+
+    result = str_split_ex("a,b", ",", NULL);
+    assert(strcmp(result[1], "b") == 0);
+    str_split_free(result);
+
+    printf("%s - \033[0;32m%s\033[0m\n", "test_split_ex", "Passed");
+}
+
+
+/**
+ * Unit tests for str_split_views.
+ */
+void test_str_split_views() {
+    const char* input = "a,bb,,ccc,";
+    size_t count;
+    StrView* views = str_split_views(input, ",", &count);
+    assert(count == 5);
+    assert(views[0].ptr == input && views[0].len == 1);
+    assert(str_view_eq_str(views[1], "bb"));
+    assert(views[2].len == 0);
+    assert(str_view_eq_str(views[3], "ccc"));
+    assert(views[4].ptr == input + 10 && views[4].len == 0);
+    free(views);
+
+    // The views give the same elements as str_split().
+    const char* cases[][2] = { { "a,b,c", "" }, { "a,b,c", "b" },
+        { "a,b,c", "a,b,c" }, { "", "," }, { "", "" }, { "x--y--z", "--" } };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        char** expected = str_split(cases[c][0], cases[c][1]);
+        views = str_split_views(cases[c][0], cases[c][1], &count);
+        size_t i = 0;
+        for (; expected[i]; i++) {
+            assert(i < count);
+            assert(str_view_eq_str(views[i], expected[i]));
+        }
+        assert(i == count);
+        free(views);
+        str_split_free(expected);
+    }
+
+    // Explicit lengths allow embedded null characters.
+    const char buf[] = { 'k', '\0', 'v', '|', 'w' };
+    views = str_split_views_n(buf, sizeof(buf), "|", 1, &count);
+    assert(count == 2 && views[0].len == 3 && views[1].ptr == buf + 4);
+    char* first = str_view_dup(views[0], NULL);
+    assert(first[0] == 'k' && first[1] == '\0' && first[3] == '\0');
+    free(first);
+    free(views);
+
+    assert(str_split_views(NULL, ",", &count) == NULL && count == 0);
+    printf("%s - \033[0;32m%s\033[0m\n", "test_split_views", "Passed");
+}
+
+
+/**
+ * Unit tests for str_split_any.
+ */
+void test_str_split_any() {
+    char** result = str_split_any("a b\tc,,d", " \t,");
+    const char* expected[] = { "a", "b", "c", "", "d" };
+    for (int i = 0; i < 5; i++) assert(strcmp(result[i], expected[i]) == 0);
+    assert(result[5] == NULL);
+    str_split_free(result);
+
+    result = str_split_any("abc", "");
+    assert(strcmp(result[0], "abc") == 0 && result[1] == NULL);
+    str_split_free(result);
+
+    const char* line = "2026-10-16 12:00:01 GET /index.html 200 512";
+    size_t count;
+    StrView* views = str_split_views_any(line, strlen(line), " :", &count);
+    assert(count == 8);
+    assert(str_view_eq_str(views[0], "2026-10-16"));
+    assert(str_view_eq_str(views[3], "01"));
+    assert(str_view_eq_str(views[7], "512"));
+    free(views);
+
+    // Long inputs go through the vectorized search.
+    char long_line[1000];
+    for (int i = 0; i < 999; i++) long_line[i] = i % 100 == 99 ? ';' : 'x';
+    long_line[999] = 0;
+    result = str_split(long_line, ";");
+    for (int i = 0; i < 9; i++) assert(strlen(result[i]) == 99);
+    assert(strlen(result[9]) == 99 && result[10] == NULL);
+    str_split_free(result);
+    result = str_split(long_line, "x;x");
+    assert(strlen(result[0]) == 98 && strlen(result[1]) == 97);
+    str_split_free(result);
+
+    assert(str_split_any(NULL, ",") == NULL);
+    printf("%s - \033[0;32m%s\033[0m\n", "test_split_any", "Passed");
+}
+
 
 int main() {
     test_str_split();
+    test_str_split_any();
+    test_str_split_ex();
+    test_str_split_views();
     return 0;
 }
 
@@ -11,7 +11,13 @@
 #ifndef __STR_SPLIT_H__
 #define __STR_SPLIT_H__
 
+#include <stddef.h>
+#include "allocator.h"
+#include "str_view.h"
+
 extern void free_list(void** list, size_t list_len);
+extern void free_list_ex(void** list, size_t list_len,
+    const Allocator* allocator);
 
 /**
  * Split a string by a separator.
@@ -23,4 +29,89 @@ extern void free_list(void** list, size_t list_len);
  */
 char** str_split(const char* str, const char* delim);
 
+/**
+ * Split a string by a separator, allocating from the given allocator.
+ *
+ * @param str The string to split.
+ * @param delim The separator.
+ * @param allocator The allocator for the list and the strings, NULL for
+ * malloc(). Free the result with free_list_ex() and the same allocator.
+ *
+ * @return A list of strings.
+ */
+char** str_split_ex(const char* str, const char* delim,
+    const Allocator* allocator);
+
+/**
+ * Free a list returned by str_split() or str_split_any(), and its strings.
+ *
+ * @param result The list of strings.
+ */
+void str_split_free(char** result);
+
+/**
+ * Split a string at any character of a set. Every occurrence of a character
+ * of the set separates two elements, so adjacent separators give empty
+ * elements.
+ *
+ * @param str The string to split.
+ * @param chars The separator characters, such as " \t\n" or ",;".
+ *
+ * @return A list of strings.
+ */
+char** str_split_any(const char* str, const char* chars);
+
+/**
+ * Split a string at any character of a set, allocating from the given
+ * allocator. See str_split_any() and str_split_ex().
+ */
+char** str_split_any_ex(const char* str, const char* chars,
+    const Allocator* allocator);
+
+/**
+ * Split a string by a separator into views of the string. Gives the same
+ * elements as str_split(), without modifying or copying the string.
+ *
+ * @param str The string to split.
+ * @param delim The separator.
+ * @param count Receives the number of views.
+ *
+ * @return An array of views into str, or NULL on invalid input or
+ * allocation failure. The array is a single allocation that must be freed
+ * by the caller; the views stay valid as long as str.
+ */
+StrView* str_split_views(const char* str, const char* delim, size_t* count);
+
+/**
+ * Split a buffer of explicit length by a separator of explicit length into
+ * views of the buffer. See str_split_views(). Neither the buffer nor the
+ * separator needs to be null terminated.
+ *
+ * @param str The buffer to split.
+ * @param len The length of the buffer.
+ * @param delim The separator.
+ * @param delim_len The length of the separator.
+ * @param count Receives the number of views.
+ *
+ * @return An array of views into str, or NULL on invalid input or
+ * allocation failure.
+ */
+StrView* str_split_views_n(const char* str, size_t len, const char* delim,
+    size_t delim_len, size_t* count);
+
+/**
+ * Split a buffer of explicit length at any character of a set into views of
+ * the buffer. See str_split_any() and str_split_views().
+ *
+ * @param str The buffer to split.
+ * @param len The length of the buffer.
+ * @param chars The separator characters.
+ * @param count Receives the number of views.
+ *
+ * @return An array of views into str, or NULL on invalid input or
+ * allocation failure.
+ */
+StrView* str_split_views_any(const char* str, size_t len, const char* chars,
+    size_t* count);
+
 #endif // __STR_SPLIT_H__
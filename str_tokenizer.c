@@ -0,0 +1,275 @@
+/**
+ * Incremental tokenizer for chunked input.
+ *
+ * Tokens that lie entirely inside a chunk are passed to the callback as
+ * views of the chunk, without a copy. Only the unfinished token at the end
+ * of a chunk is copied, into the carry buffer. A delimiter of n bytes can
+ * start in the last n - 1 bytes of the carry and end in the next chunk, so
+ * those bytes are searched again together with the start of the chunk.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "str_tokenizer.h"
+#ifdef TEST
+#include <assert.h>
+#include <stdio.h>
+#include "str_split.h"
+#endif
+
+
+/**
+ * Make room for len more bytes in the carry buffer. -- private
+ */
+static int carry_reserve(StrTokenizer* t, size_t len) {
+    if (t->carry_cap - t->carry_len >= len) return 0;
+    size_t cap = t->carry_cap ? t->carry_cap : 64;
+    while (cap - t->carry_len < len) cap *= 2;
+    char* tmp = realloc(t->carry, cap);
+    if (!tmp) return -1;
+    t->carry = tmp;
+    t->carry_cap = cap;
+    return 0;
+}
+
+
+/**
+ * Append bytes to the carry buffer. -- private
+ */
+static int carry_append(StrTokenizer* t, const char* data, size_t len) {
+    if (len == 0) return 0;
+    if (carry_reserve(t, len) != 0) return -1;
+    memcpy(t->carry + t->carry_len, data, len);
+    t->carry_len += len;
+    return 0;
+}
+
+
+/**
+ * Pass a token to the callback. -- private
+ */
+static void emit(StrTokenizer* t, const char* ptr, size_t len) {
+    StrView token = { .ptr = ptr, .len = len };
+    t->fn(t->ctx, token, t->count++);
+}
+
+
+// Documentation in header file.
+int str_tokenizer_init(StrTokenizer* tokenizer, const char* delim,
+    TokenFn fn, void* ctx) {
+    if (!tokenizer || !delim || !delim[0] || !fn) return -1;
+    memset(tokenizer, 0, sizeof(*tokenizer));
+    size_t len = strlen(delim);
+    tokenizer->delim = malloc(len + 1);
+    if (!tokenizer->delim) return -1;
+    memcpy(tokenizer->delim, delim, len + 1);
+    str_scanner_init(&tokenizer->scanner, tokenizer->delim, len);
+    tokenizer->fn = fn;
+    tokenizer->ctx = ctx;
+    return 0;
+}
+
+
+// Documentation in header file.
+int str_tokenizer_init_any(StrTokenizer* tokenizer, const char* chars,
+    TokenFn fn, void* ctx) {
+    if (!tokenizer || !chars || !fn) return -1;
+    memset(tokenizer, 0, sizeof(*tokenizer));
+    str_scanner_init_any(&tokenizer->scanner, chars);
+    tokenizer->fn = fn;
+    tokenizer->ctx = ctx;
+    return 0;
+}
+
+
+/**
+ * Look for a delimiter that starts in the carry buffer and ends in the
+ * chunk. On a match, emit the pending token and return the offset in the
+ * chunk just past the delimiter; otherwise return 0. Returns (size_t)-1 on
+ * allocation failure. -- private
+ */
+static size_t match_boundary(StrTokenizer* t, const char* data, size_t len) {
+    size_t tail = str_scan_match_len(&t->scanner) - 1;
+    if (tail == 0 || t->carry_len == 0) return 0;
+    size_t from = t->carry_len > tail ? t->carry_len - tail : 0;
+    size_t old_len = t->carry_len;
+    size_t extra = len < tail ? len : tail;
+    if (carry_append(t, data, extra) != 0) return (size_t)-1;
+    const char* found = str_scan(&t->scanner, t->carry + from,
+        t->carry_len - from);
+    t->carry_len = old_len;
+    if (!found) return 0;
+    // No delimiter lies entirely in the carry, so the match ends in the chunk.
+    size_t at = (size_t)(found - t->carry);
+    emit(t, t->carry, at);
+    t->carry_len = 0;
+    return at + tail + 1 - old_len;
+}
+
+
+// Documentation in header file.
+int str_tokenizer_feed(StrTokenizer* tokenizer, const char* data,
+    size_t len) {
+    if (!tokenizer || (!data && len > 0)) return -1;
+    StrTokenizer* t = tokenizer;
+    size_t match_len = str_scan_match_len(&t->scanner);
+    size_t i = match_boundary(t, data, len);
+    if (i == (size_t)-1) return -1;
+    while (i < len) {
+        const char* found = str_scan(&t->scanner, data + i, len - i);
+        if (!found) break;
+        size_t at = (size_t)(found - data);
+        if (t->carry_len > 0) {
+            // The token started in an earlier chunk.
+            if (carry_append(t, data + i, at - i) != 0) return -1;
+            emit(t, t->carry, t->carry_len);
+            t->carry_len = 0;
+        } else {
+            emit(t, data + i, at - i);
+        }
+        i = at + match_len;
+    }
+    if (i < len && carry_append(t, data + i, len - i) != 0) return -1;
+    return 0;
+}
+
+
+// Documentation in header file.
+void str_tokenizer_finish(StrTokenizer* tokenizer) {
+    if (!tokenizer) return;
+    emit(tokenizer, tokenizer->carry ? tokenizer->carry : "",
+        tokenizer->carry_len);
+    tokenizer->carry_len = 0;
+    tokenizer->count = 0;
+}
+
+
+// Documentation in header file.
+void str_tokenizer_free(StrTokenizer* tokenizer) {
+    if (!tokenizer) return;
+    free(tokenizer->carry);
+    free(tokenizer->delim);
+    tokenizer->carry = NULL;
+    tokenizer->delim = NULL;
+    tokenizer->carry_len = 0;
+    tokenizer->carry_cap = 0;
+}
+
+
+#ifdef TEST
+/**
+ * Collects the tokens as null terminated copies.
+ */
+typedef struct {
+    char* tokens[256];
+    size_t count;
+} Collected;
+
+void collect(void* ctx, StrView token, size_t index) {
+    Collected* c = ctx;
+    assert(index == c->count);
+    c->tokens[c->count++] = str_view_dup(token, NULL);
+}
+
+void collected_free(Collected* c) {
+    for (size_t i = 0; i < c->count; i++) free(c->tokens[i]);
+    c->count = 0;
+}
+
+/**
+ * Feed a string in chunks of every size from 1 to its length, and compare
+ * the tokens with str_split().
+ */
+void check_chunks(const char* input, const char* delim) {
+    char** expected = str_split(input, delim);
+    size_t len = strlen(input);
+    for (size_t chunk = 1; chunk <= len + 1; chunk++) {
+        Collected c = { .count = 0 };
+        StrTokenizer t;
+        assert(str_tokenizer_init(&t, delim, &collect, &c) == 0);
+        for (size_t i = 0; i < len; i += chunk) {
+            size_t n = len - i < chunk ? len - i : chunk;
+            assert(str_tokenizer_feed(&t, input + i, n) == 0);
+        }
+        str_tokenizer_finish(&t);
+        size_t k = 0;
+        for (; expected[k]; k++) {
+            assert(k < c.count);
+            assert(strcmp(c.tokens[k], expected[k]) == 0);
+        }
+        assert(k == c.count);
+        collected_free(&c);
+        str_tokenizer_free(&t);
+    }
+    str_split_free(expected);
+}
+
+void test_tokenizer_chunks() {
+    check_chunks("a,b,,c,", ",");
+    check_chunks("", ",");
+    check_chunks("no delimiter here", ",");
+    check_chunks("a--b---c----d--", "--");
+    check_chunks("one<=>two<=<=>three<=", "<=>");
+    check_chunks("abababababab", "abab");
+    check_chunks("x\r\ny\r\n\r\nz", "\r\n");
+}
+
+void test_tokenizer_any() {
+    Collected c = { .count = 0 };
+    StrTokenizer t;
+    assert(str_tokenizer_init_any(&t, " \t\n", &collect, &c) == 0);
+    const char* chunks[] = { "GET /in", "dex.html HT", "TP/1.1\n", "Host" };
+    for (int i = 0; i < 4; i++) {
+        assert(str_tokenizer_feed(&t, chunks[i], strlen(chunks[i])) == 0);
+    }
+    assert(c.count == 3);
+    assert(strcmp(c.tokens[1], "/index.html") == 0);
+    assert(strcmp(c.tokens[2], "HTTP/1.1") == 0);
+    str_tokenizer_finish(&t);
+    assert(c.count == 4 && strcmp(c.tokens[3], "Host") == 0);
+    collected_free(&c);
+    str_tokenizer_free(&t);
+}
+
+void count_token(void* ctx, StrView token, size_t _) {
+    size_t* longest = ctx;
+    if (token.len > *longest) *longest = token.len;
+}
+
+void test_tokenizer_bounded() {
+    // The carry never grows past the longest token, whatever the input size.
+    size_t longest = 0;
+    StrTokenizer t;
+    assert(str_tokenizer_init(&t, ";;", &count_token, &longest) == 0);
+    // A periodic stream of 48-byte tokens, fed in chunks that cut through
+    // tokens and delimiters at shifting offsets.
+    char stream[1100];
+    for (int i = 0; i < 1100; i++) stream[i] = i % 50 < 2 ? ';' : 'x';
+    for (size_t pos = 0; pos < 1000000; pos += 997) {
+        assert(str_tokenizer_feed(&t, stream + pos % 50, 997) == 0);
+    }
+    str_tokenizer_finish(&t);
+    assert(longest == 48);
+    assert(t.carry_cap <= 64);
+    str_tokenizer_free(&t);
+
+    assert(str_tokenizer_init(&t, "", &count_token, &longest) == -1);
+}
+
+int main() {
+    test_tokenizer_chunks();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_tokenizer_chunks", "Passed");
+    test_tokenizer_any();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_tokenizer_any", "Passed");
+    test_tokenizer_bounded();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_tokenizer_bounded", "Passed");
+    return 0;
+}
+
+#endif // TEST
@@ -0,0 +1,116 @@
+/**
+ * Incremental tokenizer for chunked input. (Header file)
+ *
+ * A StrTokenizer splits a stream that arrives in chunks of any size, such
+ * as reads from a socket, a pipe or a large file. Each chunk is passed to
+ * str_tokenizer_feed(), which calls back once per complete token. A token
+ * or a multi-byte delimiter cut by a chunk boundary is carried over to the
+ * next chunk, so the memory held is bounded by the longest token rather
+ * than the length of the input.
+ *
+ * The tokens are the same as those of str_split() over the concatenated
+ * chunks: the text between delimiters, with a last token running from the
+ * last delimiter to the end of the input, emitted by str_tokenizer_finish().
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _STR_TOKENIZER_H_
+#define _STR_TOKENIZER_H_
+
+#include <stddef.h>
+#include "str_scan.h"
+#include "str_view.h"
+
+/**
+ * Function type for token callbacks.
+ *
+ * @param ctx The context given to the tokenizer.
+ * @param token The token. Points into the chunk being fed or into the
+ * tokenizer, and is only valid during the call.
+ * @param index The index of the token in the stream.
+ */
+typedef void (*TokenFn)(void* ctx, StrView token, size_t index);
+
+/**
+ * The state of an incremental tokenizer.
+ *
+ * @param scanner The delimiter search.
+ * @param delim A copy of the delimiter sequence.
+ * @param carry The start of the pending token, received in earlier chunks.
+ * @param carry_len The number of pending bytes.
+ * @param carry_cap The capacity of the carry buffer.
+ * @param count The number of tokens emitted so far.
+ * @param fn The token callback.
+ * @param ctx The context of the token callback.
+ */
+typedef struct {
+    StrScanner scanner;
+    char* delim;
+    char* carry;
+    size_t carry_len;
+    size_t carry_cap;
+    size_t count;
+    TokenFn fn;
+    void* ctx;
+} StrTokenizer;
+
+
+/**
+ * Initialize a tokenizer that splits at a delimiter sequence.
+ *
+ * @param tokenizer The tokenizer.
+ * @param delim The delimiter, null terminated. Must not be empty.
+ * @param fn The callback to receive the tokens.
+ * @param ctx The context passed to the callback.
+ * @return 0 on success, -1 on invalid input or allocation failure.
+ */
+int str_tokenizer_init(StrTokenizer* tokenizer, const char* delim,
+    TokenFn fn, void* ctx);
+
+/**
+ * Initialize a tokenizer that splits at any character of a set. See
+ * str_split_any().
+ *
+ * @param tokenizer The tokenizer.
+ * @param chars The separator characters, null terminated.
+ * @param fn The callback to receive the tokens.
+ * @param ctx The context passed to the callback.
+ * @return 0 on success, -1 on invalid input.
+ */
+int str_tokenizer_init_any(StrTokenizer* tokenizer, const char* chars,
+    TokenFn fn, void* ctx);
+
+/**
+ * Feed the next chunk of input to a tokenizer, calling back for every token
+ * it completes.
+ *
+ * @param tokenizer The tokenizer.
+ * @param data The chunk. Need not be null terminated.
+ * @param len The length of the chunk.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int str_tokenizer_feed(StrTokenizer* tokenizer, const char* data,
+    size_t len);
+
+/**
+ * Mark the end of the input, calling back for the last token. The
+ * tokenizer is then ready for a new stream.
+ *
+ * @param tokenizer The tokenizer.
+ */
+void str_tokenizer_finish(StrTokenizer* tokenizer);
+
+/**
+ * Release the memory held by a tokenizer. Pending input is discarded.
+ *
+ * @param tokenizer The tokenizer.
+ */
+void str_tokenizer_free(StrTokenizer* tokenizer);
+
+
+#endif // _STR_TOKENIZER_H_
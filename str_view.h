@@ -0,0 +1,79 @@
+/**
+ * Non-owning views into strings. (Header only)
+ *
+ * A StrView points into a buffer owned by someone else and carries its own
+ * length, so it needs no terminating null character and no copy of the
+ * characters. A view is valid as long as the buffer it points into.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _STR_VIEW_H_
+#define _STR_VIEW_H_
+
+#include <stddef.h>
+#include <string.h>
+#include "allocator.h"
+
+/**
+ * A view into a string.
+ *
+ * @param ptr The first character of the view. Not null terminated.
+ * @param len The number of characters in the view.
+ */
+typedef struct {
+    const char* ptr;
+    size_t len;
+} StrView;
+
+
+/**
+ * Make a view of a null terminated string.
+ *
+ * @param str The string. NULL gives an empty view.
+ * @return The view.
+ */
+static inline StrView str_view(const char* str) {
+    StrView v = { .ptr = str, .len = str ? strlen(str) : 0 };
+    return v;
+}
+
+/**
+ * Compare two views for equality.
+ *
+ * @return 1 if the views hold the same characters, 0 otherwise.
+ */
+static inline int str_view_eq(StrView a, StrView b) {
+    return a.len == b.len && (a.len == 0 || memcmp(a.ptr, b.ptr, a.len) == 0);
+}
+
+/**
+ * Compare a view with a null terminated string for equality.
+ *
+ * @return 1 if the view holds the characters of the string, 0 otherwise.
+ */
+static inline int str_view_eq_str(StrView a, const char* str) {
+    return str_view_eq(a, str_view(str));
+}
+
+/**
+ * Copy the characters of a view into a new null terminated string.
+ *
+ * @param v The view.
+ * @param allocator The allocator for the copy, NULL for malloc().
+ * @return The copy, or NULL on allocation failure.
+ */
+static inline char* str_view_dup(StrView v, const Allocator* allocator) {
+    char* out = allocator_alloc(allocator, v.len + 1);
+    if (!out) return NULL;
+    if (v.len) memcpy(out, v.ptr, v.len);
+    out[v.len] = '\0';
+    return out;
+}
+
+
+#endif // _STR_VIEW_H_
@@ -0,0 +1,436 @@
+/**
+ * Streaming map, filter and reduce over files of fixed-width records.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "stream_data.h"
+#ifdef TEST
+#include <assert.h>
+#include <stdio.h>
+#endif
+
+/**
+ * Function type for processing a block of consecutive records. Returns 0 on
+ * success, -1 on error. -- private
+ */
+typedef int (*BlockFn)(void* ctx, const unsigned char* recs, size_t n,
+    size_t first);
+
+/**
+ * A buffered writer to a file descriptor. -- private
+ */
+typedef struct {
+    int fd;
+    unsigned char* buf;
+    size_t len;
+    size_t cap;
+} Writer;
+
+
+/**
+ * Write a buffer in full, retrying on short writes and interrupts.
+ * -- private
+ */
+static int write_all(int fd, const unsigned char* data, size_t len) {
+    while (len > 0) {
+        ssize_t w = write(fd, data, len);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += w;
+        len -= (size_t)w;
+    }
+    return 0;
+}
+
+
+/**
+ * Write out the buffered bytes of a writer. -- private
+ */
+static int writer_flush(Writer* w) {
+    if (write_all(w->fd, w->buf, w->len) != 0) return -1;
+    w->len = 0;
+    return 0;
+}
+
+
+/**
+ * Return room for len bytes in the buffer of a writer, flushing it first if
+ * needed. len must not exceed the capacity. -- private
+ */
+static unsigned char* writer_reserve(Writer* w, size_t len) {
+    if (w->cap - w->len < len && writer_flush(w) != 0) return NULL;
+    unsigned char* out = &w->buf[w->len];
+    w->len += len;
+    return out;
+}
+
+
+/**
+ * Round a window size up to hold at least one record and to a whole number
+ * of pages. -- private
+ */
+static size_t window_size(size_t window, size_t el_len, size_t page) {
+    if (window == 0) window = STREAM_DEFAULT_WINDOW;
+    if (window < el_len) window = el_len;
+    return (window + page - 1) / page * page;
+}
+
+
+/**
+ * Process a regular file through read-only mappings of one window each.
+ * Returns the number of records processed, -1 on error, or -2 if the first
+ * window could not be mapped and the caller should fall back to read().
+ * -- private
+ */
+static ssize_t stream_mapped(int fd, off_t start, off_t size, size_t el_len,
+    size_t window, size_t page, BlockFn fn, void* ctx) {
+    size_t total = (size_t)(size - start) / el_len;
+    size_t done = 0;
+    while (done < total) {
+        off_t pos = start + (off_t)(done * el_len);
+        // Mappings start on a page boundary, records need not.
+        off_t map_off = pos - pos % (off_t)page;
+        size_t skew = (size_t)(pos - map_off);
+        size_t n = window / el_len;
+        if (n > total - done) n = total - done;
+        size_t map_len = skew + n * el_len;
+        unsigned char* map = mmap(NULL, map_len, PROT_READ, MAP_PRIVATE, fd,
+            map_off);
+        if (map == MAP_FAILED) return done == 0 ? -2 : -1;
+        madvise(map, map_len, MADV_SEQUENTIAL);
+        int rc = fn(ctx, &map[skew], n, done);
+        munmap(map, map_len);
+        if (rc != 0) return -1;
+        done += n;
+    }
+    // Leave the offset after the last record, as read() would.
+    lseek(fd, start + (off_t)(done * el_len), SEEK_SET);
+    return (ssize_t)done;
+}
+
+
+/**
+ * Process any readable descriptor through a page-aligned buffer of one
+ * window, carrying partial records over to the next read. -- private
+ */
+static ssize_t stream_read(int fd, size_t el_len, size_t window, size_t page,
+    BlockFn fn, void* ctx) {
+    unsigned char* buf = aligned_alloc(page, window);
+    if (!buf) return -1;
+    size_t have = 0, done = 0;
+    for (;;) {
+        ssize_t r = read(fd, &buf[have], window - have);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            free(buf);
+            return -1;
+        }
+        if (r == 0) break;
+        have += (size_t)r;
+        size_t n = have / el_len;
+        if (n == 0) continue;
+        if (fn(ctx, buf, n, done) != 0) {
+            free(buf);
+            return -1;
+        }
+        done += n;
+        have -= n * el_len;
+        memmove(buf, &buf[n * el_len], have);
+    }
+    free(buf);
+    return (ssize_t)done;
+}
+
+
+/**
+ * Feed the records of a file to a block function, mapping the file when
+ * possible and reading it otherwise. -- private
+ */
+static ssize_t stream_records(int fd, size_t el_len, size_t window,
+    BlockFn fn, void* ctx) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    window = window_size(window, el_len, page);
+    struct stat st;
+    off_t start = lseek(fd, 0, SEEK_CUR);
+    if (start >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size <= start) return 0;
+        ssize_t n = stream_mapped(fd, start, st.st_size, el_len, window, page,
+            fn, ctx);
+        if (n != -2) return n;
+    }
+    return stream_read(fd, el_len, window, page, fn, ctx);
+}
+
+
+/**
+ * State of stream_filter_file(). -- private
+ */
+typedef struct {
+    FilterDataFn fn;
+    size_t el_len;
+    size_t written;
+    Writer out;
+} FilterCtx;
+
+
+/**
+ * Copy the records of a block that pass the filter to the writer.
+ * -- private
+ */
+static int filter_block(void* ctx, const unsigned char* recs, size_t n,
+    size_t first) {
+    FilterCtx* c = ctx;
+    for (size_t i = 0; i < n; i++) {
+        const unsigned char* rec = &recs[i * c->el_len];
+        if (!c->fn(rec, first + i)) continue;
+        unsigned char* out = writer_reserve(&c->out, c->el_len);
+        if (!out) return -1;
+        memcpy(out, rec, c->el_len);
+        c->written++;
+    }
+    return 0;
+}
+
+
+// Documentation in header file.
+ssize_t stream_filter_file(FilterDataFn fn, int in_fd, int out_fd,
+    size_t el_len, size_t window) {
+    if (fn == NULL || el_len == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    FilterCtx c = { .fn = fn, .el_len = el_len, .written = 0 };
+    c.out.fd = out_fd;
+    c.out.len = 0;
+    c.out.cap = window_size(window, el_len, page);
+    if (!(c.out.buf = malloc(c.out.cap))) return -1;
+    ssize_t n = stream_records(in_fd, el_len, window, &filter_block, &c);
+    if (n >= 0 && writer_flush(&c.out) != 0) n = -1;
+    free(c.out.buf);
+    return n < 0 ? -1 : (ssize_t)c.written;
+}
+
+
+/**
+ * State of stream_map_file(). -- private
+ */
+typedef struct {
+    MapIntoDataFn fn;
+    size_t el_len;
+    size_t out_len;
+    Writer out;
+} MapCtx;
+
+
+/**
+ * Map the records of a block into the writer. -- private
+ */
+static int map_block(void* ctx, const unsigned char* recs, size_t n,
+    size_t first) {
+    MapCtx* c = ctx;
+    for (size_t i = 0; i < n; i++) {
+        unsigned char* out = writer_reserve(&c->out, c->out_len);
+        if (!out) return -1;
+        c->fn(out, &recs[i * c->el_len], first + i);
+    }
+    return 0;
+}
+
+
+// Documentation in header file.
+ssize_t stream_map_file(MapIntoDataFn fn, int in_fd, int out_fd,
+    size_t el_len, size_t out_len, size_t window) {
+    if (fn == NULL || el_len == 0 || out_len == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    MapCtx c = { .fn = fn, .el_len = el_len, .out_len = out_len };
+    c.out.fd = out_fd;
+    c.out.len = 0;
+    c.out.cap = window_size(window, out_len, page);
+    if (!(c.out.buf = malloc(c.out.cap))) return -1;
+    ssize_t n = stream_records(in_fd, el_len, window, &map_block, &c);
+    if (n >= 0 && writer_flush(&c.out) != 0) n = -1;
+    free(c.out.buf);
+    return n;
+}
+
+
+/**
+ * State of stream_reduce_file(). -- private
+ */
+typedef struct {
+    ReduceIntoDataFn fn;
+    size_t el_len;
+    void* acc;
+} ReduceCtx;
+
+
+/**
+ * Reduce the records of a block into the accumulator. -- private
+ */
+static int reduce_block(void* ctx, const unsigned char* recs, size_t n,
+    size_t first) {
+    ReduceCtx* c = ctx;
+    for (size_t i = 0; i < n; i++) {
+        c->fn(c->acc, &recs[i * c->el_len], first + i);
+    }
+    return 0;
+}
+
+
+// Documentation in header file.
+ssize_t stream_reduce_file(ReduceIntoDataFn fn, int in_fd, size_t el_len,
+    void* acc, size_t window) {
+    if (fn == NULL || el_len == 0 || acc == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    ReduceCtx c = { .fn = fn, .el_len = el_len, .acc = acc };
+    return stream_records(in_fd, el_len, window, &reduce_block, &c);
+}
+
+
+#ifdef TEST
+typedef struct {
+    int id;
+    int value;
+    int pad;
+} Record;
+
+int is_even(const void* rr, size_t _) {
+    const Record* r = rr;
+    return r->value % 2 == 0;
+}
+
+void square_into(void* out, const void* rr, size_t index) {
+    const Record* r = rr;
+    long long sq = (long long)r->value * r->value;
+    assert((size_t)r->id == index);
+    memcpy(out, &sq, sizeof(sq));
+}
+
+void sum_into(void* acc, const void* rr, size_t _) {
+    const Record* r = rr;
+    *(long long*)acc += r->value;
+}
+
+/**
+ * Create an unlinked temporary file holding count records.
+ */
+int make_records(size_t count) {
+    char path[] = "/tmp/stream_data_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    unlink(path);
+    for (size_t i = 0; i < count; i++) {
+        Record r = { .id = (int)i, .value = (int)i * 3, .pad = 0 };
+        assert(write(fd, &r, sizeof(r)) == sizeof(r));
+    }
+    lseek(fd, 0, SEEK_SET);
+    return fd;
+}
+
+int make_output() {
+    char path[] = "/tmp/stream_data_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    unlink(path);
+    return fd;
+}
+
+void test_stream_filter_file() {
+    // 12-byte records straddle the page boundaries of a small window.
+    size_t count = 10000;
+    int in = make_records(count);
+    int out = make_output();
+    assert(stream_filter_file(&is_even, in, out, sizeof(Record), 4096) == 5000);
+    assert(lseek(in, 0, SEEK_CUR) == (off_t)(count * sizeof(Record)));
+    assert(lseek(out, 0, SEEK_END) == (off_t)(5000 * sizeof(Record)));
+    lseek(out, 0, SEEK_SET);
+    Record r;
+    for (int i = 0; i < 5000; i++) {
+        assert(read(out, &r, sizeof(r)) == sizeof(r));
+        assert(r.id == i * 2 && r.value == i * 6);
+    }
+    close(out);
+    close(in);
+}
+
+void test_stream_map_file() {
+    size_t count = 3000;
+    int in = make_records(count);
+    int out = make_output();
+    assert(stream_map_file(&square_into, in, out, sizeof(Record),
+        sizeof(long long), 0) == (ssize_t)count);
+    lseek(out, 0, SEEK_SET);
+    long long sq;
+    for (size_t i = 0; i < count; i++) {
+        assert(read(out, &sq, sizeof(sq)) == sizeof(sq));
+        assert(sq == (long long)(i * 3) * (long long)(i * 3));
+    }
+    close(out);
+    close(in);
+}
+
+void test_stream_reduce_file() {
+    size_t count = 5000;
+    int in = make_records(count);
+    long long total = 0;
+    // Start after the first record and leave a partial record at the end.
+    lseek(in, sizeof(Record), SEEK_SET);
+    assert(ftruncate(in, (off_t)(count * sizeof(Record) - 5)) == 0);
+    assert(stream_reduce_file(&sum_into, in, sizeof(Record), &total, 8192)
+        == (ssize_t)(count - 2));
+    assert(total
+        == 3LL * ((long long)(count - 2) * (long long)(count - 1) / 2));
+    close(in);
+}
+
+void test_stream_pipe() {
+    // Pipes cannot be mapped and go through read() instead.
+    int fds[2];
+    assert(pipe(fds) == 0);
+    for (int i = 0; i < 1000; i++) {
+        Record r = { .id = i, .value = i, .pad = 0 };
+        assert(write(fds[1], &r, sizeof(r)) == sizeof(r));
+    }
+    close(fds[1]);
+    int out = make_output();
+    assert(stream_filter_file(&is_even, fds[0], out, sizeof(Record), 100) == 500);
+    assert(lseek(out, 0, SEEK_END) == (off_t)(500 * sizeof(Record)));
+    close(out);
+    close(fds[0]);
+
+    assert(stream_filter_file(NULL, 0, 1, sizeof(Record), 0) == -1);
+    assert(errno == EINVAL);
+}
+
+int main() {
+    test_stream_filter_file();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_stream_filter_file", "Passed");
+    test_stream_map_file();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_stream_map_file", "Passed");
+    test_stream_reduce_file();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_stream_reduce_file", "Passed");
+    test_stream_pipe();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_stream_pipe", "Passed");
+    return 0;
+}
+
+#endif // TEST
@@ -0,0 +1,79 @@
+/**
+ * Streaming map, filter and reduce over files of fixed-width records.
+ * (Header file)
+ *
+ * These functions process a file of el_len-sized records one window at a
+ * time, so the input never has to fit in memory. Regular files are mapped
+ * window by window with a sequential access hint; pipes, sockets and files
+ * that cannot be mapped are read in page-aligned chunks instead. Output
+ * records are buffered and written to a file descriptor. Peak memory is
+ * about two windows, whatever the size of the file.
+ *
+ * Records are read from the current offset of the input descriptor. A
+ * trailing partial record at the end of the input is ignored.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _STREAM_DATA_H_
+#define _STREAM_DATA_H_
+
+#include <stdlib.h>
+#include <sys/types.h>
+#include "functools.h"
+
+/**
+ * The default window size, in bytes.
+ */
+#define STREAM_DEFAULT_WINDOW (4u << 20)
+
+
+/**
+ * Filter the records of a file into another file.
+ *
+ * @param fn The filter function. Receives each record and its index in the
+ * stream. Must return 1 for true, 0 for false.
+ * @param in_fd The input file descriptor.
+ * @param out_fd The output file descriptor.
+ * @param el_len The length of each record.
+ * @param window The window size in bytes. Zero selects
+ * STREAM_DEFAULT_WINDOW. Rounded up to hold at least one record.
+ * @return The number of records written, or -1 on error with errno set.
+ */
+ssize_t stream_filter_file(FilterDataFn fn, int in_fd, int out_fd,
+    size_t el_len, size_t window);
+
+/**
+ * Map the records of a file into another file.
+ *
+ * @param fn The map function. Receives a pointer to out_len bytes of output
+ * to fill, each record and its index in the stream.
+ * @param in_fd The input file descriptor.
+ * @param out_fd The output file descriptor.
+ * @param el_len The length of each input record.
+ * @param out_len The length of each output record.
+ * @param window The window size in bytes. See stream_filter_file().
+ * @return The number of records written, or -1 on error with errno set.
+ */
+ssize_t stream_map_file(MapIntoDataFn fn, int in_fd, int out_fd,
+    size_t el_len, size_t out_len, size_t window);
+
+/**
+ * Reduce the records of a file into a caller-owned accumulator.
+ *
+ * @param fn The reduce function. Must update the accumulator in place.
+ * @param in_fd The input file descriptor.
+ * @param el_len The length of each record.
+ * @param acc The accumulator, holding the initial value.
+ * @param window The window size in bytes. See stream_filter_file().
+ * @return The number of records reduced, or -1 on error with errno set.
+ */
+ssize_t stream_reduce_file(ReduceIntoDataFn fn, int in_fd, size_t el_len,
+    void* acc, size_t window);
+
+
+#endif // _STREAM_DATA_H_
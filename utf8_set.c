@@ -0,0 +1,738 @@
+/**
+ * UTF-8 code point sets.
+ *
+ * Text is mostly ASCII, so every scan first skips a run of ASCII bytes 16 at
+ * a time, testing the sign bits of a whole SSE2 register, and only decodes
+ * the multi-byte sequences one by one. SSE2 is part of x86-64, so no run
+ * time dispatch is needed; other targets skip the run a byte at a time.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "utf8_set.h"
+#ifdef TEST
+#include <assert.h>
+#include <stdio.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define UTF8_SSE2 1
+#endif
+
+// Code points are tracked in blocks of 2^SEEN_BLOCK_BITS by utf8_set_ex().
+#define SEEN_BLOCK_BITS 12
+#define SEEN_BLOCKS ((UTF8_MAX_CODEPOINT >> SEEN_BLOCK_BITS) + 1)
+
+
+/**
+ * Return the length of the run of ASCII bytes at the start of a buffer.
+ * -- private
+ */
+static size_t ascii_prefix(const unsigned char* s, size_t len) {
+    size_t i = 0;
+#ifdef UTF8_SSE2
+    for (; i + 16 <= len; i += 16) {
+        int m = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(s + i)));
+        if (m) return i + (size_t)__builtin_ctz((unsigned)m);
+    }
+#endif
+    while (i < len && s[i] < 0x80) i++;
+    return i;
+}
+
+
+/**
+ * Decode the sequence at the start of a buffer. Returns its length, or 0 if
+ * it is invalid. -- private
+ */
+static size_t decode_one(const unsigned char* s, size_t len, uint32_t* cp) {
+    if (len == 0) return 0;
+    unsigned char c = s[0];
+    if (c < 0x80) {
+        *cp = c;
+        return 1;
+    }
+    size_t n;
+    uint32_t v, min;
+    if (c >= 0xc2 && c <= 0xdf) {
+        n = 2, v = c & 0x1f, min = 0x80;
+    } else if ((c & 0xf0) == 0xe0) {
+        n = 3, v = c & 0x0f, min = 0x800;
+    } else if (c >= 0xf0 && c <= 0xf4) {
+        n = 4, v = c & 0x07, min = 0x10000;
+    } else {
+        return 0;
+    }
+    if (len < n) return 0;
+    for (size_t i = 1; i < n; i++) {
+        if ((s[i] & 0xc0) != 0x80) return 0;
+        v = v << 6 | (s[i] & 0x3f);
+    }
+    if (v < min || v > UTF8_MAX_CODEPOINT || (v >= 0xd800 && v <= 0xdfff)) {
+        return 0;
+    }
+    *cp = v;
+    return n;
+}
+
+
+// Documentation in header file.
+size_t utf8_valid_prefix(const char* str, size_t len) {
+    if (!str) return 0;
+    const unsigned char* s = (const unsigned char*)str;
+    size_t i = 0;
+    uint32_t cp;
+    while (i < len) {
+        i += ascii_prefix(s + i, len - i);
+        if (i == len) break;
+        size_t n = decode_one(s + i, len - i, &cp);
+        if (n == 0) break;
+        i += n;
+    }
+    return i;
+}
+
+
+// Documentation in header file.
+int utf8_validate(const char* str, size_t len) {
+    return str && utf8_valid_prefix(str, len) == len;
+}
+
+
+// Documentation in header file.
+size_t utf8_decode_next(const char* str, size_t len, uint32_t* cp) {
+    if (!str || !cp) return 0;
+    return decode_one((const unsigned char*)str, len, cp);
+}
+
+
+/**
+ * Widen 16 ASCII bytes to code points. -- private
+ */
+#ifdef UTF8_SSE2
+static inline void widen_ascii(const unsigned char* s, uint32_t* out) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i x = _mm_loadu_si128((const __m128i*)s);
+    __m128i lo = _mm_unpacklo_epi8(x, zero);
+    __m128i hi = _mm_unpackhi_epi8(x, zero);
+    _mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi16(lo, zero));
+    _mm_storeu_si128((__m128i*)(out + 4), _mm_unpackhi_epi16(lo, zero));
+    _mm_storeu_si128((__m128i*)(out + 8), _mm_unpacklo_epi16(hi, zero));
+    _mm_storeu_si128((__m128i*)(out + 12), _mm_unpackhi_epi16(hi, zero));
+}
+#endif
+
+
+// Documentation in header file.
+ssize_t utf8_decode(const char* str, size_t len, uint32_t* out) {
+    if (!str || !out) return -1;
+    const unsigned char* s = (const unsigned char*)str;
+    size_t i = 0, n = 0;
+    while (i < len) {
+#ifdef UTF8_SSE2
+        while (i + 16 <= len
+            && !_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(s + i)))) {
+            widen_ascii(s + i, out + n);
+            i += 16;
+            n += 16;
+        }
+#endif
+        while (i < len && s[i] < 0x80) out[n++] = s[i++];
+        if (i == len) break;
+        size_t k = decode_one(s + i, len - i, &out[n]);
+        if (k == 0) return -1;
+        i += k;
+        n++;
+    }
+    return (ssize_t)n;
+}
+
+
+// Documentation in header file.
+size_t utf8_encode(uint32_t cp, char out[4]) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xc0 | cp >> 6);
+        out[1] = (char)(0x80 | (cp & 0x3f));
+        return 2;
+    }
+    if (cp >= 0xd800 && cp <= 0xdfff) return 0;
+    if (cp < 0x10000) {
+        out[0] = (char)(0xe0 | cp >> 12);
+        out[1] = (char)(0x80 | (cp >> 6 & 0x3f));
+        out[2] = (char)(0x80 | (cp & 0x3f));
+        return 3;
+    }
+    if (cp > UTF8_MAX_CODEPOINT) return 0;
+    out[0] = (char)(0xf0 | cp >> 18);
+    out[1] = (char)(0x80 | (cp >> 12 & 0x3f));
+    out[2] = (char)(0x80 | (cp >> 6 & 0x3f));
+    out[3] = (char)(0x80 | (cp & 0x3f));
+    return 4;
+}
+
+
+// Documentation in header file.
+int utf8_contains(const char* haystack, uint32_t needle) {
+    if (!haystack || needle == 0) return 0;
+    char enc[5];
+    size_t n = utf8_encode(needle, enc);
+    if (n == 0) return 0;
+    if (n == 1) return strchr(haystack, enc[0]) != NULL;
+    // A lead byte never appears inside another sequence, so a byte match of
+    // the encoding in valid UTF-8 is a code point match.
+    enc[n] = '\0';
+    return strstr(haystack, enc) != NULL;
+}
+
+
+// Documentation in header file.
+int utf8_contains_n(const char* haystack, size_t len, uint32_t needle) {
+    if (!haystack) return 0;
+    char enc[4];
+    size_t n = utf8_encode(needle, enc);
+    if (n == 0) return 0;
+    const char* end = haystack + len;
+    const char* p = haystack;
+    while ((size_t)(end - p) >= n) {
+        p = memchr(p, enc[0], (size_t)(end - p));
+        if (!p) break;
+        if ((size_t)(end - p) >= n && memcmp(p, enc, n) == 0) return 1;
+        p++;
+    }
+    return 0;
+}
+
+
+/**
+ * A two-level table of the code points seen so far. Blocks are allocated
+ * only for the parts of the code space the input uses. -- private
+ */
+typedef struct {
+    uint64_t ascii[2];
+    uint64_t* blocks[SEEN_BLOCKS];
+} SeenTable;
+
+
+/**
+ * Mark a code point as seen. Returns 1 if it already was, 0 if not, and -1
+ * on allocation failure. -- private
+ */
+static int seen_mark(SeenTable* t, uint32_t cp) {
+    uint64_t* word;
+    if (cp < 128) {
+        word = &t->ascii[cp >> 6];
+    } else {
+        uint64_t** block = &t->blocks[cp >> SEEN_BLOCK_BITS];
+        if (!*block) {
+            *block = calloc((1 << SEEN_BLOCK_BITS) / 64, sizeof(uint64_t));
+            if (!*block) return -1;
+        }
+        word = &(*block)[(cp & ((1 << SEEN_BLOCK_BITS) - 1)) >> 6];
+    }
+    uint64_t bit = (uint64_t)1 << (cp & 63);
+    if (*word & bit) return 1;
+    *word |= bit;
+    return 0;
+}
+
+
+/**
+ * Release the blocks of a seen table. -- private
+ */
+static void seen_free(SeenTable* t) {
+    for (size_t i = 0; i < SEEN_BLOCKS; i++) free(t->blocks[i]);
+}
+
+
+// Documentation in header file.
+char* utf8_set(const char* letters) {
+    return utf8_set_ex(letters, NULL);
+}
+
+
+// Documentation in header file.
+char* utf8_set_ex(const char* letters, const Allocator* allocator) {
+    if (!letters) return NULL;
+    size_t len = strlen(letters);
+    if (!utf8_validate(letters, len)) return NULL;
+    char* ret = allocator_alloc(allocator, len + 1);
+    if (!ret) return NULL;
+    const unsigned char* s = (const unsigned char*)letters;
+    SeenTable* seen = calloc(1, sizeof(SeenTable));
+    if (!seen) {
+        allocator_free(allocator, ret);
+        return NULL;
+    }
+    size_t i = 0, ret_len = 0;
+    while (i < len) {
+        uint32_t cp;
+        size_t n = decode_one(s + i, len - i, &cp);
+        int was = seen_mark(seen, cp);
+        if (was < 0) {
+            seen_free(seen);
+            free(seen);
+            allocator_free(allocator, ret);
+            return NULL;
+        }
+        if (!was) {
+            memcpy(ret + ret_len, s + i, n);
+            ret_len += n;
+        }
+        i += n;
+    }
+    ret[ret_len] = '\0';
+    seen_free(seen);
+    free(seen);
+    return ret;
+}
+
+
+// Documentation in header file.
+int cpset_has_range(const CodepointSet* set, uint32_t cp) {
+    size_t lo = 0, hi = set->n_ranges;
+    // Find the first range that ends at or after cp.
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (set->ranges[mid].hi < cp) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo < set->n_ranges && set->ranges[lo].lo <= cp;
+}
+
+
+// Documentation in header file.
+void cpset_init(CodepointSet* set) {
+    if (set) memset(set, 0, sizeof(*set));
+}
+
+
+/**
+ * Make room for one more range. -- private
+ */
+static int reserve_range(CodepointSet* set) {
+    if (set->n_ranges < set->cap) return 0;
+    size_t cap = set->cap ? set->cap * 2 : 8;
+    CodepointRange* tmp = realloc(set->ranges, cap * sizeof(CodepointRange));
+    if (!tmp) return -1;
+    set->ranges = tmp;
+    set->cap = cap;
+    return 0;
+}
+
+
+/**
+ * Append a range that starts at or after the start of the last one,
+ * merging the two if they overlap or touch. -- private
+ */
+static int push_range(CodepointSet* set, uint32_t lo, uint32_t hi) {
+    if (set->n_ranges > 0) {
+        CodepointRange* last = &set->ranges[set->n_ranges - 1];
+        if (lo <= last->hi + 1) {
+            if (hi > last->hi) last->hi = hi;
+            return 0;
+        }
+    }
+    if (reserve_range(set) != 0) return -1;
+    set->ranges[set->n_ranges].lo = lo;
+    set->ranges[set->n_ranges].hi = hi;
+    set->n_ranges++;
+    return 0;
+}
+
+
+// Documentation in header file.
+int cpset_add(CodepointSet* set, uint32_t cp) {
+    return cpset_add_range(set, cp, cp);
+}
+
+
+// Documentation in header file.
+int cpset_add_range(CodepointSet* set, uint32_t lo, uint32_t hi) {
+    if (!set || lo > hi || hi > UTF8_MAX_CODEPOINT) return -1;
+    for (; lo < 128 && lo <= hi; lo++) {
+        set->ascii[lo >> 6] |= (uint64_t)1 << (lo & 63);
+    }
+    if (lo > hi) return 0;
+    // The ranges from i to j - 1 overlap or touch the new one.
+    size_t i = 0, j = set->n_ranges;
+    while (i < j) {
+        size_t mid = i + (j - i) / 2;
+        if (set->ranges[mid].hi + 1 < lo) i = mid + 1;
+        else j = mid;
+    }
+    j = i;
+    while (j < set->n_ranges && set->ranges[j].lo <= hi + 1) j++;
+    if (i == j) {
+        if (reserve_range(set) != 0) return -1;
+        memmove(set->ranges + i + 1, set->ranges + i,
+            (set->n_ranges - i) * sizeof(CodepointRange));
+        set->n_ranges++;
+    } else {
+        if (set->ranges[i].lo < lo) lo = set->ranges[i].lo;
+        if (set->ranges[j - 1].hi > hi) hi = set->ranges[j - 1].hi;
+        memmove(set->ranges + i + 1, set->ranges + j,
+            (set->n_ranges - j) * sizeof(CodepointRange));
+        set->n_ranges -= j - i - 1;
+    }
+    set->ranges[i].lo = lo;
+    set->ranges[i].hi = hi;
+    return 0;
+}
+
+
+/**
+ * Order code points for qsort(). -- private
+ */
+static int cmp_codepoint(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+
+// Documentation in header file.
+int cpset_add_utf8(CodepointSet* set, const char* str, size_t len) {
+    if (!set || !str || !utf8_validate(str, len)) return -1;
+    const unsigned char* s = (const unsigned char*)str;
+    // Each multi-byte code point takes at least two bytes.
+    uint32_t* wide = malloc((len / 2 + 1) * sizeof(uint32_t));
+    if (!wide) return -1;
+    uint64_t ascii[2] = { 0, 0 };
+    size_t i = 0, n = 0;
+    while (i < len) {
+        size_t run = ascii_prefix(s + i, len - i);
+        for (size_t k = i; k < i + run; k++) {
+            ascii[s[k] >> 6] |= (uint64_t)1 << (s[k] & 63);
+        }
+        i += run;
+        if (i == len) break;
+        i += decode_one(s + i, len - i, &wide[n++]);
+    }
+    // Sorting once and merging keeps large inputs O(n log n), where adding
+    // the code points one by one would shift the range array each time.
+    qsort(wide, n, sizeof(uint32_t), &cmp_codepoint);
+    CodepointSet add = { { ascii[0], ascii[1] }, NULL, 0, 0 };
+    for (size_t k = 0; k < n; k++) {
+        if (push_range(&add, wide[k], wide[k]) != 0) {
+            free(wide);
+            cpset_free(&add);
+            return -1;
+        }
+    }
+    free(wide);
+    int ret = cpset_union(set, set, &add);
+    cpset_free(&add);
+    return ret;
+}
+
+
+/**
+ * Replace the contents of a set. -- private
+ */
+static void cpset_replace(CodepointSet* out, CodepointSet* with) {
+    free(out->ranges);
+    *out = *with;
+}
+
+
+// Documentation in header file.
+int cpset_union(CodepointSet* out, const CodepointSet* a,
+    const CodepointSet* b) {
+    if (!out || !a || !b) return -1;
+    CodepointSet r = { { a->ascii[0] | b->ascii[0], a->ascii[1] | b->ascii[1] },
+        NULL, 0, 0 };
+    size_t i = 0, j = 0;
+    while (i < a->n_ranges || j < b->n_ranges) {
+        const CodepointRange* next;
+        if (j == b->n_ranges
+            || (i < a->n_ranges && a->ranges[i].lo <= b->ranges[j].lo)) {
+            next = &a->ranges[i++];
+        } else {
+            next = &b->ranges[j++];
+        }
+        if (push_range(&r, next->lo, next->hi) != 0) {
+            cpset_free(&r);
+            return -1;
+        }
+    }
+    cpset_replace(out, &r);
+    return 0;
+}
+
+
+// Documentation in header file.
+int cpset_intersect(CodepointSet* out, const CodepointSet* a,
+    const CodepointSet* b) {
+    if (!out || !a || !b) return -1;
+    CodepointSet r = { { a->ascii[0] & b->ascii[0], a->ascii[1] & b->ascii[1] },
+        NULL, 0, 0 };
+    size_t i = 0, j = 0;
+    while (i < a->n_ranges && j < b->n_ranges) {
+        const CodepointRange* x = &a->ranges[i];
+        const CodepointRange* y = &b->ranges[j];
+        uint32_t lo = x->lo > y->lo ? x->lo : y->lo;
+        uint32_t hi = x->hi < y->hi ? x->hi : y->hi;
+        if (lo <= hi && push_range(&r, lo, hi) != 0) {
+            cpset_free(&r);
+            return -1;
+        }
+        if (x->hi < y->hi) i++;
+        else j++;
+    }
+    cpset_replace(out, &r);
+    return 0;
+}
+
+
+// Documentation in header file.
+int cpset_diff(CodepointSet* out, const CodepointSet* a,
+    const CodepointSet* b) {
+    if (!out || !a || !b) return -1;
+    CodepointSet r = { { a->ascii[0] & ~b->ascii[0], a->ascii[1] & ~b->ascii[1] },
+        NULL, 0, 0 };
+    size_t j = 0;
+    for (size_t i = 0; i < a->n_ranges; i++) {
+        uint32_t cur = a->ranges[i].lo, hi = a->ranges[i].hi;
+        while (j < b->n_ranges && b->ranges[j].hi < cur) j++;
+        // Cut the ranges of b out of this range of a, left to right.
+        for (size_t k = j; k < b->n_ranges && b->ranges[k].lo <= hi; k++) {
+            if (b->ranges[k].lo > cur
+                && push_range(&r, cur, b->ranges[k].lo - 1) != 0) {
+                cpset_free(&r);
+                return -1;
+            }
+            cur = b->ranges[k].hi + 1;
+            if (cur > hi) break;
+        }
+        if (cur <= hi && push_range(&r, cur, hi) != 0) {
+            cpset_free(&r);
+            return -1;
+        }
+    }
+    cpset_replace(out, &r);
+    return 0;
+}
+
+
+// Documentation in header file.
+size_t cpset_count(const CodepointSet* set) {
+    if (!set) return 0;
+    size_t n = (size_t)__builtin_popcountll(set->ascii[0])
+        + (size_t)__builtin_popcountll(set->ascii[1]);
+    for (size_t i = 0; i < set->n_ranges; i++) {
+        n += set->ranges[i].hi - set->ranges[i].lo + 1;
+    }
+    return n;
+}
+
+
+// Documentation in header file.
+const char* cpset_find(const CodepointSet* set, const char* str, size_t len) {
+    if (!set || !str) return NULL;
+    const unsigned char* s = (const unsigned char*)str;
+    size_t i = 0;
+    while (i < len) {
+        if (s[i] < 0x80) {
+            if ((set->ascii[s[i] >> 6] >> (s[i] & 63)) & 1) return str + i;
+            i++;
+            continue;
+        }
+        uint32_t cp;
+        size_t n = decode_one(s + i, len - i, &cp);
+        if (n == 0) {
+            i++;
+            continue;
+        }
+        if (cpset_has_range(set, cp)) return str + i;
+        i += n;
+    }
+    return NULL;
+}
+
+
+// Documentation in header file.
+char* cpset_to_utf8(const CodepointSet* set, const Allocator* allocator) {
+    if (!set) return NULL;
+    char enc[4];
+    size_t size = 1;
+    for (uint32_t c = 1; c < 128; c++) size += (size_t)cpset_has(set, c);
+    for (size_t i = 0; i < set->n_ranges; i++) {
+        for (uint32_t c = set->ranges[i].lo; c <= set->ranges[i].hi; c++) {
+            size += utf8_encode(c, enc);
+        }
+    }
+    char* ret = allocator_alloc(allocator, size);
+    if (!ret) return NULL;
+    size_t n = 0;
+    for (uint32_t c = 1; c < 128; c++) {
+        if (cpset_has(set, c)) ret[n++] = (char)c;
+    }
+    for (size_t i = 0; i < set->n_ranges; i++) {
+        for (uint32_t c = set->ranges[i].lo; c <= set->ranges[i].hi; c++) {
+            // Surrogates have no encoding and are left out.
+            n += utf8_encode(c, ret + n);
+        }
+    }
+    ret[n] = '\0';
+    return ret;
+}
+
+
+// Documentation in header file.
+void cpset_free(CodepointSet* set) {
+    if (!set) return;
+    free(set->ranges);
+    memset(set, 0, sizeof(*set));
+}
+
+
+#ifdef TEST
+void test_utf8_validate() {
+    assert(utf8_validate("", 0));
+    assert(utf8_validate("h\xc3\xa9llo \xe2\x82\xac \xf0\x9f\x98\x80", 15));
+    // Overlong forms, surrogates, out of range and truncated sequences.
+    assert(!utf8_validate("\xc0\x80", 2));
+    assert(!utf8_validate("\xe0\x80\x80", 3));
+    assert(!utf8_validate("\xed\xa0\x80", 3));
+    assert(!utf8_validate("\xf4\x90\x80\x80", 4));
+    assert(!utf8_validate("\xe2\x82", 2));
+    assert(!utf8_validate("\x80", 1));
+    assert(!utf8_validate("\xff", 1));
+
+    // An invalid byte at every offset of a long ASCII run, so that it falls
+    // in every lane of a block and in the tail.
+    char buf[100];
+    for (size_t at = 0; at < sizeof(buf); at++) {
+        memset(buf, 'a', sizeof(buf));
+        buf[at] = '\x80';
+        assert(utf8_valid_prefix(buf, sizeof(buf)) == at);
+        if (at + 2 <= sizeof(buf)) {
+            buf[at] = '\xc3';
+            buf[at + 1] = '\xa9';
+            assert(utf8_valid_prefix(buf, sizeof(buf)) == sizeof(buf));
+        }
+    }
+}
+
+void test_utf8_decode() {
+    char enc[4];
+    for (uint32_t cp = 0; cp <= UTF8_MAX_CODEPOINT; cp++) {
+        size_t n = utf8_encode(cp, enc);
+        if (cp >= 0xd800 && cp <= 0xdfff) {
+            assert(n == 0);
+            continue;
+        }
+        uint32_t back;
+        assert(n > 0 && utf8_decode_next(enc, n, &back) == n && back == cp);
+    }
+    assert(utf8_encode(UTF8_MAX_CODEPOINT + 1, enc) == 0);
+
+    const char* text = "The quick brown fox \xc3\xa9t\xc3\xa9 jumps over the lazy dog";
+    size_t len = strlen(text);
+    uint32_t out[64];
+    ssize_t n = utf8_decode(text, len, out);
+    assert(n == (ssize_t)len - 2);
+    assert(out[0] == 'T' && out[19] == ' ' && out[20] == 0xe9 && out[22] == 0xe9);
+    assert(out[n - 1] == 'g');
+    assert(utf8_decode("a\xff", 2, out) == -1);
+}
+
+void test_utf8_contains() {
+    const char* text = "na\xc3\xafve caf\xc3\xa9 \xf0\x9f\x98\x80";
+    assert(utf8_contains(text, 'v'));
+    assert(utf8_contains(text, 0xef));
+    assert(utf8_contains(text, 0xe9));
+    assert(utf8_contains(text, 0x1f600));
+    assert(!utf8_contains(text, 0xe8));
+    assert(!utf8_contains(text, 0));
+    assert(!utf8_contains(NULL, 'a'));
+    assert(utf8_contains_n(text, strlen(text), 0x1f600));
+    assert(!utf8_contains_n(text, strlen(text) - 1, 0x1f600));
+    assert(!utf8_contains_n(text, 3, 0xef));
+    assert(utf8_contains_n(text, 4, 0xef));
+}
+
+void test_utf8_set() {
+    char* set = utf8_set("h\xc3\xa9llo w\xc3\xb6rld h\xc3\xa9h\xc3\xa9");
+    assert(strcmp(set, "h\xc3\xa9lo w\xc3\xb6rd") == 0);
+    free(set);
+    set = utf8_set("");
+    assert(strcmp(set, "") == 0);
+    free(set);
+    assert(utf8_set("bad \xc3") == NULL);
+    assert(utf8_set(NULL) == NULL);
+}
+
+void test_cpset() {
+    CodepointSet a, b, c;
+    cpset_init(&a);
+    cpset_init(&b);
+    cpset_init(&c);
+    const char* greek = "\xce\xb1\xce\xb2\xce\xb3 abc";
+    assert(cpset_add_utf8(&a, greek, strlen(greek)) == 0);
+    assert(cpset_count(&a) == 7);
+    assert(a.n_ranges == 1 && a.ranges[0].lo == 0x3b1 && a.ranges[0].hi == 0x3b3);
+    assert(cpset_has(&a, 'b') && cpset_has(&a, 0x3b2) && !cpset_has(&a, 0x3b4));
+    assert(cpset_add_utf8(&a, "\xc3", 1) == -1 && cpset_count(&a) == 7);
+
+    // Ranges merge when they overlap or touch.
+    assert(cpset_add_range(&b, 0x3b0, 0x3b1) == 0);
+    assert(cpset_add_range(&b, 0x400, 0x4ff) == 0);
+    assert(cpset_add_range(&b, 'a', 0x90) == 0);
+    assert(cpset_add(&b, 0x3b2) == 0);
+    assert(b.n_ranges == 3 && b.ranges[0].lo == 0x80 && b.ranges[0].hi == 0x90);
+    assert(b.ranges[1].lo == 0x3b0 && b.ranges[1].hi == 0x3b2);
+    assert(cpset_add_range(&b, 0x91, 0x3af) == 0);
+    assert(b.n_ranges == 2 && b.ranges[0].hi == 0x3b2);
+    assert(cpset_add_range(&b, 0x500, 0x100) == -1);
+
+    assert(cpset_intersect(&c, &a, &b) == 0);
+    char* s = cpset_to_utf8(&c, NULL);
+    assert(strcmp(s, "abc\xce\xb1\xce\xb2") == 0);
+    free(s);
+    assert(cpset_diff(&c, &a, &b) == 0);
+    s = cpset_to_utf8(&c, NULL);
+    assert(strcmp(s, " \xce\xb3") == 0);
+    free(s);
+    assert(cpset_union(&c, &a, &b) == 0);
+    assert(cpset_count(&c) == 1 + (0x7f - 'a' + 1) + (0x3b3 - 0x80 + 1) + 0x100);
+    assert(cpset_diff(&c, &c, &c) == 0 && cpset_count(&c) == 0);
+
+    const char* text = "plain text, then \xce\xb3";
+    assert(cpset_find(&a, text, strlen(text)) == text + 2);
+    CodepointSet only_gamma = { { 0, 0 }, NULL, 0, 0 };
+    assert(cpset_add(&only_gamma, 0x3b3) == 0);
+    assert(cpset_find(&only_gamma, text, strlen(text)) == text + 17);
+    assert(cpset_find(&only_gamma, text, 17) == NULL);
+
+    cpset_free(&a);
+    cpset_free(&b);
+    cpset_free(&c);
+    cpset_free(&only_gamma);
+}
+
+int main() {
+    test_utf8_validate();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_utf8_validate", "Passed");
+    test_utf8_decode();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_utf8_decode", "Passed");
+    test_utf8_contains();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_utf8_contains", "Passed");
+    test_utf8_set();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_utf8_set", "Passed");
+    test_cpset();
+    printf("%s - \033[0;32m%s\033[0m\n", "test_cpset", "Passed");
+    return 0;
+}
+
+#endif // TEST
@@ -0,0 +1,270 @@
+/**
+ * UTF-8 code point sets. (Header file)
+ *
+ * The byte functions of str_set.h see a multi-byte character as several
+ * unrelated bytes. The functions here decode UTF-8 first and work on whole
+ * code points. A CodepointSet holds the ASCII code points in a 128-bit
+ * bitmap, so that the common case is a single bit test, and the others as a
+ * sorted list of disjoint ranges.
+ *
+ * @date 2026-10-16
+ * @author Marcio Reis Jr.
+ *
+ * This code is released under the GPLv2.1 license. Refer to the LICENSE file
+ * for more information.
+ */
+
+#ifndef _UTF8_SET_H_
+#define _UTF8_SET_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "allocator.h"
+
+/**
+ * The largest Unicode code point.
+ */
+#define UTF8_MAX_CODEPOINT 0x10FFFF
+
+/**
+ * A closed range of code points.
+ *
+ * @param lo The first code point of the range.
+ * @param hi The last code point of the range.
+ */
+typedef struct {
+    uint32_t lo;
+    uint32_t hi;
+} CodepointRange;
+
+/**
+ * A set of Unicode code points. A zeroed CodepointSet is an empty set.
+ *
+ * @param ascii Code point c < 128 is in the set if bit c % 64 of
+ * ascii[c / 64] is set.
+ * @param ranges The code points from 128 up, as sorted ranges that neither
+ * overlap nor touch.
+ * @param n_ranges The number of ranges.
+ * @param cap The capacity of the range array.
+ */
+typedef struct {
+    uint64_t ascii[2];
+    CodepointRange* ranges;
+    size_t n_ranges;
+    size_t cap;
+} CodepointSet;
+
+
+/**
+ * Return the length of the longest prefix of a buffer that is valid UTF-8.
+ * Overlong forms, surrogates and code points past U+10FFFF are invalid.
+ *
+ * @param str The buffer.
+ * @param len The length of the buffer.
+ * @return The length of the valid prefix, len if the whole buffer is valid.
+ */
+size_t utf8_valid_prefix(const char* str, size_t len);
+
+/**
+ * Check whether a buffer is valid UTF-8.
+ *
+ * @param str The buffer.
+ * @param len The length of the buffer.
+ * @return 1 if the buffer is valid, 0 otherwise.
+ */
+int utf8_validate(const char* str, size_t len);
+
+/**
+ * Decode the code point at the start of a buffer.
+ *
+ * @param str The buffer.
+ * @param len The length of the buffer.
+ * @param cp Receives the code point.
+ * @return The length of its encoding, or 0 if the buffer is empty or does
+ * not start with a valid encoding.
+ */
+size_t utf8_decode_next(const char* str, size_t len, uint32_t* cp);
+
+/**
+ * Decode a UTF-8 buffer into code points.
+ *
+ * @param str The buffer.
+ * @param len The length of the buffer.
+ * @param out Receives the code points. Must have room for len of them.
+ * @return The number of code points, or -1 if the buffer is not valid UTF-8.
+ */
+ssize_t utf8_decode(const char* str, size_t len, uint32_t* out);
+
+/**
+ * Encode a code point as UTF-8.
+ *
+ * @param cp The code point.
+ * @param out Receives the encoding, not null terminated.
+ * @return The length of the encoding, or 0 if cp is a surrogate or past
+ * U+10FFFF.
+ */
+size_t utf8_encode(uint32_t cp, char out[4]);
+
+/**
+ * Check if a UTF-8 string contains a code point. The counterpart of
+ * str_contains().
+ *
+ * @param haystack The string to check.
+ * @param needle The code point to check for.
+ * @return 1 if the string contains the code point, 0 otherwise.
+ */
+int utf8_contains(const char* haystack, uint32_t needle);
+
+/**
+ * Check if a UTF-8 buffer of explicit length contains a code point. The
+ * counterpart of str_contains_n().
+ *
+ * @param haystack The buffer to check.
+ * @param len The length of the buffer.
+ * @param needle The code point to check for.
+ * @return 1 if the buffer contains the code point, 0 otherwise.
+ */
+int utf8_contains_n(const char* haystack, size_t len, uint32_t needle);
+
+/**
+ * Return the distinct code points of a UTF-8 string, in the order in which
+ * they first appear. The counterpart of str_set().
+ *
+ * @param letters The string.
+ * @return The code points, UTF-8 encoded and null terminated, or NULL if the
+ * string is NULL or not valid UTF-8.
+ * @note The caller is responsible for freeing the returned string.
+ */
+char* utf8_set(const char* letters);
+
+/**
+ * Return the distinct code points of a UTF-8 string, allocating from the
+ * given allocator.
+ *
+ * @param letters The string.
+ * @param allocator The allocator for the result, NULL for malloc().
+ * @return The code points, or NULL on invalid input or allocation failure.
+ */
+char* utf8_set_ex(const char* letters, const Allocator* allocator);
+
+
+/**
+ * Check whether a code point from 128 up is in the ranges of a set. Use
+ * cpset_has() instead. -- private
+ */
+int cpset_has_range(const CodepointSet* set, uint32_t cp);
+
+/**
+ * Check if a code point is in a set.
+ *
+ * @param set The set.
+ * @param cp The code point.
+ * @return 1 if the code point is in the set, 0 otherwise.
+ */
+static inline int cpset_has(const CodepointSet* set, uint32_t cp) {
+    if (cp < 128) return (int)((set->ascii[cp >> 6] >> (cp & 63)) & 1);
+    return cpset_has_range(set, cp);
+}
+
+/**
+ * Initialize an empty set.
+ *
+ * @param set The set.
+ */
+void cpset_init(CodepointSet* set);
+
+/**
+ * Add a code point to a set.
+ *
+ * @param set The set.
+ * @param cp The code point.
+ * @return 0 on success, -1 on invalid input or allocation failure.
+ */
+int cpset_add(CodepointSet* set, uint32_t cp);
+
+/**
+ * Add a range of code points to a set.
+ *
+ * @param set The set.
+ * @param lo The first code point.
+ * @param hi The last code point, at least lo and at most U+10FFFF.
+ * @return 0 on success, -1 on invalid input or allocation failure.
+ */
+int cpset_add_range(CodepointSet* set, uint32_t lo, uint32_t hi);
+
+/**
+ * Add the code points of a UTF-8 buffer to a set.
+ *
+ * @param set The set.
+ * @param str The buffer.
+ * @param len The length of the buffer.
+ * @return 0 on success, -1 if the buffer is not valid UTF-8 (the set is left
+ * unchanged) or on allocation failure.
+ */
+int cpset_add_utf8(CodepointSet* set, const char* str, size_t len);
+
+/**
+ * Store the code points that are in either of two sets. out may be a or b.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+int cpset_union(CodepointSet* out, const CodepointSet* a,
+    const CodepointSet* b);
+
+/**
+ * Store the code points that are in both of two sets. out may be a or b.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+int cpset_intersect(CodepointSet* out, const CodepointSet* a,
+    const CodepointSet* b);
+
+/**
+ * Store the code points of a that are not in b. out may be a or b.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+int cpset_diff(CodepointSet* out, const CodepointSet* a,
+    const CodepointSet* b);
+
+/**
+ * Return the number of code points in a set.
+ *
+ * @param set The set.
+ * @return The number of code points.
+ */
+size_t cpset_count(const CodepointSet* set);
+
+/**
+ * Find the first code point of a UTF-8 buffer that is in a set. Invalid
+ * bytes never match.
+ *
+ * @param set The set.
+ * @param str The buffer.
+ * @param len The length of the buffer.
+ * @return A pointer to the encoding of the first match, or NULL if there is
+ * none.
+ */
+const char* cpset_find(const CodepointSet* set, const char* str, size_t len);
+
+/**
+ * Return the code points of a set as a UTF-8 string, in ascending order.
+ * U+0000 cannot appear in a string and is left out.
+ *
+ * @param set The set.
+ * @param allocator The allocator for the result, NULL for malloc().
+ * @return The string, or NULL on allocation failure.
+ * @note The caller is responsible for freeing the returned string.
+ */
+char* cpset_to_utf8(const CodepointSet* set, const Allocator* allocator);
+
+/**
+ * Release the memory held by a set and leave it empty.
+ *
+ * @param set The set.
+ */
+void cpset_free(CodepointSet* set);
+
+
+#endif // _UTF8_SET_H_